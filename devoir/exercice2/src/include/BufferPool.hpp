@@ -0,0 +1,209 @@
+#ifndef BufferPool_hpp
+#define BufferPool_hpp
+
+#include <cstdlib>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <sys/mman.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/partitioner.h>
+
+namespace merging {
+
+  /**
+   * @class BufferPool BufferPool.hpp
+   *
+   * Pool of large, uninitialized buffers meant to receive the result of a
+   * merge (see ParallelRecursiveMerge::applyUninitialized).
+   *
+   * @note Buffers are aligned on, and sized in multiples of, a huge page, and
+   *   transparent huge pages are requested for them. A fresh buffer is first
+   *   touched in parallel, so that its pages are spread over the memory nodes
+   *   of the threads that will write them. A released buffer is kept and
+   *   handed out again to any request it can hold without wasting more than
+   *   half of it.
+   */
+  class BufferPool {
+  public:
+
+    /**
+     * Size of a huge page, used as alignment and allocation granularity.
+     */
+    static constexpr size_t hugePageSize = 2 * 1024 * 1024;
+
+    /**
+     * @class Lease BufferPool.hpp
+     *
+     * Storage for @c count elements of type @c T, returned to its pool on
+     * destruction.
+     *
+     * @note As with std::allocator, the storage is uninitialized: the
+     *   elements constructed in it must be destroyed by the caller before the
+     *   lease is released.
+     */
+    template< typename T >
+    class Lease {
+    public:
+
+      /**
+       * Constructor.
+       *
+       * @param[in] pool - the pool owning the buffer;
+       * @param[in] data - the buffer;
+       * @param[in] count - the number of elements the lease was asked for;
+       * @param[in] capacity - the size of the buffer, in bytes.
+       */
+      Lease(BufferPool& pool, T* data, const size_t& count, const size_t& capacity)
+        : pool(&pool), pointer(data), count(count), capacity(capacity) {}
+
+      Lease(const Lease&) = delete;
+      Lease& operator=(const Lease&) = delete;
+
+      Lease(Lease&& other) noexcept
+        : pool(other.pool), pointer(other.pointer), count(other.count), capacity(other.capacity) {
+        other.pointer = nullptr;
+      }
+
+      Lease& operator=(Lease&& other) noexcept {
+        std::swap(pool, other.pool);
+        std::swap(pointer, other.pointer);
+        std::swap(count, other.count);
+        std::swap(capacity, other.capacity);
+        return *this;
+      }
+
+      /**
+       * Destructor: gives the buffer back to the pool.
+       */
+      ~Lease() {
+        if (pointer != nullptr) {
+          pool->release(pointer, capacity);
+        }
+      }
+
+      T* data() const { return pointer; }
+      size_t size() const { return count; }
+      T* begin() const { return pointer; }
+      T* end() const { return pointer + count; }
+      std::reverse_iterator< T* > rbegin() const { return std::reverse_iterator< T* >(end()); }
+      std::reverse_iterator< T* > rend() const { return std::reverse_iterator< T* >(begin()); }
+
+    private:
+      BufferPool* pool; /** Pool owning the buffer.  */
+      T* pointer;       /** The buffer.              */
+      size_t count;     /** Number of elements.      */
+      size_t capacity;  /** Size of buffer in bytes. */
+    };
+
+    BufferPool() = default;
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    /**
+     * Destructor: frees the cached buffers. Every lease must have been
+     * released beforehand.
+     */
+    ~BufferPool() {
+      clear();
+    }
+
+    /**
+     * Hands out storage for a number of elements.
+     *
+     * @param[in] count - the number of elements of type @c T to store.
+     * @return a lease on a buffer large enough for @c count elements.
+     * @throw std::bad_alloc if no memory is available.
+     */
+    template< typename T >
+    Lease< T > acquire(const size_t& count) {
+      static_assert(alignof(T) <= hugePageSize, "over-aligned type");
+      size_t capacity;
+      void* const buffer = allocate(count * sizeof(T), capacity);
+      return Lease< T >(*this, static_cast< T* >(buffer), count, capacity);
+    }
+
+    /**
+     * Frees the buffers currently cached by the pool.
+     */
+    void clear() {
+      std::lock_guard< std::mutex > lock(mutex);
+      for (const auto& entry : cache) {
+        std::free(entry.second);
+      }
+      cache.clear();
+    }
+
+  private:
+
+    /**
+     * Reuses a cached buffer or allocates and first-touches a new one.
+     *
+     * @param[in] bytes - the number of bytes requested;
+     * @param[out] capacity - the size of the buffer handed out, in bytes.
+     * @return the buffer.
+     */
+    void* allocate(const size_t& bytes, size_t& capacity) {
+      capacity = (bytes + hugePageSize - 1) / hugePageSize * hugePageSize;
+      if (capacity == 0) {
+        capacity = hugePageSize;
+      }
+
+      // Smallest cached buffer large enough, unless it is more than twice
+      // the size needed.
+      {
+        std::lock_guard< std::mutex > lock(mutex);
+        const auto found = cache.lower_bound(capacity);
+        if (found != cache.end() && found->first <= 2 * capacity) {
+          void* const buffer = found->second;
+          capacity = found->first;
+          cache.erase(found);
+          return buffer;
+        }
+      }
+
+      void* const buffer = std::aligned_alloc(hugePageSize, capacity);
+      if (buffer == nullptr) {
+        throw std::bad_alloc();
+      }
+#ifdef MADV_HUGEPAGE
+      madvise(buffer, capacity, MADV_HUGEPAGE);
+#endif
+
+      // Parallel first touch, one write per small page.
+      char* const base = static_cast< char* >(buffer);
+      const size_t pageSize = 4096;
+      tbb::parallel_for(tbb::blocked_range< size_t >(0, capacity / pageSize),
+        [base, pageSize](const tbb::blocked_range< size_t >& range) {
+          for (size_t page = range.begin(); page != range.end(); page ++) {
+            base[page * pageSize] = 0;
+          }
+        },
+        tbb::static_partitioner());
+
+      return buffer;
+    }
+
+    /**
+     * Puts a buffer back into the cache.
+     *
+     * @param[in] buffer - the buffer;
+     * @param[in] capacity - its size, in bytes.
+     */
+    void release(void* buffer, const size_t& capacity) {
+      std::lock_guard< std::mutex > lock(mutex);
+      cache.emplace(capacity, buffer);
+    }
+
+    std::mutex mutex;                     /** Protects the cache.           */
+    std::multimap< size_t, void* > cache; /** Free buffers, by size.        */
+
+  }; // BufferPool
+
+} // merging
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef Cancellation_hpp
+#define Cancellation_hpp
+
+#include <atomic>
+#include <chrono>
+
+namespace merging {
+
+  /**
+   * @class CancellationToken Cancellation.hpp
+   *
+   * Cooperative stop request shared between the caller of a long merge and
+   * the threads running it (see ParallelRecursiveMerge::applyCancellable).
+   * The request is either explicit, by calling @c cancel from any thread, or
+   * implicit, once an optional deadline has passed.
+   */
+  class CancellationToken {
+  public:
+
+    /**
+     * Synonym types for the clock and its time points.
+     */
+    typedef std::chrono::steady_clock Clock;
+    typedef Clock::time_point TimePoint;
+
+    /**
+     * Constructor of a token without deadline.
+     */
+    CancellationToken()
+      : requested(false), deadline(TimePoint::max()) {}
+
+    /**
+     * Constructor of a token expiring at a given time.
+     *
+     * @param[in] deadline - the time after which the merge should stop.
+     */
+    explicit CancellationToken(const TimePoint& deadline)
+      : requested(false), deadline(deadline) {}
+
+    /**
+     * Constructor of a token expiring after a given duration.
+     *
+     * @param[in] timeout - the duration, from now, after which the merge
+     *   should stop.
+     */
+    template< typename Rep, typename Period >
+    explicit CancellationToken(const std::chrono::duration< Rep, Period >& timeout)
+      : requested(false),
+        deadline(Clock::now() + std::chrono::duration_cast< Clock::duration >(timeout)) {}
+
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+
+    /**
+     * Requests the merge to stop. Can be called from any thread.
+     */
+    void cancel() {
+      requested.store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * Tells whether the merge should stop.
+     *
+     * @return @c true if @c cancel has been called or the deadline has passed.
+     */
+    bool cancelled() const {
+      return requested.load(std::memory_order_relaxed) ||
+        (deadline != TimePoint::max() && Clock::now() >= deadline);
+    }
+
+  private:
+    std::atomic< bool > requested; /** Explicit request. */
+    const TimePoint deadline;      /** Deadline.         */
+
+  }; // CancellationToken
+
+} // merging
+
+#endif
@@ -1,10 +1,18 @@
 #ifndef ParallelRecursiveMerge_hpp
 #define ParallelRecursiveMerge_hpp
 
+#include "Cancellation.hpp"
 #include <algorithm>
 #include <functional>
 #include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 #include <tbb/parallel_invoke.h>
+#include <tbb/task_group.h>
 
 namespace merging {
 
@@ -56,8 +64,8 @@ namespace merging {
       const Compare& comp,
       const size_t& cutoff) {
 
-      // Invoke the appropriate strategy.
-      strategyB(first1, 
+      // Invoke the appropriate strategy, behind the overlap pre-check.
+      strategyOverlap(first1, 
         last1, 
         first2, 
         last2, 
@@ -120,8 +128,465 @@ namespace merging {
       
     } // apply
 
+    /**
+     * Key handling policy of the projection overloads.
+     */
+    enum class KeyMode {
+      direct,    /** Project the elements at every comparison.             */
+      extracted, /** Copy the keys into contiguous arrays, then merge.     */
+      automatic  /** Extract only when elements are much larger than keys. */
+    };
+
+    /**
+     * Form of the algorithm comparing the elements on a projected key, as
+     * the C++20 range algorithms do.
+     *
+     * @param[in] first1 - an iterator pointing to the first element of the first
+     *   subcontainer involved in the merge;
+     * @param[in] last1 - an iterator pointing to the element just past the 
+     *   last element of the first subcontainer involved in the merge;
+     * @param[in] first2 - an iterator pointing to the first element of the second
+     *   subcontainer involved in the merge;
+     * @param[in] last2 - an iterator pointing to the element just past the 
+     *   last element of the second subcontainer involved in the merge;
+     * @param[in] result - an iterator pointing to the position where the 
+     *   first resulting element of the merge should be copied;
+     * @param[in] comp - a binary comparator representing the total order
+     *   relation governing the keys;
+     * @param[in] proj - a callable (function, member pointer, ...) returning
+     *   the key of an element;
+     * @param[in] cutoff - the sum of the sizes of the two subcontainers below 
+     *   which the merge is performed sequentially;
+     * @param[in] mode - whether keys are projected at every comparison or
+     *   extracted once into contiguous arrays, so that split searches and
+     *   leaf comparisons no longer touch the elements themselves.
+     * @return an iterator pointing to the end of the merge area in the
+     *   target container.
+     */
+    template< typename InputRandomAccessIterator1,
+          typename InputRandomAccessIterator2,
+          typename OutputRandomAccessIterator,
+          typename Compare,
+          typename Projection >
+    static OutputRandomAccessIterator 
+    apply(const InputRandomAccessIterator1& first1,
+      const InputRandomAccessIterator1& last1,
+      const InputRandomAccessIterator2& first2,
+      const InputRandomAccessIterator2& last2,
+      const OutputRandomAccessIterator& result,
+      const Compare& comp,
+      const Projection& proj,
+      const size_t& cutoff,
+      const KeyMode& mode = KeyMode::automatic) {
+
+      // Synonym types for the elements and their keys.
+      typedef std::iterator_traits< InputRandomAccessIterator1 > Traits;
+      typedef typename Traits::value_type value_type;
+      typedef std::decay_t< std::invoke_result_t< const Projection&,
+                                                  const value_type& > > Key;
+
+      // Sizes of the two subcontainers.
+      const auto size1 = last1 - first1;
+      const auto size2 = last2 - first2;
+
+      // Extraction pays off when a key is a small, trivially copyable part
+      // of a larger element and the merge is large enough to run in parallel.
+      const bool extract = mode == KeyMode::extracted ||
+        (mode == KeyMode::automatic &&
+         std::is_trivially_copyable< Key >::value &&
+         sizeof(value_type) >= 4 * sizeof(Key) &&
+         static_cast< size_t >(size1 + size2) >= cutoff);
+
+      if (! extract) {
+        // Compare the projections of the elements.
+        const auto projected = [&comp, &proj](const auto& lhs, const auto& rhs) {
+          return comp(std::invoke(proj, lhs), std::invoke(proj, rhs));
+        };
+        return apply(first1, last1, first2, last2, result, projected, cutoff);
+      }
+
+      // Extract the keys of both subcontainers in parallel.
+      std::vector< Key > keys1(size1), keys2(size2);
+      tbb::parallel_invoke(
+        [&] {
+          extractKeys(first1, keys1, proj);
+        },
+        [&] {
+          extractKeys(first2, keys2, proj);
+        }
+      );
+
+      // Merge on the keys, moving the elements along.
+      strategyKeys(keys1.data(),
+                   keys1.data() + size1,
+                   first1,
+                   keys2.data(),
+                   keys2.data() + size2,
+                   first2,
+                   result,
+                   comp,
+                   cutoff);
+
+      // Respect the semantics of the merge algorithm.
+      return result + size1 + size2;
+
+    } // apply
+
+    /**
+     * Form of the algorithm writing into uninitialized storage, such as a
+     * BufferPool lease: the merged elements are copy-constructed in place
+     * instead of being assigned, so the target needs no prior initialization.
+     *
+     * @param[in] first1 - an iterator pointing to the first element of the first
+     *   subcontainer involved in the merge;
+     * @param[in] last1 - an iterator pointing to the element just past the 
+     *   last element of the first subcontainer involved in the merge;
+     * @param[in] first2 - an iterator pointing to the first element of the second
+     *   subcontainer involved in the merge;
+     * @param[in] last2 - an iterator pointing to the element just past the 
+     *   last element of the second subcontainer involved in the merge;
+     * @param[in] result - an iterator pointing to the uninitialized position
+     *   where the first resulting element of the merge should be constructed;
+     * @param[in] comp - a binary comparator representing the total order
+     *   relation governing the subcontainers;
+     * @param[in] cutoff - the sum of the sizes of the two subcontainers below 
+     *   which the merge is performed using the standard library merge algorithm.
+     * @return an iterator pointing to the end of the merge area in the
+     *   target container.
+     */
+    template< typename InputRandomAccessIterator1,
+          typename InputRandomAccessIterator2,
+          typename OutputRandomAccessIterator,
+          typename Compare >
+    static OutputRandomAccessIterator 
+    applyUninitialized(const InputRandomAccessIterator1& first1,
+               const InputRandomAccessIterator1& last1,
+               const InputRandomAccessIterator2& first2,
+               const InputRandomAccessIterator2& last2,
+               const OutputRandomAccessIterator& result,
+               const Compare& comp,
+               const size_t& cutoff) {
+
+      // Synonym type for the type of elements in the target container.
+      typedef std::iterator_traits< OutputRandomAccessIterator > Traits;
+      typedef typename Traits::value_type value_type;
+
+      // Trivially copyable elements can be copied bytewise into raw storage.
+      if constexpr (std::is_trivially_copyable< value_type >::value) {
+        return apply(first1, last1, first2, last2, result, comp, cutoff);
+      }
+      else {
+        strategyOverlap(first1,
+          last1,
+          first2,
+          last2,
+          ConstructingIterator< OutputRandomAccessIterator >(result),
+          comp,
+          cutoff);
+        return result + (last1 - first1) + (last2 - first2);
+      }
+
+    } // applyUninitialized
+
+    /**
+     * Form of the algorithm writing into uninitialized storage, for the total
+     * order relation strictly less than.
+     *
+     * @param[in] first1 - an iterator pointing to the first element of the first
+     *   subcontainer involved in the merge;
+     * @param[in] last1 - an iterator pointing to the element just past the 
+     *   last element of the first subcontainer involved in the merge;
+     * @param[in] first2 - an iterator pointing to the first element of the second
+     *   subcontainer involved in the merge;
+     * @param[in] last2 - an iterator pointing to the element just past the 
+     *   last element of the second subcontainer involved in the merge;
+     * @param[in] result - an iterator pointing to the uninitialized position
+     *   where the first resulting element of the merge should be constructed;
+     * @param[in] cutoff - the sum of the sizes of the two subcontainers below 
+     *   which the merge is performed using the standard library merge algorithm.
+     * @return an iterator pointing to the end of the merge area in the
+     *   target container.
+     */
+    template< typename InputRandomAccessIterator1,
+          typename InputRandomAccessIterator2,
+          typename OutputRandomAccessIterator >
+    static OutputRandomAccessIterator 
+    applyUninitialized(const InputRandomAccessIterator1& first1,
+               const InputRandomAccessIterator1& last1,
+               const InputRandomAccessIterator2& first2,
+               const InputRandomAccessIterator2& last2,
+               const OutputRandomAccessIterator& result,
+               const size_t& cutoff) {
+
+      typedef std::iterator_traits< InputRandomAccessIterator1 > Traits;
+      typedef typename Traits::value_type value_type;
+
+      return applyUninitialized(first1,
+                last1,
+                first2,
+                last2,
+                result,
+                std::less< const value_type& >(),
+                cutoff);
+
+    } // applyUninitialized
+
+    /**
+     * Form of the algorithm that can be stopped before completion, for
+     * instance when the request it serves has timed out upstream.
+     *
+     * @param[in] first1 - an iterator pointing to the first element of the first
+     *   subcontainer involved in the merge;
+     * @param[in] last1 - an iterator pointing to the element just past the 
+     *   last element of the first subcontainer involved in the merge;
+     * @param[in] first2 - an iterator pointing to the first element of the second
+     *   subcontainer involved in the merge;
+     * @param[in] last2 - an iterator pointing to the element just past the 
+     *   last element of the second subcontainer involved in the merge;
+     * @param[in] result - an iterator pointing to the position where the 
+     *   first resulting element of the merge should be copied;
+     * @param[in] comp - a binary comparator representing the total order
+     *   relation governing the subcontainers;
+     * @param[in] cutoff - the sum of the sizes of the two subcontainers below 
+     *   which the merge is performed using the standard library merge algorithm;
+     * @param[in] token - the cancellation token polled by the running tasks.
+     * @return @c true if the merge completed, @c false if it stopped early,
+     *   in which case the content of the target container is unspecified.
+     *
+     * @note The token is polled before each split and each sequential merge.
+     *   Once it fires, the tasks not yet started are discarded through their
+     *   shared tbb::task_group_context, and each running task finishes at most
+     *   one sequential merge of less than @c cutoff elements.
+     */
+    template< typename InputRandomAccessIterator1,
+          typename InputRandomAccessIterator2,
+          typename OutputRandomAccessIterator,
+          typename Compare >
+    static bool
+    applyCancellable(const InputRandomAccessIterator1& first1,
+             const InputRandomAccessIterator1& last1,
+             const InputRandomAccessIterator2& first2,
+             const InputRandomAccessIterator2& last2,
+             const OutputRandomAccessIterator& result,
+             const Compare& comp,
+             const size_t& cutoff,
+             const CancellationToken& token) {
+
+      // Context shared by all the tasks of this merge.
+      tbb::task_group_context context;
+
+      strategyCancellable(first1, last1, first2, last2, result, comp, cutoff, token, context);
+
+      return ! context.is_group_execution_cancelled();
+
+    } // applyCancellable
+
   protected:
 
+    /**
+     * @class ConstructingIterator ParallelRecursiveMerge.hpp
+     *
+     * Output iterator adaptor constructing, rather than assigning, the values
+     * written through it. It provides exactly what the strategies and
+     * std::merge need: offsetting, incrementing and writing.
+     */
+    template< typename OutputRandomAccessIterator >
+    class ConstructingIterator {
+    public:
+      typedef std::iterator_traits< OutputRandomAccessIterator > Traits;
+      typedef std::output_iterator_tag iterator_category;
+      typedef typename Traits::value_type value_type;
+      typedef typename Traits::difference_type difference_type;
+      typedef void pointer;
+      typedef void reference;
+
+      explicit ConstructingIterator(const OutputRandomAccessIterator& position)
+        : position(position) {}
+
+      ConstructingIterator operator*() const { return *this; }
+
+      ConstructingIterator& operator=(const value_type& value) {
+        ::new (static_cast< void* >(std::addressof(*position))) value_type(value);
+        return *this;
+      }
+
+      ConstructingIterator& operator++() { ++ position; return *this; }
+
+      ConstructingIterator operator++(int) {
+        ConstructingIterator previous(*this);
+        ++ position;
+        return previous;
+      }
+
+      ConstructingIterator operator+(const difference_type& offset) const {
+        return ConstructingIterator(position + offset);
+      }
+
+    private:
+      OutputRandomAccessIterator position; /** Adapted iterator. */
+    };
+
+    /**
+     * Copies a subcontainer in parallel, by chunks of @c cutoff elements;
+     * each chunk is copied by std::copy, hence by memmove for trivially
+     * copyable elements stored contiguously.
+     *
+     * @param[in] first - an iterator pointing to the first element to copy;
+     * @param[in] last - an iterator pointing to the element just past the
+     *   last element to copy;
+     * @param[in] result - an iterator pointing to the position where the
+     *   first element should be copied;
+     * @param[in] cutoff - the chunk size.
+     */
+    template< typename InputRandomAccessIterator,
+          typename OutputRandomAccessIterator >
+    static void parallelCopy(const InputRandomAccessIterator& first,
+                 const InputRandomAccessIterator& last,
+                 const OutputRandomAccessIterator& result,
+                 const size_t& cutoff) {
+
+      tbb::parallel_for(
+        tbb::blocked_range< size_t >(0, last - first, std::max< size_t >(cutoff, 1)),
+        [&](const tbb::blocked_range< size_t >& range) {
+          std::copy(first + range.begin(), first + range.end(), result + range.begin());
+        });
+
+    } // parallelCopy
+
+    /**
+     * Pre-check common to all forms of the algorithm: two boundary binary
+     * searches find the overlap window of the subcontainers. The elements of
+     * one subcontainer sorting before (respectively after) every element of
+     * the other are copied in parallel, and only the overlap is merged by
+     * @c strategyB. Append-like merges thus reduce to parallel copies.
+     *
+     * @param[in] first1 - an iterator pointing to the first element of the first
+     *   subcontainer involved in the merge;
+     * @param[in] last1 - an iterator pointing to the element just past the 
+     *   last element of the first subcontainer involved in the merge;
+     * @param[in] first2 - an iterator pointing to the first element of the second
+     *   subcontainer involved in the merge;
+     * @param[in] last2 - an iterator pointing to the element just past the 
+     *   last element of the second subcontainer involved in the merge;
+     * @param[in] result - an iterator pointing to the position where the 
+     *   first resulting element of the merge should be copied;
+     * @param[in] comp - a binary comparator representing the total order
+     *   relation governing the subcontainers;
+     * @param[in] cutoff - the sum of the sizes of the two subcontainers below 
+     *   which the merge is performed using the standard library merge algorithm.
+     */
+    template< typename InputRandomAccessIterator1,
+          typename InputRandomAccessIterator2,
+          typename OutputRandomAccessIterator,
+          typename Compare >
+    static void strategyOverlap(const InputRandomAccessIterator1& first1,
+                const InputRandomAccessIterator1& last1,
+                const InputRandomAccessIterator2& first2,
+                const InputRandomAccessIterator2& last2,
+                const OutputRandomAccessIterator& result,
+                const Compare& comp,
+                const size_t& cutoff) {
+
+      // Small merges and empty subcontainers are not worth the searches.
+      if (static_cast< size_t >((last1 - first1) + (last2 - first2)) < cutoff ||
+          first1 == last1 || first2 == last2) {
+        strategyB(first1, last1, first2, last2, result, comp, cutoff);
+        return;
+      }
+
+      // Front of the overlap window. Ties are broken as by std::merge: the
+      // elements of the first subcontainer come first.
+      InputRandomAccessIterator1 low1 = first1;
+      InputRandomAccessIterator2 low2 = first2;
+      if (comp(*first2, *first1)) {
+        low2 = std::lower_bound(first2, last2, *first1, comp);
+      }
+      else {
+        low1 = std::upper_bound(first1, last1, *first2, comp);
+      }
+
+      // Back of the overlap window.
+      InputRandomAccessIterator1 high1 = last1;
+      InputRandomAccessIterator2 high2 = last2;
+      if (comp(*(last2 - 1), *(last1 - 1))) {
+        high1 = std::upper_bound(low1, last1, *(last2 - 1), comp);
+      }
+      else {
+        high2 = std::lower_bound(low2, last2, *(last1 - 1), comp);
+      }
+
+      // Positions of the overlap and of the suffix in the result.
+      const OutputRandomAccessIterator middle = 
+        result + (low1 - first1) + (low2 - first2);
+      const OutputRandomAccessIterator suffix = 
+        middle + (high1 - low1) + (high2 - low2);
+
+      // Prefix, overlap and suffix are independent. At most one of the two
+      // copies of each side is non-empty.
+      tbb::parallel_invoke(
+        [&] {
+          parallelCopy(first1, low1, result, cutoff);
+          parallelCopy(first2, low2, result + (low1 - first1), cutoff);
+        },
+        [&] {
+          strategyB(low1, high1, low2, high2, middle, comp, cutoff);
+        },
+        [&] {
+          parallelCopy(high1, last1, suffix, cutoff);
+          parallelCopy(high2, last2, suffix + (last1 - high1), cutoff);
+        }
+      );
+
+    } // strategyOverlap
+
+    /**
+     * Split step shared by the recursive strategies: the median element of
+     * the longer subcontainer and the pivot element of the other one. Ties
+     * are broken as by std::merge, the elements of the first subcontainer
+     * coming first, so the pivot is the lower bound of the median in the
+     * second subcontainer and its upper bound in the first: the merge is
+     * stable whichever subcontainer is the longer.
+     *
+     * @param[in] first1 - an iterator pointing to the first element of the first
+     *   subcontainer involved in the merge;
+     * @param[in] last1 - an iterator pointing to the element just past the 
+     *   last element of the first subcontainer involved in the merge;
+     * @param[in] first2 - an iterator pointing to the first element of the second
+     *   subcontainer involved in the merge;
+     * @param[in] last2 - an iterator pointing to the element just past the 
+     *   last element of the second subcontainer involved in the merge;
+     * @param[in] comp - a binary comparator representing the total order
+     *   relation governing the subcontainers;
+     * @param[out] middle1 - the split point of the first subcontainer;
+     * @param[out] middle2 - the split point of the second subcontainer.
+     * @return @c true if the median element is @c *middle1, @c false if it is
+     *   @c *middle2; either way it goes between the two halves of the merge.
+     */
+    template< typename InputRandomAccessIterator1,
+          typename InputRandomAccessIterator2,
+          typename Compare >
+    static bool split(const InputRandomAccessIterator1& first1,
+              const InputRandomAccessIterator1& last1,
+              const InputRandomAccessIterator2& first2,
+              const InputRandomAccessIterator2& last2,
+              const Compare& comp,
+              InputRandomAccessIterator1& middle1,
+              InputRandomAccessIterator2& middle2) {
+
+      const auto size1 = last1 - first1;
+      const auto size2 = last2 - first2;
+
+      if (size1 >= size2) {
+        middle1 = first1 + size1 / 2;
+        middle2 = std::lower_bound(first2, last2, *middle1, comp);
+        return true;
+      }
+      middle2 = first2 + size2 / 2;
+      middle1 = std::upper_bound(first1, last1, *middle2, comp);
+      return false;
+
+    } // split
+
     /**
      * MIMD implementation of this algorithm based on the use of
      * parallel sections.
@@ -165,36 +630,27 @@ namespace merging {
         return;
       }
 
-      // The subcontainer corresponding to the left operand is conventionally 
-      // longer than the one corresponding to the right operand. If not,
-      // we put things in order.
-      if (size1 < size2) {
-        strategyA(first2, 
-          last2, 
-          first1, 
-          last1, 
-          result,   
-          comp,
-          cutoff);
-        return;
-      }
-
-      // Iterator pointing to the median element in the left subcontainer.
-      const InputRandomAccessIterator1 middle1 = 
-        first1 + size1 / 2 + size1 % 2;
-
-      // Iterator pointing to the pivot element in the right subcontainer.
-      const InputRandomAccessIterator2 middle2 = 
-        std::lower_bound(first2, last2, *middle1, comp);
+      // Median element of the longer subcontainer and pivot element of the
+      // other one (see split).
+      InputRandomAccessIterator1 middle1;
+      InputRandomAccessIterator2 middle2;
+      const bool left = split(first1, last1, first2, last2, comp, middle1, middle2);
 
       // Iterator pointing to the position in the result subcontainer where 
-      // the median element of the left subcontainer will be placed.
+      // the median element will be placed.
       const OutputRandomAccessIterator middle3 = 
         result + (middle1 - first1) + (middle2 - first2);
 
-      // Copy the median element of the left subcontainer into the 
-      // result subcontainer.
-      *middle3 = *middle1;
+      // Copy the median element into the result subcontainer: the second
+      // half of the merge starts right after it.
+      if (left) {
+        *middle3 = *middle1;
+      }
+      else {
+        *middle3 = *middle2;
+      }
+      const InputRandomAccessIterator1 next1 = left ? middle1 + 1 : middle1;
+      const InputRandomAccessIterator2 next2 = left ? middle2 : middle2 + 1;
 
       // Parallel sections dedicated to recursive calls. If nested 
       // parallelism is enabled, the number of threads that can be
@@ -204,7 +660,7 @@ namespace merging {
           strategyA(first1, middle1, first2, middle2, result, comp, cutoff);
         },
         [&] {
-          strategyA(middle1 + 1, last1, middle2, last2, middle3 + 1, comp, cutoff);
+          strategyA(next1, last1, next2, last2, middle3 + 1, comp, cutoff);
         }
       );
 
@@ -290,36 +746,27 @@ namespace merging {
         return;
       }
 
-      // The subcontainer corresponding to the left operand is conventionally 
-      // longer than the one corresponding to the right operand. If not,
-      // we put things in order.
-      if (size1 < size2) {
-        strategyBTasking(first2, 
-             last2, 
-             first1, 
-             last1, 
-             result,    
-             comp,
-             cutoff);
-        return;
-      }
-
-      // Iterator pointing to the median element in the left subcontainer.
-      const InputRandomAccessIterator1 middle1 = 
-        first1 + size1 / 2 + size1 % 2;
-
-      // Iterator pointing to the pivot element in the right subcontainer.
-      const InputRandomAccessIterator2 middle2 = 
-        std::lower_bound(first2, last2, *middle1, comp);
+      // Median element of the longer subcontainer and pivot element of the
+      // other one (see split).
+      InputRandomAccessIterator1 middle1;
+      InputRandomAccessIterator2 middle2;
+      const bool left = split(first1, last1, first2, last2, comp, middle1, middle2);
 
       // Iterator pointing to the position in the result subcontainer where 
-      // the median element of the left subcontainer will be placed.
+      // the median element will be placed.
       const OutputRandomAccessIterator middle3 = 
         result + (middle1 - first1) + (middle2 - first2);
 
-      // Copy the median element of the left subcontainer into the 
-      // result subcontainer.
-      *middle3 = *middle1;
+      // Copy the median element into the result subcontainer: the second
+      // half of the merge starts right after it.
+      if (left) {
+        *middle3 = *middle1;
+      }
+      else {
+        *middle3 = *middle2;
+      }
+      const InputRandomAccessIterator1 next1 = left ? middle1 + 1 : middle1;
+      const InputRandomAccessIterator2 next2 = left ? middle2 : middle2 + 1;
 
       // Merge the part to the left of the median element in the 
       // left subcontainer with the part to the left of the pivot 
@@ -331,12 +778,260 @@ namespace merging {
           strategyBTasking(first1, middle1, first2, middle2, result, comp, cutoff);
         },
         [&] {
-          strategyBTasking(middle1 + 1, last1, middle2, last2, middle3 + 1, comp, cutoff);
+          strategyBTasking(next1, last1, next2, last2, middle3 + 1, comp, cutoff);
         }
       );
 
     } // strategyBTasking
 
+    /**
+     * Recursive part of @c applyCancellable, following @c strategyBTasking.
+     *
+     * @param[in] first1 - an iterator pointing to the first element of the first
+     *   subcontainer involved in the merge;
+     * @param[in] last1 - an iterator pointing to the element just past the 
+     *   last element of the first subcontainer involved in the merge;
+     * @param[in] first2 - an iterator pointing to the first element of the second
+     *   subcontainer involved in the merge;
+     * @param[in] last2 - an iterator pointing to the element just past the 
+     *   last element of the second subcontainer involved in the merge;
+     * @param[in] result - an iterator pointing to the position where the 
+     *   first resulting element of the merge should be copied;
+     * @param[in] comp - a binary comparator representing the total order
+     *   relation governing the subcontainers;
+     * @param[in] cutoff - the sum of the sizes of the two subcontainers below 
+     *   which the merge is performed using the standard library merge algorithm;
+     * @param[in] token - the cancellation token;
+     * @param[in,out] context - the context shared by all the tasks of the
+     *   merge, cancelled as soon as one of them sees the token fire.
+     */
+    template< typename InputRandomAccessIterator1,
+          typename InputRandomAccessIterator2,
+          typename OutputRandomAccessIterator,
+          typename Compare >
+    static void strategyCancellable(const InputRandomAccessIterator1& first1,
+                    const InputRandomAccessIterator1& last1,
+                    const InputRandomAccessIterator2& first2,
+                    const InputRandomAccessIterator2& last2,
+                    const OutputRandomAccessIterator& result,
+                    const Compare& comp,
+                    const size_t& cutoff,
+                    const CancellationToken& token,
+                    tbb::task_group_context& context) {
+
+      // Stop request: discard every pending task of the merge.
+      if (context.is_group_execution_cancelled()) {
+        return;
+      }
+      if (token.cancelled()) {
+        context.cancel_group_execution();
+        return;
+      }
+
+      // Size of the two subcontainers.
+      const auto size1 = last1 - first1;
+      const auto size2 = last2 - first2;
+
+      // We have fallen below the tolerance: recursion stops.
+      if (static_cast< size_t >(size1 + size2) < cutoff) {
+        std::merge(first1, last1, first2, last2, result, comp);
+        return;
+      }
+
+      // Median element of the longer subcontainer and pivot element of the
+      // other one (see split).
+      InputRandomAccessIterator1 middle1;
+      InputRandomAccessIterator2 middle2;
+      const bool left = split(first1, last1, first2, last2, comp, middle1, middle2);
+
+      // Position of the median element in the result, where it is copied.
+      const OutputRandomAccessIterator middle3 = 
+        result + (middle1 - first1) + (middle2 - first2);
+      if (left) {
+        *middle3 = *middle1;
+      }
+      else {
+        *middle3 = *middle2;
+      }
+      const InputRandomAccessIterator1 next1 = left ? middle1 + 1 : middle1;
+      const InputRandomAccessIterator2 next2 = left ? middle2 : middle2 + 1;
+
+      // Both halves run in the shared context.
+      tbb::parallel_invoke(
+        [&] {
+          strategyCancellable(first1, middle1, first2, middle2, result, comp, cutoff, token, context);
+        },
+        [&] {
+          strategyCancellable(next1, last1, next2, last2, middle3 + 1, comp, cutoff, token, context);
+        },
+        context
+      );
+
+    } // strategyCancellable
+
+    /**
+     * Copies the keys of a subcontainer into a contiguous array.
+     *
+     * @param[in] first - an iterator pointing to the first element of the
+     *   subcontainer;
+     * @param[out] keys - the array receiving the keys, already sized;
+     * @param[in] proj - a callable returning the key of an element.
+     */
+    template< typename InputRandomAccessIterator,
+          typename Key,
+          typename Projection >
+    static void extractKeys(const InputRandomAccessIterator& first,
+                std::vector< Key >& keys,
+                const Projection& proj) {
+
+      tbb::parallel_for(tbb::blocked_range< size_t >(0, keys.size()),
+        [&](const tbb::blocked_range< size_t >& range) {
+          for (size_t i = range.begin(); i != range.end(); i ++) {
+            keys[i] = std::invoke(proj, first[i]);
+          }
+        });
+
+    } // extractKeys
+
+    /**
+     * Sequential merge driven by extracted keys: the comparisons only read
+     * the key arrays, and each element is read once, when it is copied.
+     *
+     * @param[in] keys1 - a pointer to the key of the first element of the
+     *   first subcontainer;
+     * @param[in] keysEnd1 - a pointer just past the last key of the first
+     *   subcontainer;
+     * @param[in] first1 - an iterator pointing to the element whose key is
+     *   @c *keys1;
+     * @param[in] keys2 - a pointer to the key of the first element of the
+     *   second subcontainer;
+     * @param[in] keysEnd2 - a pointer just past the last key of the second
+     *   subcontainer;
+     * @param[in] first2 - an iterator pointing to the element whose key is
+     *   @c *keys2;
+     * @param[in] result - an iterator pointing to the position where the 
+     *   first resulting element of the merge should be copied;
+     * @param[in] comp - a binary comparator representing the total order
+     *   relation governing the keys.
+     */
+    template< typename Key,
+          typename InputRandomAccessIterator1,
+          typename InputRandomAccessIterator2,
+          typename OutputRandomAccessIterator,
+          typename Compare >
+    static void mergeKeys(const Key* keys1,
+              const Key* keysEnd1,
+              InputRandomAccessIterator1 first1,
+              const Key* keys2,
+              const Key* keysEnd2,
+              InputRandomAccessIterator2 first2,
+              OutputRandomAccessIterator result,
+              const Compare& comp) {
+
+      // Same tie-breaking rule as std::merge: the first subcontainer wins.
+      while (keys1 != keysEnd1 && keys2 != keysEnd2) {
+        if (comp(*keys2, *keys1)) {
+          *result = *first2;
+          ++ keys2;
+          ++ first2;
+        }
+        else {
+          *result = *first1;
+          ++ keys1;
+          ++ first1;
+        }
+        ++ result;
+      }
+
+      // Copy whichever tail remains.
+      result = std::copy(first1, first1 + (keysEnd1 - keys1), result);
+      std::copy(first2, first2 + (keysEnd2 - keys2), result);
+
+    } // mergeKeys
+
+    /**
+     * Recursive part of the extracted-key mode, following @c strategyBTasking
+     * but searching and comparing the key arrays only.
+     *
+     * @param[in] keys1 - a pointer to the key of the first element of the
+     *   first subcontainer;
+     * @param[in] keysEnd1 - a pointer just past the last key of the first
+     *   subcontainer;
+     * @param[in] first1 - an iterator pointing to the element whose key is
+     *   @c *keys1;
+     * @param[in] keys2 - a pointer to the key of the first element of the
+     *   second subcontainer;
+     * @param[in] keysEnd2 - a pointer just past the last key of the second
+     *   subcontainer;
+     * @param[in] first2 - an iterator pointing to the element whose key is
+     *   @c *keys2;
+     * @param[in] result - an iterator pointing to the position where the 
+     *   first resulting element of the merge should be copied;
+     * @param[in] comp - a binary comparator representing the total order
+     *   relation governing the keys;
+     * @param[in] cutoff - the sum of the sizes of the two subcontainers below 
+     *   which the merge is performed sequentially.
+     */
+    template< typename Key,
+          typename InputRandomAccessIterator1,
+          typename InputRandomAccessIterator2,
+          typename OutputRandomAccessIterator,
+          typename Compare >
+    static void strategyKeys(const Key* keys1,
+                 const Key* keysEnd1,
+                 const InputRandomAccessIterator1& first1,
+                 const Key* keys2,
+                 const Key* keysEnd2,
+                 const InputRandomAccessIterator2& first2,
+                 const OutputRandomAccessIterator& result,
+                 const Compare& comp,
+                 const size_t& cutoff) {
+
+      // Size of the two subcontainers.
+      const auto size1 = keysEnd1 - keys1;
+      const auto size2 = keysEnd2 - keys2;
+
+      // We have fallen below the tolerance: recursion stops.
+      if (static_cast< size_t >(size1 + size2) < cutoff) {
+        mergeKeys(keys1, keysEnd1, first1, keys2, keysEnd2, first2, result, comp);
+        return;
+      }
+
+      // Median key of the longer subcontainer and pivot key of the other one
+      // (see split).
+      const Key* middle1;
+      const Key* middle2;
+      const bool left = split(keys1, keysEnd1, keys2, keysEnd2, comp, middle1, middle2);
+
+      // Ranks of the median and pivot elements.
+      const auto rank1 = middle1 - keys1;
+      const auto rank2 = middle2 - keys2;
+
+      // Position of the median element in the result subcontainer.
+      const OutputRandomAccessIterator middle3 = result + rank1 + rank2;
+      if (left) {
+        *middle3 = *(first1 + rank1);
+      }
+      else {
+        *middle3 = *(first2 + rank2);
+      }
+      const Key* const next1 = left ? middle1 + 1 : middle1;
+      const Key* const next2 = left ? middle2 : middle2 + 1;
+
+      // Merge both halves in parallel.
+      tbb::parallel_invoke(
+        [&] {
+          strategyKeys(keys1, middle1, first1, keys2, middle2, first2, result, comp, cutoff);
+        },
+        [&] {
+          strategyKeys(next1, keysEnd1, first1 + (next1 - keys1),
+                       next2, keysEnd2, first2 + (next2 - keys2),
+                       middle3 + 1, comp, cutoff);
+        }
+      );
+
+    } // strategyKeys
+
   }; // ParallelRecursiveMerge
 
 } // merging
@@ -0,0 +1,368 @@
+#include "ParallelRecursiveMerge.hpp"
+#include "Cancellation.hpp"
+#include "BufferPool.hpp"
+#include <vector>
+#include <string>
+#include <memory>
+#include <iterator>
+#include <cstdio>
+#include <algorithm>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <iostream>
+#include <cstdlib>
+#include <tbb/task_arena.h>
+
+/**
+ * Enregistrement fusionné sur sa clé : l'étiquette, propre à chaque
+ * enregistrement, permet de vérifier l'ordre des égalités.
+ */
+struct Rec {
+    int key; /** Clé de la fusion.              */
+    int tag; /** Étiquette de l'enregistrement. */
+};
+
+/**
+ * Affiche le verdict d'une vérification.
+ *
+ * @param[in] name le nom de la vérification.
+ * @param[in] verdict le verdict.
+ * @return le verdict.
+ */
+static bool report(const char* name, bool verdict) {
+    std::cout << "--[ " << name << ": begin ]--" << std::endl;
+    std::cout << "\tVerdict:\t\t" << std::boolalpha << verdict << std::endl;
+    std::cout << "--[ " << name << ": end ]--" << std::endl;
+    std::cout << std::endl;
+    return verdict;
+}
+
+/**
+ * Fusionne deux tableaux d'enregistrements sur leur clé, avec un mode de
+ * traitement des clés donné, et compare le résultat, étiquettes comprises, à
+ * celui de std::merge avec la même projection.
+ *
+ * @param[in] name le nom de la vérification.
+ * @param[in] lhs le premier tableau trié.
+ * @param[in] rhs le second tableau trié.
+ * @param[in] mode le mode de traitement des clés.
+ * @return @c true si les deux fusions sont identiques.
+ */
+static bool checkProjection(const char* name,
+                            const std::vector<Rec>& lhs,
+                            const std::vector<Rec>& rhs,
+                            merging::ParallelRecursiveMerge::KeyMode mode) {
+    // Relation d'ordre sur les clés et relation projetée pour std::merge.
+    const auto comp = std::less<int>();
+    const auto projected = [&comp](const Rec& a, const Rec& b) {
+        return comp(a.key, b.key);
+    };
+
+    std::vector<Rec> expected(lhs.size() + rhs.size());
+    std::merge(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), expected.begin(), projected);
+
+    // Une petite tolérance multiplie les découpages, donc les égalités
+    // réparties de part et d'autre d'un pivot.
+    std::vector<Rec> result(expected.size());
+    merging::ParallelRecursiveMerge::apply(lhs.begin(),
+                                           lhs.end(),
+                                           rhs.begin(),
+                                           rhs.end(),
+                                           result.begin(),
+                                           comp,
+                                           &Rec::key,
+                                           64,
+                                           mode);
+
+    return report(name, std::equal(result.begin(), result.end(), expected.begin(),
+                                   [](const Rec& a, const Rec& b) {
+                                       return a.key == b.key && a.tag == b.tag;
+                                   }));
+}
+
+/**
+ * Relation d'ordre strictement inférieur à comptant ses appels. Les appels
+ * à partir du rang @c pause attendent que le jeton soit déclenché par un
+ * autre thread, ce qui place l'annulation au milieu de la fusion quel que
+ * soit l'ordonnancement.
+ */
+struct CountingLess {
+    std::atomic<size_t>* count;              /** Nombre d'appels.                    */
+    size_t pause;                            /** Rang du premier appel qui attend,
+                                                 ou 0 si aucun n'attend.          */
+    const merging::CancellationToken* token; /** Jeton attendu.                      */
+
+    bool operator()(const int& lhs, const int& rhs) const {
+        if (count->fetch_add(1, std::memory_order_relaxed) + 1 >= pause && pause != 0) {
+            while (!token->cancelled()) {
+                std::this_thread::yield();
+            }
+        }
+        return lhs < rhs;
+    }
+};
+
+/**
+ * Vérifie applyCancellable : fusion menée à son terme, jeton déclenché avant
+ * l'appel, jeton déclenché par un autre thread en cours de fusion, et
+ * échéance déjà passée.
+ *
+ * @return @c true si toutes les vérifications réussissent.
+ */
+static bool checkCancellation() {
+    typedef merging::CancellationToken CancellationToken;
+
+    // Deux tableaux entrelacés, assez longs pour de nombreuses fusions
+    // séquentielles.
+    const size_t size = 1024 * 1024;
+    const size_t cutoff = 4 * 1024;
+    std::vector<int> lhs(size), rhs(size);
+    for (size_t i = 0; i != size; i++) {
+        lhs[i] = static_cast<int>(2 * i);
+        rhs[i] = static_cast<int>(2 * i + 1);
+    }
+    std::vector<int> expected(2 * size), result(2 * size);
+    std::merge(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), expected.begin());
+
+    bool verdict = true;
+
+    // Sans déclenchement, la fusion va à son terme.
+    {
+        std::atomic<size_t> count(0);
+        CancellationToken token;
+        const bool completed =
+            merging::ParallelRecursiveMerge::applyCancellable(lhs.begin(), lhs.end(),
+                                                              rhs.begin(), rhs.end(),
+                                                              result.begin(),
+                                                              CountingLess{ &count, 0, &token },
+                                                              cutoff,
+                                                              token);
+        verdict &= report("annulation : sans déclenchement",
+                          completed && result == expected);
+    }
+
+    // Jeton déclenché avant l'appel : aucune comparaison.
+    {
+        std::atomic<size_t> count(0);
+        CancellationToken token;
+        token.cancel();
+        const bool completed =
+            merging::ParallelRecursiveMerge::applyCancellable(lhs.begin(), lhs.end(),
+                                                              rhs.begin(), rhs.end(),
+                                                              result.begin(),
+                                                              CountingLess{ &count, 0, &token },
+                                                              cutoff,
+                                                              token);
+        verdict &= report("annulation : avant l'appel", !completed && count.load() == 0);
+    }
+
+    // Jeton déclenché par un autre thread au quart de la fusion. Chaque
+    // tâche en cours termine au plus une fusion séquentielle de moins de
+    // cutoff éléments, précédée d'une recherche dichotomique.
+    {
+        std::atomic<size_t> count(0);
+        CancellationToken token;
+        const size_t pause = size / 2;
+        size_t atCancel = 0;
+        std::thread canceller([&] {
+            while (count.load() < pause) {
+                std::this_thread::yield();
+            }
+            token.cancel();
+            atCancel = count.load();
+        });
+        const bool completed =
+            merging::ParallelRecursiveMerge::applyCancellable(lhs.begin(), lhs.end(),
+                                                              rhs.begin(), rhs.end(),
+                                                              result.begin(),
+                                                              CountingLess{ &count, pause, &token },
+                                                              cutoff,
+                                                              token);
+        canceller.join();
+        const size_t bound = tbb::this_task_arena::max_concurrency() * (cutoff + 64);
+        std::cout << "--[ annulation : en cours de fusion: begin ]--" << std::endl;
+        std::cout << "\tComparaisons après l'annulation:\t" << count.load() - atCancel
+                  << " / " << bound << std::endl;
+        std::cout << "\tVerdict:\t\t" << std::boolalpha
+                  << (!completed && count.load() - atCancel <= bound) << std::endl;
+        std::cout << "--[ annulation : en cours de fusion: end ]--" << std::endl;
+        std::cout << std::endl;
+        verdict &= !completed && count.load() - atCancel <= bound;
+    }
+
+    // Échéance déjà passée : aucune comparaison.
+    {
+        std::atomic<size_t> count(0);
+        CancellationToken token(CancellationToken::Clock::now());
+        const bool completed =
+            merging::ParallelRecursiveMerge::applyCancellable(lhs.begin(), lhs.end(),
+                                                              rhs.begin(), rhs.end(),
+                                                              result.begin(),
+                                                              CountingLess{ &count, 0, &token },
+                                                              cutoff,
+                                                              token);
+        verdict &= report("annulation : échéance passée", !completed && count.load() == 0);
+    }
+
+    return verdict;
+}
+
+/**
+ * Enregistrement non trivialement copiable, fusionné sur son libellé, qui
+ * tient le compte des instances vivantes : une fusion dans une zone non
+ * initialisée doit en construire exactement une par élément, et la
+ * destruction de la zone doit toutes les détruire.
+ */
+struct Tracked {
+    static std::atomic<long> live; /** Nombre d'instances vivantes. */
+
+    std::string label; /** Libellé, assez long pour être alloué sur le tas. */
+    int tag;           /** Étiquette de l'enregistrement.                    */
+
+    Tracked(const std::string& label, int tag) : label(label), tag(tag) { live++; }
+    Tracked(const Tracked& other) : label(other.label), tag(other.tag) { live++; }
+    Tracked& operator=(const Tracked& other) = default;
+    ~Tracked() { live--; }
+
+    bool operator<(const Tracked& other) const { return label < other.label; }
+};
+
+std::atomic<long> Tracked::live(0);
+
+/**
+ * Construit un tableau trié d'enregistrements dont les libellés se répètent.
+ *
+ * @param[in] size le nombre d'enregistrements.
+ * @param[in] repeat le nombre d'enregistrements par libellé.
+ * @param[in] tag l'étiquette du premier enregistrement.
+ * @return le tableau.
+ */
+static std::vector<Tracked> makeTracked(size_t size, size_t repeat, int tag) {
+    std::vector<Tracked> records;
+    records.reserve(size);
+    for (size_t i = 0; i != size; i++) {
+        char label[64];
+        std::snprintf(label, sizeof(label), "enregistrement numéro %010zu", i / repeat);
+        records.emplace_back(label, tag + static_cast<int>(i));
+    }
+    return records;
+}
+
+/**
+ * Fusionne deux tableaux d'enregistrements non trivialement copiables dans un
+ * tampon du BufferPool avec applyUninitialized et compare le résultat,
+ * étiquettes comprises, à celui de std::merge.
+ *
+ * @param[in] lhs le premier tableau trié.
+ * @param[in] rhs le second tableau trié.
+ * @param[in] lease le tampon, non initialisé, de lhs.size() + rhs.size()
+ *   éléments.
+ * @return @c true si le tampon contient exactement un enregistrement vivant
+ *   par élément et si les deux fusions sont identiques.
+ */
+static bool mergeTracked(const std::vector<Tracked>& lhs,
+                         const std::vector<Tracked>& rhs,
+                         const merging::BufferPool::Lease<Tracked>& lease) {
+    std::vector<Tracked> expected;
+    expected.reserve(lease.size());
+    std::merge(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(expected));
+
+    const long before = Tracked::live.load();
+    Tracked* const end =
+        merging::ParallelRecursiveMerge::applyUninitialized(lhs.begin(), lhs.end(),
+                                                            rhs.begin(), rhs.end(),
+                                                            lease.begin(),
+                                                            std::less<Tracked>(),
+                                                            64);
+    const bool constructed = Tracked::live.load() - before == static_cast<long>(lease.size());
+
+    return constructed && end == lease.end() &&
+        std::equal(lease.begin(), lease.end(), expected.begin(),
+                   [](const Tracked& a, const Tracked& b) {
+                       return a.label == b.label && a.tag == b.tag;
+                   });
+}
+
+/**
+ * Vérifie applyUninitialized avec des éléments non trivialement copiables,
+ * qui passent par la construction en place, dans un tampon du BufferPool ;
+ * puis rend ce tampon et en redemande un plus petit, qui doit le réutiliser.
+ *
+ * @return @c true si toutes les vérifications réussissent.
+ */
+static bool checkUninitialized() {
+    merging::BufferPool pool;
+
+    // Deux tableaux aux libellés souvent égaux, dont la fusion occupe
+    // plusieurs pages géantes.
+    const std::vector<Tracked> lhs = makeTracked(100000, 3, 0);
+    const std::vector<Tracked> rhs = makeTracked(150000, 5, 1000000);
+    const long live = Tracked::live.load();
+
+    bool verdict = true;
+
+    // Premier tampon, rendu au pool une fois les enregistrements détruits.
+    const Tracked* first = nullptr;
+    {
+        auto lease = pool.acquire<Tracked>(lhs.size() + rhs.size());
+        first = lease.data();
+        bool merged = mergeTracked(lhs, rhs, lease);
+        std::destroy(lease.begin(), lease.end());
+        merged &= Tracked::live.load() == live;
+        verdict &= report("zone non initialisée : construction en place", merged);
+    }
+
+    // Un tampon plus petit, de plus de la moitié du premier, le réutilise.
+    {
+        const std::vector<Tracked> lhs2(lhs.begin(), lhs.begin() + 60000);
+        const std::vector<Tracked> rhs2(rhs.begin(), rhs.begin() + 90000);
+        auto lease = pool.acquire<Tracked>(lhs2.size() + rhs2.size());
+        const bool reused = lease.data() == first;
+        bool merged = mergeTracked(lhs2, rhs2, lease);
+        std::destroy(lease.begin(), lease.end());
+        merged &= Tracked::live.load() == live + static_cast<long>(lhs2.size() + rhs2.size());
+        verdict &= report("zone non initialisée : réutilisation du tampon", reused && merged);
+    }
+
+    return verdict && Tracked::live.load() == live;
+}
+
+/**
+ * Programme principal : vérifie les formes de ParallelRecursiveMerge que le
+ * banc d'essai n'emploie pas.
+ *
+ * @return @c EXIT_SUCCESS si toutes les vérifications réussissent ou
+ *   @c EXIT_FAILURE sinon.
+ */
+int main() {
+    typedef merging::ParallelRecursiveMerge::KeyMode KeyMode;
+
+    // Deux tableaux de tailles différentes, aux clés très souvent égales, à
+    // l'intérieur de chacun comme entre les deux.
+    std::vector<Rec> lhs(20000), rhs(50000);
+    for (size_t i = 0; i != lhs.size(); i++) {
+        lhs[i] = { static_cast<int>(i / 7), static_cast<int>(i) };
+    }
+    for (size_t i = 0; i != rhs.size(); i++) {
+        rhs[i] = { static_cast<int>(i / 13), static_cast<int>(1000000 + i) };
+    }
+
+    bool verdict = true;
+
+    // Fusions sur une clé projetée, le plus long tableau étant tour à tour
+    // le premier et le second.
+    verdict &= checkProjection("projection directe", lhs, rhs, KeyMode::direct);
+    verdict &= checkProjection("projection directe inversée", rhs, lhs, KeyMode::direct);
+    verdict &= checkProjection("clés extraites", lhs, rhs, KeyMode::extracted);
+    verdict &= checkProjection("clés extraites inversées", rhs, lhs, KeyMode::extracted);
+
+    // Fusions interrompues.
+    verdict &= checkCancellation();
+
+    // Fusions dans une zone non initialisée du BufferPool.
+    verdict &= checkUninitialized();
+
+    return verdict ? EXIT_SUCCESS : EXIT_FAILURE;
+}
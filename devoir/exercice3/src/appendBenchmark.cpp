@@ -0,0 +1,133 @@
+#include "ParallelRecursiveMerge.hpp"
+#include "BufferPool.hpp"
+#include "Metrics.hpp"
+#include <vector>
+#include <numeric>
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <cstdlib>
+#include <tbb/global_control.h>
+
+/**
+ * Programme principal : compare std::merge et ParallelRecursiveMerge sur des
+ * fusions de type « ajout en fin », pour lesquelles le pré-test de
+ * recouvrement réduit la fusion à des copies parallèles.
+ *
+ * @param[in] argc le nombre d'arguments de la ligne de commandes.
+ * @param[in] argv les arguments de la ligne de commandes.
+ * @return @c EXIT_SUCCESS en cas d'exécution réussie ou @c EXIT_FAILURE en cas
+ *   de problèmes.
+ */
+int main(int argc, char* argv[]) {
+    // La ligne de commandes est vide : l'utilisateur demande de l'aide.
+    if (argc == 1) {
+        std::cout << "Usage: " << argv[0] << " nb_iterations" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    // Le nombre d'arguments est différent de 1 : l'utilisateur fait n'importe quoi.
+    if (argc != 2) {
+        std::cerr << "Nombre d'argument(s) incorrect." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Tentative d'extraction du nombre d'itérations.
+    size_t iters;
+    {
+        std::istringstream entree(argv[1]);
+        entree >> iters;
+        if (!entree || !entree.eof()) {
+            std::cerr << "Argument incorrect." << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Synonyme du type des éléments à fusionner.
+    typedef int Type;
+
+    // Relation d'ordre utilisée : strictement inférieur à.
+    const auto comp = std::less<const Type&>();
+
+    // Taille de chacun des deux tableaux et tolérance de la récursion.
+    const size_t size = 4 * 1024 * 1024;
+    const size_t cutoff = 16 * 1024;
+
+    // Obtention du nombre de threads disponibles via TBB.
+    const int threads = tbb::global_control::active_value(tbb::global_control::max_allowed_parallelism);
+
+    // Zone non initialisée accueillant le résultat des fusions.
+    merging::BufferPool pool;
+    auto result = pool.acquire<Type>(2 * size);
+
+    // Distributions testées : le second tableau commence après la fin du
+    // premier, le recouvre sur une bande de 1 %, ou s'entrelace avec lui.
+    struct Distribution {
+        const char* name; /** Nom de la distribution.           */
+        Type shift;       /** Premier élément du second tableau. */
+        Type step;        /** Pas entre deux éléments.           */
+    };
+    const Distribution distributions[] = {
+        { "ajout", static_cast<Type>(size), 1 },
+        { "bande 1%", static_cast<Type>(size - size / 100), 1 },
+        { "entrelacement", 1, 2 }
+    };
+
+    for (const Distribution& distribution : distributions) {
+        // Deux tableaux triés à fusionner.
+        std::vector<Type> lhs(size), rhs(size);
+        for (size_t i = 0; i != size; i++) {
+            lhs[i] = static_cast<Type>(i) * distribution.step;
+            rhs[i] = distribution.shift + static_cast<Type>(i) * distribution.step;
+        }
+
+        // Durée d'exécution de l'algorithme merge de la bibliothèque standard.
+        double seq;
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            for (size_t i = 0; i != iters; i++) {
+                std::merge(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), result.begin(), comp);
+            }
+            auto stop = std::chrono::high_resolution_clock::now();
+            seq = std::chrono::duration<double>(stop - start).count();
+        }
+
+        // Durée d'exécution de notre version parallèle.
+        double par;
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            for (size_t i = 0; i != iters; i++) {
+                merging::ParallelRecursiveMerge::applyUninitialized(lhs.begin(),
+                                                                    lhs.end(),
+                                                                    rhs.begin(),
+                                                                    rhs.end(),
+                                                                    result.begin(),
+                                                                    comp,
+                                                                    cutoff);
+            }
+            auto stop = std::chrono::high_resolution_clock::now();
+            par = std::chrono::duration<double>(stop - start).count();
+        }
+
+        // Affichage des performances.
+        std::cout << "--[ " << distribution.name << ": begin ]--" << std::endl;
+        std::cout << "\tThread(s):\t" << threads << std::endl;
+        std::cout << "\tmerge:\t\t" << seq << " sec." << std::endl;
+        std::cout << "\tParallelRecursiveMerge:\t" << par << " sec." << std::endl;
+        std::cout << "\tVerdict:\t\t"
+                  << std::boolalpha
+                  << std::is_sorted(result.begin(), result.end(), comp)
+                  << std::endl;
+        std::cout << "\tSpeedup:\t"
+                  << Metrics::speedup(seq, par)
+                  << std::endl;
+        std::cout << "\tEfficiency:\t"
+                  << Metrics::efficiency(seq, par, threads)
+                  << std::endl;
+        std::cout << "--[ " << distribution.name << ": end ]--" << std::endl;
+        std::cout << std::endl;
+    }
+
+    // Tout s'est bien passé.
+    return EXIT_SUCCESS;
+}
@@ -1,4 +1,5 @@
 #include "ParallelRecursiveMerge.hpp"
+#include "BufferPool.hpp"
 #include "Metrics.hpp"
 #include <vector>
 #include <numeric>
@@ -51,8 +52,11 @@ int main(int argc, char* argv[]) {
     std::iota(lhs.begin(), lhs.end(), 19);
     std::iota(rhs.begin(), rhs.end(), 5);
 
-    // Conteneur accueillant le résultat de la fusion.
-    std::vector<Type> result(lhs.size() + rhs.size());
+    // Zone non initialisée accueillant le résultat de la fusion : elle est
+    // fournie par un pool de tampons alignés sur des pages géantes, que l'on
+    // peut recycler d'une fusion à l'autre.
+    merging::BufferPool pool;
+    auto result = pool.acquire<Type>(lhs.size() + rhs.size());
 
     // Durée d'exécution de l'algorithme merge de la bibliothèque standard.
     double seq;
@@ -92,13 +96,13 @@ int main(int argc, char* argv[]) {
         // Durée d'exécution de notre version parallèle.
         auto start = std::chrono::high_resolution_clock::now();
         for (size_t i = 0; i != iters; i++) {
-            merging::ParallelRecursiveMerge::apply(lhs.begin(),
-                                                   lhs.end(),
-                                                   rhs.begin(),
-                                                   rhs.end(),
-                                                   result.begin(),
-                                                   comp,
-                                                   cutoff);
+            merging::ParallelRecursiveMerge::applyUninitialized(lhs.begin(),
+                                                                lhs.end(),
+                                                                rhs.begin(),
+                                                                rhs.end(),
+                                                                result.begin(),
+                                                                comp,
+                                                                cutoff);
         }
         auto stop = std::chrono::high_resolution_clock::now();
         double par = std::chrono::duration<double>(stop - start).count();
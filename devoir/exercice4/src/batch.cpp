@@ -0,0 +1,147 @@
+#include "batch.hpp"
+#include "correlation.hpp"
+#include "data_set.hpp"
+#include "mapped_file.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <system_error>
+#include <tbb/global_control.h>
+#include <tbb/parallel_pipeline.h>
+
+/* -------------------------------------------------------------------------- */
+/*                                 list_batch                                 */
+/* -------------------------------------------------------------------------- */
+
+std::vector<std::string> list_batch(const char *path) {
+  std::vector<std::string> res;
+
+  if (std::filesystem::is_directory(path)) {
+    for (const auto &entry : std::filesystem::directory_iterator(path)) {
+      if (entry.is_regular_file()) {
+        res.push_back(entry.path().string());
+      }
+    }
+    std::sort(res.begin(), res.end());
+    return res;
+  }
+
+  std::ifstream list(path);
+  if (not list) {
+    throw std::system_error(errno, std::generic_category(), path);
+  }
+  std::string line;
+  while (std::getline(list, line)) {
+    if (not line.empty()) {
+      res.push_back(line);
+    }
+  }
+  return res;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               correlate_files                              */
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+/**
+ * @brief A file going through the pipeline.
+ *
+ */
+struct Batch_Item {
+  const std::string *filename;       /** File name.                   */
+  std::unique_ptr<Mapped_File> file; /** Mapping, until parsed.       */
+  Data_Set data_set;                 /** Data set, until reduced.     */
+  Correlation result;                /** Result.                      */
+  size_t bytes = 0;                  /** Size of the file.            */
+  std::string error;                 /** Error message, if it failed. */
+};
+
+} // namespace
+
+Batch_Summary correlate_files(const std::vector<std::string> &filenames,
+                              std::ostream &out, std::ostream &err,
+                              size_t live_files) {
+  if (live_files == 0) {
+    live_files = 2 * tbb::global_control::active_value(
+                         tbb::global_control::max_allowed_parallelism);
+  }
+
+  Batch_Summary summary{0, 0, 0, 0.0};
+  size_t next = 0;
+  const auto start = std::chrono::steady_clock::now();
+
+  tbb::parallel_pipeline(
+      live_files,
+      // Read: maps the next file and reads it in.
+      tbb::make_filter<void, Batch_Item *>(
+          tbb::filter_mode::serial_in_order,
+          [&](tbb::flow_control &control) -> Batch_Item * {
+            if (next == filenames.size()) {
+              control.stop();
+              return nullptr;
+            }
+            Batch_Item *const item = new Batch_Item;
+            item->filename = &filenames[next++];
+            try {
+              item->file = std::make_unique<Mapped_File>(item->filename->c_str(), true);
+              item->bytes = item->file->size();
+            } catch (const std::system_error &e) {
+              item->error = e.code().message();
+            } catch (const std::exception &e) {
+              item->error = e.what();
+            }
+            return item;
+          }) &
+          // Parse: text is parsed, binary is used in place.
+          tbb::make_filter<Batch_Item *, Batch_Item *>(
+              tbb::filter_mode::parallel,
+              [](Batch_Item *item) {
+                if (item->error.empty()) {
+                  try {
+                    item->data_set = load_mapped(std::move(*item->file));
+                  } catch (const std::exception &e) {
+                    item->error = e.what();
+                  }
+                  item->file.reset();
+                }
+                return item;
+              }) &
+          // Reduce: calculates the correlation, then frees the data set.
+          tbb::make_filter<Batch_Item *, Batch_Item *>(
+              tbb::filter_mode::parallel,
+              [](Batch_Item *item) {
+                if (item->error.empty()) {
+                  item->result = calculate(item->data_set);
+                  item->data_set = Data_Set();
+                }
+                return item;
+              }) &
+          // Emit: one line per file, in the order of the list.
+          tbb::make_filter<Batch_Item *, void>(
+              tbb::filter_mode::serial_in_order,
+              [&](Batch_Item *item) {
+                const std::unique_ptr<Batch_Item> owner(item);
+                summary.files++;
+                summary.bytes += item->bytes;
+                if (not item->error.empty()) {
+                  summary.failures++;
+                  err << *item->filename << ": " << item->error << '\n';
+                  return;
+                }
+                out << *item->filename << "\ta: " << item->result.a
+                    << "\tb: " << item->result.b << "\tr: " << item->result.r
+                    << '\n';
+              }));
+
+  out.flush();
+  err.flush();
+  const auto stop = std::chrono::steady_clock::now();
+  summary.seconds = std::chrono::duration<double>(stop - start).count();
+  return summary;
+}
@@ -0,0 +1,176 @@
+#include "binary_format.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+
+/* -------------------------------------------------------------------------- */
+/*                                   helpers                                  */
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "the binary format is written in the host byte order");
+
+/**
+ * @brief Rounds an offset up to a multiple of a power of two.
+ *
+ */
+inline uint64_t align_up(uint64_t offset, uint64_t alignment) noexcept {
+  return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+/**
+ * @brief Mixes the bits of a measurement with its position (splitmix64).
+ *
+ */
+inline uint64_t mix(double value, uint64_t position) noexcept {
+  uint64_t z;
+  std::memcpy(&z, &value, sizeof z);
+  z += position * 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/**
+ * @brief Writes a block into a file, or throws.
+ *
+ */
+void write_block(std::FILE *stream, const void *data, size_t size,
+                 const char *filename) {
+  if (size != 0 && std::fwrite(data, 1, size, stream) != size) {
+    const int error = errno;
+    std::fclose(stream);
+    throw std::system_error(error, std::generic_category(), filename);
+  }
+}
+
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/*                                  is_binary                                 */
+/* -------------------------------------------------------------------------- */
+
+bool is_binary(const char *data, size_t size) noexcept {
+  return size >= sizeof(Binary_Header) &&
+         std::memcmp(data, Binary_Format::magic, sizeof Binary_Format::magic) == 0;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               column_checksum                              */
+/* -------------------------------------------------------------------------- */
+
+uint64_t column_checksum(const double *x, const double *y, size_t n) noexcept {
+  return tbb::parallel_reduce(
+      tbb::blocked_range<size_t>(0, n), uint64_t(0),
+      [x, y, n](const tbb::blocked_range<size_t> &r, uint64_t sum) {
+        for (size_t i = r.begin(); i != r.end(); i++) {
+          sum += mix(x[i], i) + mix(y[i], n + i);
+        }
+        return sum;
+      },
+      [](uint64_t lhs, uint64_t rhs) { return lhs + rhs; });
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 save_binary                                */
+/* -------------------------------------------------------------------------- */
+
+void save_binary(const char *filename, const Data_Set &data_set,
+                 size_t alignment) {
+  if (alignment < sizeof(double) || (alignment & (alignment - 1)) != 0) {
+    throw std::invalid_argument("alignment must be a power of two multiple of 8");
+  }
+
+  const uint64_t column = data_set.n * sizeof(double);
+
+  Binary_Header header{};
+  std::memcpy(header.magic, Binary_Format::magic, sizeof header.magic);
+  header.version = Binary_Format::version;
+  header.dtype = static_cast<uint32_t>(Binary_Dtype::float64_le);
+  header.n = data_set.n;
+  header.alignment = alignment;
+  header.x_offset = align_up(sizeof header, alignment);
+  header.y_offset = align_up(header.x_offset + column, alignment);
+  header.checksum = column_checksum(data_set.x, data_set.y, data_set.n);
+
+  std::FILE *const stream = std::fopen(filename, "wb");
+  if (stream == nullptr) {
+    throw std::system_error(errno, std::generic_category(), filename);
+  }
+
+  const std::vector<char> padding(alignment, 0);
+  write_block(stream, &header, sizeof header, filename);
+  write_block(stream, padding.data(), header.x_offset - sizeof header, filename);
+  write_block(stream, data_set.x, column, filename);
+  write_block(stream, padding.data(), header.y_offset - header.x_offset - column,
+              filename);
+  write_block(stream, data_set.y, column, filename);
+
+  if (std::fclose(stream) != 0) {
+    throw std::system_error(errno, std::generic_category(), filename);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/*                             check_binary_header                            */
+/* -------------------------------------------------------------------------- */
+
+void check_binary_header(const Binary_Header &header, uint64_t size) {
+  if (header.version != Binary_Format::version) {
+    throw std::runtime_error("unsupported binary version " +
+                             std::to_string(header.version));
+  }
+  if (header.dtype != static_cast<uint32_t>(Binary_Dtype::float64_le)) {
+    throw std::runtime_error("unsupported binary dtype " +
+                             std::to_string(header.dtype));
+  }
+
+  // The columns must be aligned, in order, and inside the file.
+  const uint64_t column = header.n * sizeof(double);
+  const bool valid =
+      header.alignment >= sizeof(double) &&
+      (header.alignment & (header.alignment - 1)) == 0 &&
+      header.n <= size / sizeof(double) &&
+      header.x_offset % header.alignment == 0 &&
+      header.y_offset % header.alignment == 0 &&
+      header.x_offset >= sizeof header && header.x_offset <= size &&
+      header.y_offset >= header.x_offset + column &&
+      header.y_offset <= size && column <= size - header.y_offset;
+  if (not valid) {
+    throw std::runtime_error("corrupted binary header");
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 load_binary                                */
+/* -------------------------------------------------------------------------- */
+
+Data_Set load_binary(Mapped_File &&file, bool verify) {
+  if (not is_binary(file.data(), file.size())) {
+    throw std::runtime_error("not a binary data set");
+  }
+
+  Binary_Header header;
+  std::memcpy(&header, file.data(), sizeof header);
+  check_binary_header(header, file.size());
+
+  Data_Set res;
+  res.n = header.n;
+  res.x = reinterpret_cast<const double *>(file.data() + header.x_offset);
+  res.y = reinterpret_cast<const double *>(file.data() + header.y_offset);
+
+  if (verify && column_checksum(res.x, res.y, res.n) != header.checksum) {
+    throw std::runtime_error("binary checksum mismatch");
+  }
+
+  res.storage = std::make_shared<const Mapped_File>(std::move(file));
+  return res;
+}
@@ -0,0 +1,232 @@
+#include "bootstrap.hpp"
+#include "moments.hpp"
+#include "normal.hpp"
+#include "philox.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/parallel_sort.h>
+
+/* -------------------------------------------------------------------------- */
+/*                                   helpers                                  */
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+/** Number of measurements of a resample gathered before their moments. */
+constexpr size_t block = 256;
+
+/** Largest number of measurements of a leaf of the jackknife reductions. */
+constexpr size_t jackknife_grain = 16384;
+
+/** Sums over the jackknife estimates of a, b and r. */
+using Triple = std::array<double, 3>;
+
+/**
+ * @brief Returns the parameters of a correlation, in the order a, b, r.
+ *
+ */
+inline Triple parameters(const Correlation &correlation) noexcept {
+  return {correlation.a, correlation.b, correlation.r};
+}
+
+/**
+ * @brief Returns the p-quantile of sorted values, interpolating linearly.
+ *
+ */
+double quantile(const std::vector<double> &sorted, double p) noexcept {
+  if (sorted.empty()) {
+    return NAN;
+  }
+  const double position = p * static_cast<double>(sorted.size() - 1);
+  const size_t low = static_cast<size_t>(position);
+  const size_t high = std::min(low + 1, sorted.size() - 1);
+  const double weight = position - static_cast<double>(low);
+  return sorted[low] + weight * (sorted[high] - sorted[low]);
+}
+
+/**
+ * @brief Calculates the moments of a resample, gathering its measurements by
+ * blocks.
+ *
+ * @param philox The generator.
+ * @param k The resample, which is also the stream of the generator.
+ */
+Moments resample_moments(const Data_Set &data_set, const Philox &philox,
+                         uint64_t k) noexcept {
+  const size_t n = data_set.n;
+
+  // Picks a block of measurements first, then gathers them, so that their
+  // cache misses overlap.
+  size_t picks[block];
+  double values[2 * block]; // x in the first half, y in the second one.
+  Block_Moments res;
+  for (size_t first = 0; first < n; first += block) {
+    const size_t count = std::min(block, n - first);
+    for (size_t i = 0; i < count; i += 2) {
+      const std::array<uint64_t, 2> words = philox(k, (first + i) / 2);
+      // Maps the words to [0, n) by a multiplication (Lemire).
+      picks[i] = static_cast<size_t>(
+          static_cast<unsigned __int128>(words[0]) * n >> 64);
+      picks[i + 1] = static_cast<size_t>(
+          static_cast<unsigned __int128>(words[1]) * n >> 64);
+    }
+    for (size_t i = 0; i != count; i++) {
+      values[i] = data_set.x[picks[i]];
+      values[block + i] = data_set.y[picks[i]];
+    }
+    res.push(values, values + block, count);
+  }
+  return res.total();
+}
+
+/**
+ * @brief Calculates the acceleration of the BCa intervals of a, b and r from
+ * their jackknife estimates, in two deterministic parallel passes: the
+ * average of the estimates, then the sums of the powers of their deviations.
+ *
+ * @param full The moments of the whole data set.
+ */
+Triple acceleration(const Data_Set &data_set, const Moments &full) {
+  const size_t n = data_set.n;
+
+  // Estimates of a, b and r without the measurement i.
+  const auto jackknife = [&](size_t i) {
+    Moments moments = full;
+    moments.pop(data_set.x[i], data_set.y[i]);
+    return parameters(moments.correlation());
+  };
+  const auto add = [](Triple lhs, const Triple &rhs) {
+    for (size_t p = 0; p != 3; p++) {
+      lhs[p] += rhs[p];
+    }
+    return lhs;
+  };
+
+  const Triple sums = tbb::parallel_deterministic_reduce(
+      tbb::blocked_range<size_t>(0, n, jackknife_grain), Triple{},
+      [&](const tbb::blocked_range<size_t> &r, Triple sum) {
+        for (size_t i = r.begin(); i != r.end(); i++) {
+          sum = add(sum, jackknife(i));
+        }
+        return sum;
+      },
+      add);
+
+  // Sums of the squares then of the cubes of the deviations.
+  using Powers = std::array<Triple, 2>;
+  const Powers powers = tbb::parallel_deterministic_reduce(
+      tbb::blocked_range<size_t>(0, n, jackknife_grain), Powers{},
+      [&](const tbb::blocked_range<size_t> &r, Powers sum) {
+        for (size_t i = r.begin(); i != r.end(); i++) {
+          const Triple estimate = jackknife(i);
+          for (size_t p = 0; p != 3; p++) {
+            const double deviation = sums[p] / n - estimate[p];
+            sum[0][p] += deviation * deviation;
+            sum[1][p] += deviation * deviation * deviation;
+          }
+        }
+        return sum;
+      },
+      [&](const Powers &lhs, const Powers &rhs) {
+        return Powers{add(lhs[0], rhs[0]), add(lhs[1], rhs[1])};
+      });
+
+  Triple res;
+  for (size_t p = 0; p != 3; p++) {
+    res[p] = powers[0][p] == 0.0
+                 ? 0.0
+                 : powers[1][p] / (6.0 * std::pow(powers[0][p], 1.5));
+  }
+  return res;
+}
+
+/**
+ * @brief Calculates the percentile and BCa intervals of a parameter from its
+ * bootstrap estimates.
+ *
+ * @param values The bootstrap estimates, sorted in place; those that are not
+ * finite (degenerate resamples) are dropped.
+ * @param estimate The estimate of the whole data set.
+ * @param acceleration The jackknife acceleration.
+ * @param confidence The confidence level.
+ */
+Bootstrap_Intervals intervals(std::vector<double> &values, double estimate,
+                              double acceleration, double confidence) {
+  values.erase(std::remove_if(values.begin(), values.end(),
+                              [](double v) { return not std::isfinite(v); }),
+               values.end());
+  tbb::parallel_sort(values.begin(), values.end());
+
+  const double alpha = (1.0 - confidence) / 2.0;
+  Bootstrap_Intervals res;
+  res.percentile = {quantile(values, alpha), quantile(values, 1.0 - alpha)};
+
+  // Bias correction: where the estimate falls among the bootstrap ones,
+  // ties counting for half, kept off 0 and 1.
+  const double count = static_cast<double>(values.size());
+  const auto lower = std::lower_bound(values.begin(), values.end(), estimate);
+  const auto upper = std::upper_bound(lower, values.end(), estimate);
+  const double below = static_cast<double>(lower - values.begin()) +
+                       static_cast<double>(upper - lower) / 2.0;
+  const double z0 = normal_quantile(
+      std::min(std::max(below / count, 0.5 / count), 1.0 - 0.5 / count));
+
+  const auto adjusted = [&](double p) {
+    const double z = z0 + normal_quantile(p);
+    return normal_cdf(z0 + z / (1.0 - acceleration * z));
+  };
+  res.bca = {quantile(values, adjusted(alpha)),
+             quantile(values, adjusted(1.0 - alpha))};
+  return res;
+}
+
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/*                                  bootstrap                                 */
+/* -------------------------------------------------------------------------- */
+
+Bootstrap_Result bootstrap(const Data_Set &data_set, size_t resamples,
+                           double confidence, uint64_t seed) {
+  if (data_set.n < 3) {
+    throw std::invalid_argument("the bootstrap needs at least 3 measurements");
+  }
+  if (resamples < 2) {
+    throw std::invalid_argument("the bootstrap needs at least 2 resamples");
+  }
+  if (not(confidence > 0.0 && confidence < 1.0)) {
+    throw std::invalid_argument("the confidence level must be in (0, 1)");
+  }
+
+  const Moments full =
+      calculate_moments_deterministic(data_set.x, data_set.y, data_set.n);
+
+  // Estimates of a, b and r of every resample.
+  const Philox philox(seed);
+  std::vector<double> a(resamples), b(resamples), r(resamples);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, resamples),
+                    [&](const tbb::blocked_range<size_t> &range) {
+                      for (size_t k = range.begin(); k != range.end(); k++) {
+                        const Correlation correlation =
+                            resample_moments(data_set, philox, k).correlation();
+                        a[k] = correlation.a;
+                        b[k] = correlation.b;
+                        r[k] = correlation.r;
+                      }
+                    });
+
+  const Triple accelerations = acceleration(data_set, full);
+
+  Bootstrap_Result res;
+  res.estimate = full.correlation();
+  res.a = intervals(a, res.estimate.a, accelerations[0], confidence);
+  res.b = intervals(b, res.estimate.b, accelerations[1], confidence);
+  res.r = intervals(r, res.estimate.r, accelerations[2], confidence);
+  return res;
+}
@@ -0,0 +1,265 @@
+#include "column_buffer.hpp"
+#include "correlation.hpp"
+#include "moments.hpp"
+#include "simd_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <tbb/parallel_reduce.h>
+#include <tbb/blocked_range.h>
+
+/* -------------------------------------------------------------------------- */
+/*                             calculate_two_pass                             */
+/* -------------------------------------------------------------------------- */
+
+class AverageReducer {
+  public:
+    const double* x;
+    const double* y;
+    double sum_x, sum_y;
+    size_t n;
+
+    AverageReducer (const double* x, const double* y) : x(x), y(y), sum_x(0.0), sum_y(0.0) {}
+
+    AverageReducer (const AverageReducer& other, tbb::split) : x(other.x), y(other.y), sum_x(0.0), sum_y(0.0) {}
+
+    void operator() (const tbb::blocked_range<size_t>& r) {
+      for (size_t i = r.begin(); i != r.end(); i ++) {
+        sum_x += x[i];
+        sum_y += y[i];
+      }
+    }
+
+    void join (const AverageReducer& other) {
+      sum_x += other.sum_x;
+      sum_y += other.sum_y;
+    }
+};
+
+
+class PearsonReducer {
+  public:
+    const double* x;
+    const double* y;
+    double avg_x, avg_y;
+    double tot_xx, tot_xy, tot_yy;
+
+    PearsonReducer (const double* x, const double* y, double avg_x, double avg_y) : x(x), y(y), avg_x(avg_x), avg_y(avg_y), tot_xx(0.0), tot_xy(0.0), tot_yy(0.0) {}
+
+    PearsonReducer (const PearsonReducer& other, tbb::split) : x(other.x), y(other.y), avg_x(other.avg_x), avg_y(other.avg_y), tot_xx(0.0), tot_xy(0.0), tot_yy(0.0) {}
+
+    void operator() (const tbb::blocked_range<size_t>& r) {
+      for (size_t i = r.begin(); i != r.end(); i ++) {
+        const double dx = x[i] - avg_x;
+        const double dy = y[i] - avg_y;
+        tot_xx += dx * dx;
+        tot_xy += dx * dy;
+        tot_yy += dy * dy;
+
+      }
+    }
+
+    void join (const PearsonReducer& other) {
+      tot_xx += other.tot_xx;
+      tot_xy += other.tot_xy;
+      tot_yy += other.tot_yy;
+    }
+};
+
+Correlation calculate_two_pass(const Data_Set &data_set) noexcept {
+
+  // Both passes hand every range of rows to the thread that first touched it
+  // in a Column_Buffer, and that read it in the pass before.
+  const tbb::blocked_range<size_t> rows(0, data_set.n, Column_Buffer::page_rows);
+  const tbb::static_partitioner partitioner;
+
+  AverageReducer avg_reducer(data_set.x, data_set.y);
+  tbb::parallel_reduce(rows, avg_reducer, partitioner);
+
+  const double moy_x = avg_reducer.sum_x / data_set.n;
+  const double moy_y = avg_reducer.sum_y / data_set.n;
+
+  PearsonReducer pearson_reducer(data_set.x, data_set.y, moy_x, moy_y);
+  tbb::parallel_reduce(rows, pearson_reducer, partitioner);
+
+  Correlation res;
+  res.a = pearson_reducer.tot_xy / pearson_reducer.tot_xx;
+  res.b = moy_y - res.a * moy_x;
+  res.r = pearson_reducer.tot_xy / std::sqrt(pearson_reducer.tot_xx * pearson_reducer.tot_yy);
+
+  return res;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  calculate                                 */
+/* -------------------------------------------------------------------------- */
+
+/** Number of measurements summarised at once, small enough to stay in L1. */
+static constexpr size_t moments_block = 256;
+
+class MomentsReducer {
+  public:
+    const double* x;
+    const double* y;
+    double origin_x;
+    double origin_y;
+    Moments moments;
+
+    MomentsReducer (const double* x, const double* y, size_t n) : x(x), y(y), origin_x(n != 0 ? x[0] : 0.0), origin_y(n != 0 ? y[0] : 0.0) {}
+
+    MomentsReducer (const MomentsReducer& other, tbb::split) : x(other.x), y(other.y), origin_x(other.origin_x), origin_y(other.origin_y) {}
+
+    // All the moments are taken from the first measurement, and only moved
+    // back once merged.
+    void operator() (const tbb::blocked_range<size_t>& r) {
+      moments.merge(block_moments(x + r.begin(), y + r.begin(), r.size(), moments_block, origin_x, origin_y));
+    }
+
+    Moments result () const {
+      Moments res = moments;
+      if (res.n != 0.0) {
+        res.shift(origin_x, origin_y);
+      }
+      return res;
+    }
+
+    void join (const MomentsReducer& other) {
+      moments.merge(other.moments);
+    }
+};
+
+Moments calculate_moments(const double *x, const double *y, size_t n) noexcept {
+
+  // Every range of rows goes to the thread that first touched it in a
+  // Column_Buffer of n rows.
+  MomentsReducer moments_reducer(x, y, n);
+  tbb::parallel_reduce(tbb::blocked_range<size_t>(0, n, Column_Buffer::page_rows),
+                       moments_reducer, tbb::static_partitioner());
+
+  return moments_reducer.result();
+}
+
+Correlation calculate(const Data_Set &data_set) noexcept {
+  return calculate_moments(data_set.x, data_set.y, data_set.n).correlation();
+}
+
+/* -------------------------------------------------------------------------- */
+/*                           calculate_deterministic                          */
+/* -------------------------------------------------------------------------- */
+
+/** Largest number of measurements of a leaf of the deterministic tree. */
+static constexpr size_t deterministic_grain = 64 * moments_block;
+
+Moments calculate_moments_deterministic(const double *x, const double *y,
+                                        size_t n) noexcept {
+
+  // The range is halved down to the grain whatever the number of threads, and
+  // every half gets its own reducer, so the tree of merges is always the same.
+  MomentsReducer moments_reducer(x, y, n);
+  tbb::parallel_deterministic_reduce(
+      tbb::blocked_range<size_t>(0, n, deterministic_grain), moments_reducer,
+      tbb::simple_partitioner());
+
+  return moments_reducer.result();
+}
+
+Correlation calculate_deterministic(const Data_Set &data_set) noexcept {
+  return calculate_moments_deterministic(data_set.x, data_set.y, data_set.n)
+      .correlation();
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               calculate_simd                               */
+/* -------------------------------------------------------------------------- */
+
+class SimdAverageReducer {
+  public:
+    const double* x;
+    const double* y;
+    simd::Isa isa;
+    Column_Sums sums;
+
+    SimdAverageReducer (const double* x, const double* y, simd::Isa isa) : x(x), y(y), isa(isa) {}
+
+    SimdAverageReducer (const SimdAverageReducer& other, tbb::split) : x(other.x), y(other.y), isa(other.isa) {}
+
+    void operator() (const tbb::blocked_range<size_t>& r) {
+      sums.add(simd::sums(x + r.begin(), y + r.begin(), r.size(), isa));
+    }
+
+    void join (const SimdAverageReducer& other) {
+      sums.add(other.sums);
+    }
+};
+
+class SimdPearsonReducer {
+  public:
+    const double* x;
+    const double* y;
+    double avg_x, avg_y;
+    simd::Isa isa;
+    Centered_Sums sums;
+
+    SimdPearsonReducer (const double* x, const double* y, double avg_x, double avg_y, simd::Isa isa) : x(x), y(y), avg_x(avg_x), avg_y(avg_y), isa(isa) {}
+
+    SimdPearsonReducer (const SimdPearsonReducer& other, tbb::split) : x(other.x), y(other.y), avg_x(other.avg_x), avg_y(other.avg_y), isa(other.isa) {}
+
+    void operator() (const tbb::blocked_range<size_t>& r) {
+      sums.add(simd::centered_sums(x + r.begin(), y + r.begin(), r.size(), avg_x, avg_y, isa));
+    }
+
+    void join (const SimdPearsonReducer& other) {
+      sums.add(other.sums);
+    }
+};
+
+Correlation calculate_simd(const Data_Set &data_set) noexcept {
+
+  const simd::Isa isa = simd::detected_isa();
+
+  // As in calculate_two_pass, the same rows for the same thread in both passes.
+  const tbb::blocked_range<size_t> rows(0, data_set.n, Column_Buffer::page_rows);
+  const tbb::static_partitioner partitioner;
+
+  SimdAverageReducer avg_reducer(data_set.x, data_set.y, isa);
+  tbb::parallel_reduce(rows, avg_reducer, partitioner);
+
+  const double moy_x = avg_reducer.sums.x.value() / data_set.n;
+  const double moy_y = avg_reducer.sums.y.value() / data_set.n;
+
+  SimdPearsonReducer pearson_reducer(data_set.x, data_set.y, moy_x, moy_y, isa);
+  tbb::parallel_reduce(rows, pearson_reducer, partitioner);
+
+  const double tot_xx = pearson_reducer.sums.xx.value();
+  const double tot_xy = pearson_reducer.sums.xy.value();
+  const double tot_yy = pearson_reducer.sums.yy.value();
+
+  Correlation res;
+  res.a = tot_xy / tot_xx;
+  res.b = moy_y - res.a * moy_x;
+  res.r = tot_xy / std::sqrt(tot_xx * tot_yy);
+
+  return res;
+}
+
+// Correlation calculate (const Data_Set &data_set) noexcept {
+//   double tot_x = 0.0, tot_y = 0.0;
+//   for (size_t i = 0; i != data_set.n; i ++) {
+//     tot_x += data_set.x[i];
+//     tot_y += data_set.y[i];
+//   }
+//   const double moy_x = tot_x / data_set.n, moy_y = tot_y / data_set.n;
+  
+//   double tot_xx = 0.0, tot_xy = 0.0, tot_yy = 0.0;
+//   for (size_t i = 0; i != data_set.n; i ++) {
+//     tot_xy += (data_set.x[i] - moy_x) * (data_set.y[i] - moy_y);
+//     tot_xx += (data_set.x[i] - moy_x) * (data_set.x[i] - moy_x);
+//     tot_yy += (data_set.y[i] - moy_y) * (data_set.y[i] - moy_x);
+//   }
+
+//   Correlation res;
+//   res.a = tot_xy / tot_xx;
+//   res.b = moy_y - res.a * moy_x;
+//   res.r = tot_xy / std::sqrt(tot_xx * tot_yy);
+
+//   return res;
+// }
\ No newline at end of file
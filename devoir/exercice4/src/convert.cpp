@@ -0,0 +1,41 @@
+#include "cpp_argv.hpp"
+#include "binary_format.hpp"
+#include "data_set.hpp"
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+
+#define DEFAULT_NAME "exercice4_convert"
+
+/**
+ * @brief Converts a text data set into the binary columnar format, then checks
+ * the result by loading it back.
+ *
+ * @param argc number of arguments in the command line.
+ * @param argv arguments of the command line.
+ * @return @c EXIT_SUCCESS if command succeeds else @c EXIT_FAILURE.
+ */
+int main(int argc, char *argv[]) {
+
+  // User expects help.
+  CPP_ARGV_TEST_HELP_REQUEST(argc, argv[0], DEFAULT_NAME,
+                             "text_filename binary_filename")
+
+  // Bad argument number.
+  CPP_ARGV_TEST_ARG_NUM(argc, 3)
+
+  try {
+    const Data_Set data_set = load_file(argv[1]);
+    save_binary(argv[2], data_set);
+
+    const Data_Set check = load_file(argv[2], true);
+    std::clog << check.n << " measurements written to " << argv[2]
+              << std::endl;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // It's over.
+  return EXIT_SUCCESS;
+}
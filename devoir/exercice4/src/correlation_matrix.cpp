@@ -0,0 +1,128 @@
+#include "correlation_matrix.hpp"
+#include "moments.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+/* -------------------------------------------------------------------------- */
+/*                                   helpers                                  */
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+/** Size of the square tiles of the matrix updated by a single task. */
+constexpr size_t tile = 64;
+
+/** Number of rows packed into the panel at once. */
+constexpr size_t row_block = 512;
+
+/** Size of the register block of the kernel: rows then columns. */
+constexpr size_t kernel_rows = 4;
+constexpr size_t kernel_columns = 8;
+
+static_assert(tile % kernel_rows == 0 && tile % kernel_columns == 0,
+              "tiles must be made of whole register blocks");
+
+/**
+ * @brief Adds the products of two slices of a panel to a tile of the sums:
+ * sums[i][j] += sum over r of panel[r][i] * panel[r][j].
+ *
+ * @param panel The panel, row-major, width columns per row.
+ * @param rows The number of rows of the panel.
+ * @param width The number of columns of the panel and of the sums.
+ * @param first_i The first column of the first slice.
+ * @param first_j The first column of the second slice.
+ * @param sums The sums, row-major.
+ */
+void update_tile(const double *panel, size_t rows, size_t width,
+                 size_t first_i, size_t first_j, double *sums) noexcept {
+  for (size_t i0 = first_i; i0 != first_i + tile; i0 += kernel_rows) {
+    for (size_t j0 = first_j; j0 != first_j + tile; j0 += kernel_columns) {
+      // Independent accumulators, kept in registers over the whole panel.
+      double acc[kernel_rows][kernel_columns] = {};
+      for (size_t r = 0; r != rows; r++) {
+        const double *const row = panel + r * width;
+        for (size_t ii = 0; ii != kernel_rows; ii++) {
+          const double a = row[i0 + ii];
+          for (size_t jj = 0; jj != kernel_columns; jj++) {
+            acc[ii][jj] += a * row[j0 + jj];
+          }
+        }
+      }
+      for (size_t ii = 0; ii != kernel_rows; ii++) {
+        for (size_t jj = 0; jj != kernel_columns; jj++) {
+          sums[(i0 + ii) * width + j0 + jj] += acc[ii][jj];
+        }
+      }
+    }
+  }
+}
+
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/*                             correlation_matrix                             */
+/* -------------------------------------------------------------------------- */
+
+std::vector<double> correlation_matrix(const Column_Set &column_set) {
+  const size_t n = column_set.n;
+  const size_t m = column_set.m();
+  const size_t width = (m + tile - 1) / tile * tile;
+  const size_t tiles = width / tile;
+
+  // Average and inverse norm of the centered columns.
+  std::vector<double> means(m), scales(m);
+  tbb::parallel_for(size_t(0), m, [&](size_t j) {
+    const double *const column = column_set.columns[j];
+    const Moments moments = calculate_moments(column, column, n);
+    means[j] = moments.mean_x;
+    scales[j] = 1.0 / std::sqrt(moments.m_xx);
+  });
+
+  // Tiles of the upper triangle, each one updated by a single task.
+  std::vector<std::pair<size_t, size_t>> pairs;
+  for (size_t i = 0; i != tiles; i++) {
+    for (size_t j = i; j != tiles; j++) {
+      pairs.emplace_back(i * tile, j * tile);
+    }
+  }
+
+  // Padding columns stay at zero.
+  std::vector<double> panel(row_block * width, 0.0);
+  std::vector<double> sums(width * width, 0.0);
+
+  for (size_t first = 0; first < n; first += row_block) {
+    const size_t rows = std::min(row_block, n - first);
+
+    // Packs the block, centered and normalized, column group by column group.
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, m, kernel_columns),
+        [&](const tbb::blocked_range<size_t> &r) {
+          for (size_t r0 = 0; r0 != rows; r0++) {
+            double *const row = panel.data() + r0 * width;
+            for (size_t j = r.begin(); j != r.end(); j++) {
+              row[j] = (column_set.columns[j][first + r0] - means[j]) * scales[j];
+            }
+          }
+        });
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, pairs.size(), 1),
+                      [&](const tbb::blocked_range<size_t> &r) {
+                        for (size_t p = r.begin(); p != r.end(); p++) {
+                          update_tile(panel.data(), rows, width, pairs[p].first,
+                                      pairs[p].second, sums.data());
+                        }
+                      });
+  }
+
+  // Mirrors the upper triangle.
+  std::vector<double> res(m * m);
+  tbb::parallel_for(size_t(0), m, [&](size_t i) {
+    for (size_t j = 0; j != m; j++) {
+      res[i * m + j] = i <= j ? sums[i * width + j] : sums[j * width + i];
+    }
+  });
+  return res;
+}
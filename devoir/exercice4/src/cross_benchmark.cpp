@@ -0,0 +1,148 @@
+#include "cpp_argv.hpp"
+#include "correlation.hpp"
+#include "cross_correlation.hpp"
+#include "data_set.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
+#include <tbb/global_control.h>
+
+#define DEFAULT_NAME "exercice4_cross"
+
+/** Lag of y behind x in the synthetic data set. */
+#define DELAY 37
+
+/**
+ * @brief Builds a synthetic data set: x is an autoregressive process, y the
+ * same DELAY measurements later, with noise.
+ *
+ * @param n The number of measurements.
+ * @return Data_Set The data set.
+ */
+static Data_Set make_lagged_data_set(size_t n) {
+  const std::shared_ptr<double[]> columns(new double[2 * n]);
+  double *const x = columns.get();
+  double *const y = x + n;
+
+  const auto noise = [](uint64_t i) {
+    uint64_t z = i * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 31)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return (z >> 11) * 0x1.0p-53 - 0.5;
+  };
+  double state = 0.0;
+  for (size_t i = 0; i != n; i++) {
+    state = 0.9 * state + noise(2 * i);
+    x[i] = 100.0 + state;
+  }
+  for (size_t i = 0; i != n; i++) {
+    y[i] = (i >= DELAY ? 3.0 * x[i - DELAY] : 300.0) + noise(2 * i + 1);
+  }
+
+  Data_Set res;
+  res.n = n;
+  res.x = x;
+  res.y = y;
+  res.storage = columns;
+  return res;
+}
+
+/**
+ * @brief Calculates the coefficient of every lag by running calculate on the
+ * shifted columns, in O(n * max_lag).
+ *
+ */
+static Cross_Correlation cross_correlation_direct(const Data_Set &data_set,
+                                                  size_t max_lag) {
+  Cross_Correlation res;
+  const long lags = static_cast<long>(max_lag);
+  res.r.resize(2 * max_lag + 1);
+  res.peak = -lags;
+  for (long k = -lags; k <= lags; k++) {
+    const size_t shift = static_cast<size_t>(std::labs(k));
+    Data_Set shifted = data_set;
+    shifted.n = data_set.n - shift;
+    shifted.x = data_set.x + (k >= 0 ? 0 : shift);
+    shifted.y = data_set.y + (k >= 0 ? shift : 0);
+    res.r[k + lags] = calculate(shifted).r;
+    if (std::fabs(res.r[k + lags]) > std::fabs(res.r[res.peak + lags])) {
+      res.peak = k;
+    }
+  }
+  return res;
+}
+
+/**
+ * @brief Returns the duration of a call, in seconds.
+ *
+ */
+template <typename Function> static double time_it(const Function &f) {
+  const auto start = std::chrono::steady_clock::now();
+  f();
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(stop - start).count();
+}
+
+/**
+ * @brief Times the cross-correlation of a data set by FFT and directly, for
+ * ten times more lags each time, and compares their coefficients.
+ *
+ * @param argc number of arguments in the command line.
+ * @param argv arguments of the command line.
+ * @return @c EXIT_SUCCESS if command succeeds else @c EXIT_FAILURE.
+ */
+int main(int argc, char *argv[]) {
+
+  // User expects help.
+  CPP_ARGV_TEST_HELP_REQUEST(argc, argv[0], DEFAULT_NAME, "size max_lag")
+
+  // Bad argument number.
+  CPP_ARGV_TEST_ARG_NUM(argc, 3)
+
+  // Retrieves the size and the largest lag.
+  size_t size, max_lag;
+  {
+    std::istringstream size_arg(argv[1]);
+    std::istringstream lag_arg(argv[2]);
+    size_arg >> size;
+    lag_arg >> max_lag;
+    if (not size_arg or not lag_arg or size < DELAY + 3 or
+        max_lag + 2 > size) {
+      std::cerr << "Bad argument" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  const Data_Set data_set = make_lagged_data_set(size);
+  std::cout << "Thread(s):\t"
+            << tbb::global_control::active_value(
+                   tbb::global_control::max_allowed_parallelism)
+            << std::endl;
+  std::cout << "lags\tdirect (s)\tfft (s)\tspeedup\tmax |difference|\tpeak"
+            << std::endl;
+
+  for (size_t lags = 1; lags <= max_lag; lags *= 10) {
+    Cross_Correlation direct, fast;
+    const double direct_time =
+        time_it([&] { direct = cross_correlation_direct(data_set, lags); });
+    const double fast_time =
+        time_it([&] { fast = cross_correlation(data_set, lags); });
+    double difference = 0.0;
+    for (size_t k = 0; k != direct.r.size(); k++) {
+      difference = std::max(difference, std::fabs(direct.r[k] - fast.r[k]));
+    }
+    std::cout << lags << '\t' << direct_time << '\t' << fast_time << '\t'
+              << direct_time / fast_time << '\t' << difference << '\t'
+              << fast.peak << (fast.peak == direct.peak ? "" : " (differs)")
+              << std::endl;
+  }
+
+  // It's over.
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+#include "cross_correlation.hpp"
+#include "fft.hpp"
+#include "moments.hpp"
+#include "prefix_index.hpp"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+/* -------------------------------------------------------------------------- */
+/*                              cross_correlation                             */
+/* -------------------------------------------------------------------------- */
+
+Cross_Correlation cross_correlation(const Data_Set &data_set, size_t max_lag) {
+  const size_t n = data_set.n;
+  if (n < 2 || max_lag > n - 2) {
+    throw std::invalid_argument("the largest lag must leave at least 2 pairs");
+  }
+
+  const Prefix_Index index(data_set);
+  const Moments whole = index.moments(0, n);
+
+  // Padding past n + max_lag keeps the lags of the range from wrapping.
+  size_t size = 1;
+  while (size < n + max_lag) {
+    size *= 2;
+  }
+
+  std::vector<std::complex<double>> values(size);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, n),
+                    [&](const tbb::blocked_range<size_t> &r) {
+                      for (size_t i = r.begin(); i != r.end(); i++) {
+                        values[i] = {data_set.x[i] - whole.mean_x,
+                                     data_set.y[i] - whole.mean_y};
+                      }
+                    });
+  fft_bit_reversed(values.data(), size);
+
+  // With Z the transform of x + iy, those of x and y are
+  // X[k] = (Z[k] + conj(Z[-k])) / 2 and Y[k] = (Z[k] - conj(Z[-k])) / 2i, and
+  // the cross-correlation is the inverse transform of conj(X) Y, whose
+  // values at k and -k are conjugate. In bit-reversed order, k and -k lie at
+  // p and 3 * 2^j - 1 - p in the same [2^j, 2^(j+1)), or both at 0, or at 1.
+  const auto product = [](const std::complex<double> &z,
+                          const std::complex<double> &z_conj) {
+    const std::complex<double> x = (z + z_conj) * 0.5;
+    const std::complex<double> y =
+        (z - z_conj) * std::complex<double>(0.0, -0.5);
+    return std::complex<double>(x.real() * y.real() + x.imag() * y.imag(),
+                                x.real() * y.imag() - x.imag() * y.real());
+  };
+  for (size_t p = 0; p != std::min<size_t>(size, 2); p++) {
+    values[p] = product(values[p], std::conj(values[p]));
+  }
+  tbb::parallel_for(
+      tbb::blocked_range<size_t>(2, size),
+      [&](const tbb::blocked_range<size_t> &r) {
+        for (size_t p = r.begin(); p != r.end(); p++) {
+          const size_t octave = size_t(1) << (63 - __builtin_clzll(p));
+          const size_t q = 3 * octave - 1 - p;
+          if (p < q) {
+            const std::complex<double> pq =
+                product(values[p], std::conj(values[q]));
+            values[p] = pq;
+            values[q] = std::conj(pq);
+          }
+        }
+      });
+  inverse_fft_bit_reversed(values.data(), size);
+
+  Cross_Correlation res;
+  const long lags = static_cast<long>(max_lag);
+  res.r.resize(2 * max_lag + 1);
+  tbb::parallel_for(
+      tbb::blocked_range<long>(-lags, lags + 1),
+      [&](const tbb::blocked_range<long> &range) {
+        for (long k = range.begin(); k != range.end(); k++) {
+          const size_t shift = static_cast<size_t>(std::labs(k));
+          const size_t m = n - shift;
+          // The x and y parts of the overlap.
+          const Moments x = k >= 0 ? index.moments(0, m) : index.moments(shift, n);
+          const Moments y = k >= 0 ? index.moments(shift, n) : index.moments(0, m);
+          const double cross =
+              values[k >= 0 ? shift : size - shift].real() / size -
+              m * (x.mean_x - whole.mean_x) * (y.mean_y - whole.mean_y);
+          res.r[k + lags] = cross / std::sqrt(x.m_xx * y.m_yy);
+        }
+      });
+
+  res.peak = -lags;
+  for (long k = -lags; k <= lags; k++) {
+    if (std::fabs(res.r[k + lags]) > std::fabs(res.r[res.peak + lags])) {
+      res.peak = k;
+    }
+  }
+  return res;
+}
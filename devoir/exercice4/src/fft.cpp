@@ -0,0 +1,193 @@
+#include "fft.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+/* -------------------------------------------------------------------------- */
+/*                                   helpers                                  */
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+using Complex = std::complex<double>;
+
+/** Size of the blocks whose inner stages run together, 32 KiB of values. */
+constexpr size_t local_size = 2048;
+
+/**
+ * @brief Multiplies two complex numbers, without the checks for infinities of
+ * the standard operator.
+ *
+ */
+inline Complex multiply(const Complex &a, const Complex &b) noexcept {
+  return {a.real() * b.real() - a.imag() * b.imag(),
+          a.real() * b.imag() + a.imag() * b.real()};
+}
+
+/**
+ * @brief Twiddle factors exp(-+2 pi i j / (2 half)), j in [0, half), of the
+ * stages of a transform, each stage's factors following at index half.
+ *
+ * Each factor is the product of one of the high bits of its exponent over the
+ * transform and one of its low bits, which keeps it as accurate as a direct
+ * cosine and sine at the cost of two small tables of those.
+ */
+class Twiddles {
+public:
+  Twiddles(size_t size, bool inverse) : factors(std::max<size_t>(size, 2)) {
+    unsigned low_bits = 0;
+    while ((size_t(1) << (2 * low_bits)) < size) {
+      low_bits++;
+    }
+    const size_t low_size = size_t(1) << low_bits;
+    const double sign = inverse ? 1.0 : -1.0;
+    std::vector<Complex> low(low_size), high(std::max<size_t>(1, size / low_size));
+    for (size_t k = 0; k != low.size(); k++) {
+      const double angle = sign * 2.0 * M_PI * k / size;
+      low[k] = {std::cos(angle), std::sin(angle)};
+    }
+    for (size_t k = 0; k != high.size(); k++) {
+      const double angle = sign * 2.0 * M_PI * (k * low_size) / size;
+      high[k] = {std::cos(angle), std::sin(angle)};
+    }
+    // The last stage's factors, the others being every other one of those of
+    // the next stage.
+    const size_t last = size / 2;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, last),
+                      [&](const tbb::blocked_range<size_t> &r) {
+                        for (size_t k = r.begin(); k != r.end(); k++) {
+                          factors[last + k] =
+                              multiply(high[k >> low_bits], low[k & (low_size - 1)]);
+                        }
+                      });
+    for (size_t half = last / 2; half >= 1; half /= 2) {
+      for (size_t j = 0; j != half; j++) {
+        factors[half + j] = factors[2 * half + 2 * j];
+      }
+    }
+  }
+
+  /** Returns the factors of the stage of half-length half. */
+  const Complex *operator()(size_t half) const noexcept {
+    return factors.data() + half;
+  }
+
+private:
+  std::vector<Complex> factors; /** Factors of the stages. */
+};
+
+/**
+ * @brief Runs count butterflies of a stage of decimation in frequency, or in
+ * time, those of a[i] and a[i + half] with the factor w[i].
+ *
+ */
+template <bool Frequency>
+inline void butterflies(Complex *a, size_t half, const Complex *w,
+                        size_t count) noexcept {
+  Complex *const b = a + half;
+  for (size_t i = 0; i != count; i++) {
+    if (Frequency) {
+      const Complex u = a[i];
+      const Complex v = b[i];
+      a[i] = u + v;
+      b[i] = multiply(u - v, w[i]);
+    } else {
+      const Complex u = a[i];
+      const Complex v = multiply(b[i], w[i]);
+      a[i] = u + v;
+      b[i] = u - v;
+    }
+  }
+}
+
+/**
+ * @brief Runs the stages of a transform, in parallel.
+ *
+ * @param inverse Whether it is the inverse transform, in time.
+ */
+void transform(Complex *values, size_t size, bool inverse) {
+  if (size < 2) {
+    return;
+  }
+  const Twiddles twiddles(size, inverse);
+  const size_t local = std::min(size, local_size);
+  const auto run = [inverse](Complex *a, size_t half, const Complex *w,
+                             size_t count) {
+    if (inverse) {
+      butterflies<false>(a, half, w, count);
+    } else {
+      butterflies<true>(a, half, w, count);
+    }
+  };
+
+  // The stages that span more than a block, split into slices of a block's
+  // size of the butterflies of a group.
+  const auto wide_stage = [&](size_t half) {
+    const size_t slices = half / local;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, size / (2 * half) * slices),
+                      [&](const tbb::blocked_range<size_t> &r) {
+                        for (size_t t = r.begin(); t != r.end(); t++) {
+                          const size_t j = t % slices * local;
+                          run(values + 2 * half * (t / slices) + j, half,
+                              twiddles(half) + j, local);
+                        }
+                      });
+  };
+
+  // The stages within a block.
+  const auto local_stages = [&] {
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, size / local),
+        [&](const tbb::blocked_range<size_t> &r) {
+          for (size_t b = r.begin(); b != r.end(); b++) {
+            Complex *const block = values + b * local;
+            const auto stage = [&](size_t half) {
+              for (size_t g = 0; g != local / (2 * half); g++) {
+                run(block + 2 * half * g, half, twiddles(half), half);
+              }
+            };
+            if (inverse) {
+              for (size_t half = 1; half < local; half *= 2) {
+                stage(half);
+              }
+            } else {
+              for (size_t half = local / 2; half >= 1; half /= 2) {
+                stage(half);
+              }
+            }
+          }
+        });
+  };
+
+  if (inverse) {
+    local_stages();
+    for (size_t half = local; half < size; half *= 2) {
+      wide_stage(half);
+    }
+  } else {
+    for (size_t half = size / 2; half >= local; half /= 2) {
+      wide_stage(half);
+    }
+    local_stages();
+  }
+}
+
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/*                              fft_bit_reversed                              */
+/* -------------------------------------------------------------------------- */
+
+void fft_bit_reversed(Complex *values, size_t size) {
+  transform(values, size, false);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                          inverse_fft_bit_reversed                          */
+/* -------------------------------------------------------------------------- */
+
+void inverse_fft_bit_reversed(Complex *values, size_t size) {
+  transform(values, size, true);
+}
@@ -0,0 +1,143 @@
+#include "cpp_argv.hpp"
+#include "correlation.hpp"
+#include "data_set.hpp"
+#include "synthetic_data.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <tbb/global_control.h>
+#include <tbb/task_arena.h>
+
+#define DEFAULT_NAME "exercice4_fused"
+
+/**
+ * @brief Runs a calculation several times and returns its duration per run.
+ *
+ */
+template <typename Calculation>
+static double time_it(Calculation calculation, const Data_Set &data_set,
+                      size_t iters, Correlation &result) {
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i != iters; i++) {
+    result = calculation(data_set);
+  }
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(stop - start).count() / iters;
+}
+
+/**
+ * @brief Tells whether a calculation gives bit-identical results with 1, 2, 3,
+ * 4, ... and 16 threads.
+ *
+ */
+template <typename Calculation>
+static bool reproducible(Calculation calculation, const Data_Set &data_set) {
+  // Lets the arenas have more threads than cores.
+  const tbb::global_control control(
+      tbb::global_control::max_allowed_parallelism, 16);
+
+  Correlation reference;
+  tbb::task_arena(1).execute([&] { reference = calculation(data_set); });
+  for (int threads = 2; threads <= 16; threads++) {
+    Correlation result;
+    tbb::task_arena(threads).execute([&] { result = calculation(data_set); });
+    if (std::memcmp(&result, &reference, sizeof result) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** Largest relative difference with the two-pass calculation accepted. */
+static constexpr double tolerance = 1e-11;
+
+/**
+ * @brief Tells whether a calculation agrees with the two-pass one on a, b and
+ * r. As b = mean_y - a * mean_x loses the digits of a * mean_x whatever the
+ * calculation, it is compared at that scale.
+ *
+ * @param origin A measurement of X near mean_x.
+ */
+static bool agrees(const Correlation &result, const Correlation &two_pass,
+                   double origin) {
+  const double b_scale = std::fabs(two_pass.b) + std::fabs(two_pass.a * origin);
+  return std::fabs(result.a - two_pass.a) <= tolerance * std::fabs(two_pass.a) &&
+         std::fabs(result.b - two_pass.b) <= tolerance * b_scale &&
+         std::fabs(result.r - two_pass.r) <= tolerance * std::fabs(two_pass.r);
+}
+
+/**
+ * @brief Compares the two-pass, the single-pass and the deterministic
+ * single-pass calculations of the Pearson correlation: duration, memory
+ * traffic, numerical agreement and reproducibility across thread counts.
+ *
+ * @param argc number of arguments in the command line.
+ * @param argv arguments of the command line.
+ * @return @c EXIT_SUCCESS if command succeeds and both single-pass
+ * calculations agree with the two-pass one, else @c EXIT_FAILURE.
+ */
+int main(int argc, char *argv[]) {
+
+  // User expects help.
+  CPP_ARGV_TEST_HELP_REQUEST(argc, argv[0], DEFAULT_NAME, "size iterations")
+
+  // Bad argument number.
+  CPP_ARGV_TEST_ARG_NUM(argc, 3)
+
+  // Retrieves the data set size and the number of iterations.
+  size_t n, iters;
+  {
+    std::istringstream size_arg(argv[1]), iters_arg(argv[2]);
+    size_arg >> n;
+    iters_arg >> iters;
+    if (not size_arg or not iters_arg or n == 0 or iters == 0) {
+      std::cerr << "Bad argument" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  const Data_Set data_set = make_synthetic_data_set(n);
+  const double gigabytes = 2.0 * n * sizeof(double) / 1e9;
+  const int threads = tbb::global_control::active_value(
+      tbb::global_control::max_allowed_parallelism);
+
+  Correlation two_pass, fused, deterministic;
+  const double two_pass_time =
+      time_it(calculate_two_pass, data_set, iters, two_pass);
+  const double fused_time = time_it(calculate, data_set, iters, fused);
+  const double deterministic_time =
+      time_it(calculate_deterministic, data_set, iters, deterministic);
+
+  // Each pass streams both columns once.
+  std::cout << "Thread(s):\t" << threads << std::endl;
+  std::cout << "Data set:\t" << gigabytes << " GB" << std::endl;
+  std::cout << "two-pass:\t" << two_pass_time << " s\t"
+            << 2.0 * gigabytes / two_pass_time << " GB/s read" << std::endl;
+  std::cout << "fused:\t\t" << fused_time << " s\t"
+            << gigabytes / fused_time << " GB/s read" << std::endl;
+  std::cout << "deterministic:\t" << deterministic_time << " s\t"
+            << gigabytes / deterministic_time << " GB/s read" << std::endl;
+  std::cout << "Speedup:\t" << two_pass_time / fused_time << std::endl;
+  std::cout << "Overhead:\t" << deterministic_time / fused_time - 1.0
+            << std::endl;
+  std::cout << "|delta a|:\t" << std::fabs(fused.a - two_pass.a) << std::endl;
+  std::cout << "|delta b|:\t" << std::fabs(fused.b - two_pass.b) << std::endl;
+  std::cout << "|delta r|:\t" << std::fabs(fused.r - two_pass.r) << std::endl;
+  std::cout << "Reproducible:\tfused "
+            << (reproducible(calculate, data_set) ? "yes" : "no")
+            << ", deterministic "
+            << (reproducible(calculate_deterministic, data_set) ? "yes" : "no")
+            << std::endl;
+  const bool fused_agrees = agrees(fused, two_pass, data_set.x[0]);
+  const bool deterministic_agrees =
+      agrees(deterministic, two_pass, data_set.x[0]);
+  std::cout << "Agreement:\tfused " << (fused_agrees ? "yes" : "no")
+            << ", deterministic " << (deterministic_agrees ? "yes" : "no")
+            << std::endl;
+
+  // It's over.
+  return fused_agrees && deterministic_agrees ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,255 @@
+#include "grouped_correlation.hpp"
+#include "moments.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/parallel_sort.h>
+
+/* -------------------------------------------------------------------------- */
+/*                                   helpers                                  */
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+/** Number of groups a table holds at most, its slots then taking 14 MiB. */
+constexpr size_t max_table_groups = 1 << 17;
+
+/** Number of slots of a new table. */
+constexpr size_t initial_slots = 1 << 10;
+
+/** Number of bits of a hash picking a register of the sketch. */
+constexpr unsigned sketch_bits = 12;
+
+constexpr size_t sketch_size = size_t(1) << sketch_bits;
+
+/**
+ * @brief Returns the bits of a key, 0 and -0 being the same key.
+ *
+ */
+inline uint64_t key_bits(double key) noexcept {
+  key = key == 0.0 ? 0.0 : key;
+  uint64_t bits;
+  std::memcpy(&bits, &key, sizeof(bits));
+  return bits;
+}
+
+/**
+ * @brief Mixes the bits of a key (the finalizer of MurmurHash3).
+ *
+ */
+inline uint64_t hash_bits(uint64_t bits) noexcept {
+  bits ^= bits >> 33;
+  bits *= 0xff51afd7ed558ccdULL;
+  bits ^= bits >> 33;
+  bits *= 0xc4ceb9fe1a85ec53ULL;
+  return bits ^ (bits >> 33);
+}
+
+/**
+ * @brief Open-addressing hash table from the keys to the moments of their
+ * groups, probed linearly and grown past three quarters full.
+ *
+ * A slot is free while its count of measurements is 0.
+ */
+class Group_Table {
+public:
+  Group_Table() : slots(initial_slots), count(0) {}
+
+  /**
+   * @brief Returns the moments of a key, inserted empty if missing.
+   *
+   * @param bits The bits of the key.
+   * @param hash Their hash.
+   */
+  Moments &operator()(uint64_t bits, uint64_t hash) {
+    if (4 * (count + 1) > 3 * slots.size()) {
+      grow();
+    }
+    const size_t mask = slots.size() - 1;
+    size_t i = hash & mask;
+    while (slots[i].moments.n != 0.0 && slots[i].bits != bits) {
+      i = (i + 1) & mask;
+    }
+    if (slots[i].moments.n == 0.0) {
+      slots[i].bits = bits;
+      count++;
+    }
+    return slots[i].moments;
+  }
+
+  /**
+   * @brief Merges the groups of another table.
+   *
+   */
+  void merge(const Group_Table &other) {
+    for (const Slot &slot : other.slots) {
+      if (slot.moments.n != 0.0) {
+        (*this)(slot.bits, hash_bits(slot.bits)).merge(slot.moments);
+      }
+    }
+  }
+
+  /**
+   * @brief Calls f with the key and the moments of every group.
+   *
+   */
+  template <typename Function> void for_each(const Function &f) const {
+    for (const Slot &slot : slots) {
+      if (slot.moments.n != 0.0) {
+        double key;
+        std::memcpy(&key, &slot.bits, sizeof(key));
+        f(key, slot.moments);
+      }
+    }
+  }
+
+  /** Number of groups. */
+  size_t size() const noexcept { return count; }
+
+private:
+  struct Slot {
+    uint64_t bits;   /** Bits of the key. */
+    Moments moments; /** Moments of its group. */
+  };
+
+  std::vector<Slot> slots; /** Slots, a power of 2 of them. */
+  size_t count;            /** Number of groups.             */
+
+  /**
+   * @brief Doubles the number of slots.
+   *
+   */
+  void grow() {
+    std::vector<Slot> old(2 * slots.size());
+    std::swap(old, slots);
+    count = 0;
+    for (const Slot &slot : old) {
+      if (slot.moments.n != 0.0) {
+        (*this)(slot.bits, hash_bits(slot.bits)) = slot.moments;
+      }
+    }
+  }
+};
+
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/*                             grouped_correlation                            */
+/* -------------------------------------------------------------------------- */
+
+class GroupCountReducer {
+  public:
+    const double* keys;
+    std::array<uint8_t, sketch_size> registers{};
+
+    GroupCountReducer (const double* keys) : keys(keys) {}
+
+    GroupCountReducer (const GroupCountReducer& other, tbb::split) : keys(other.keys) {}
+
+    void operator() (const tbb::blocked_range<size_t>& r) {
+      for (size_t i = r.begin(); i < r.end(); i++) {
+        const uint64_t hash = hash_bits(key_bits(keys[i]));
+        // The rank of the first 1 of the other bits, at most 53.
+        const uint64_t rest = hash << sketch_bits | uint64_t(1) << (sketch_bits - 1);
+        const uint8_t rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+        uint8_t& reg = registers[hash >> (64 - sketch_bits)];
+        reg = std::max(reg, rank);
+      }
+    }
+
+    void join (const GroupCountReducer& other) {
+      for (size_t j = 0; j != sketch_size; j++) {
+        registers[j] = std::max(registers[j], other.registers[j]);
+      }
+    }
+
+    /** HyperLogLog estimate of the number of keys, by linear counting when
+     * it is small. */
+    double estimate () const {
+      const double m = static_cast<double>(sketch_size);
+      double sum = 0.0, zeros = 0.0;
+      for (const uint8_t reg : registers) {
+        sum += std::ldexp(1.0, -reg);
+        zeros += reg == 0;
+      }
+      const double raw = 0.7213 / (1.0 + 1.079 / m) * m * m / sum;
+      return raw <= 2.5 * m && zeros != 0.0 ? m * std::log(m / zeros) : raw;
+    }
+};
+
+class GroupReducer {
+  public:
+    const double* keys;
+    const double* x;
+    const double* y;
+    size_t pass;
+    size_t passes;
+    Group_Table table;
+
+    GroupReducer (const double* keys, const double* x, const double* y, size_t pass, size_t passes) : keys(keys), x(x), y(y), pass(pass), passes(passes) {}
+
+    GroupReducer (const GroupReducer& other, tbb::split) : keys(other.keys), x(other.x), y(other.y), pass(other.pass), passes(other.passes) {}
+
+    void operator() (const tbb::blocked_range<size_t>& r) {
+      for (size_t i = r.begin(); i < r.end(); i++) {
+        const uint64_t bits = key_bits(keys[i]);
+        const uint64_t hash = hash_bits(bits);
+        // The high bits pick the pass, the low ones the slot.
+        if (static_cast<size_t>(static_cast<unsigned __int128>(hash) * passes >> 64) == pass) {
+          table(bits, hash).push(x[i], y[i]);
+        }
+      }
+    }
+
+    void join (GroupReducer& other) {
+      if (other.table.size() > table.size()) {
+        std::swap(table, other.table);
+      }
+      table.merge(other.table);
+    }
+};
+
+std::vector<Group> grouped_correlation(const Column_Set &column_set) {
+  if (column_set.m() != 3) {
+    throw std::runtime_error("expected 3 columns (key, x, y), found " +
+                             std::to_string(column_set.m()));
+  }
+  const size_t n = column_set.n;
+  const double *const keys = column_set.columns[0];
+
+  // There are no more groups than measurements; otherwise they are counted
+  // first, with a margin for the error of the sketch, 1.6 % on average.
+  size_t passes = 1;
+  if (n > max_table_groups) {
+    GroupCountReducer count_reducer(keys);
+    tbb::parallel_reduce(tbb::blocked_range<size_t>(0, n), count_reducer);
+    passes = std::max<size_t>(
+        1, static_cast<size_t>(std::ceil(1.1 * count_reducer.estimate() /
+                                         max_table_groups)));
+  }
+
+  std::vector<Group> res;
+  for (size_t pass = 0; pass != passes; pass++) {
+    GroupReducer group_reducer(keys, column_set.columns[1],
+                               column_set.columns[2], pass, passes);
+    tbb::parallel_reduce(tbb::blocked_range<size_t>(0, n), group_reducer);
+    group_reducer.table.for_each([&](double key, const Moments &moments) {
+      res.push_back({key, moments.n, moments.correlation()});
+    });
+  }
+
+  tbb::parallel_sort(res.begin(), res.end(),
+                     [](const Group &lhs, const Group &rhs) {
+                       return std::isnan(rhs.key) ? not std::isnan(lhs.key)
+                                                  : lhs.key < rhs.key;
+                     });
+  return res;
+}
@@ -0,0 +1,51 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Totals of a batch run.
+ *
+ */
+struct Batch_Summary {
+  size_t files;    /** Number of files processed.   */
+  size_t failures; /** Number of files that failed. */
+  size_t bytes;    /** Bytes read.                  */
+  double seconds;  /** Duration of the run.         */
+};
+
+/**
+ * @brief Lists the files of a batch: the regular files of a directory, by
+ * name, or the lines of a file list.
+ *
+ * @param path The directory or the file list.
+ * @return std::vector<std::string> The file names.
+ * @throw std::system_error If the path cannot be read.
+ */
+std::vector<std::string> list_batch(const char *path);
+
+/**
+ * @brief Calculates the Pearson correlation of many files, printing one line
+ * per file, in the order of the list.
+ *
+ * The files go through a tbb::parallel_pipeline: read (serial, in order, so
+ * that the disk is read sequentially), parse and reduce (both parallel), then
+ * emit (serial, in order). At most live_files files are in flight, which
+ * bounds the memory used. A file that fails is reported on the error stream
+ * and the others go on.
+ *
+ * @param filenames The files.
+ * @param out The stream of the results.
+ * @param err The stream of the errors.
+ * @param live_files The number of files in flight; 0 means twice the number of
+ * threads.
+ * @return Batch_Summary The totals of the run.
+ */
+Batch_Summary correlate_files(const std::vector<std::string> &filenames,
+                              std::ostream &out, std::ostream &err,
+                              size_t live_files = 0);
+
+#endif
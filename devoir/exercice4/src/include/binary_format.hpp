@@ -0,0 +1,103 @@
+#ifndef BINARY_FORMAT_HPP
+#define BINARY_FORMAT_HPP
+
+#include "data_set.hpp"
+#include "mapped_file.hpp"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Header of a binary data set file.
+ *
+ * The header is followed by the x column then the y column, each one
+ * contiguous and starting at a multiple of the alignment, so that a mapping
+ * of the file can be used as a data set without copying anything.
+ */
+struct Binary_Header {
+  char magic[8];      /** Binary_Format::magic.                     */
+  uint32_t version;   /** Binary_Format::version.                   */
+  uint32_t dtype;     /** Type of the measurements (Binary_Dtype).  */
+  uint64_t n;         /** Number of measurements.                   */
+  uint64_t alignment; /** Alignment of the columns, in bytes.       */
+  uint64_t x_offset;  /** Offset of the x column, in bytes.         */
+  uint64_t y_offset;  /** Offset of the y column, in bytes.         */
+  uint64_t checksum;  /** column_checksum of the two columns.       */
+  uint64_t reserved;  /** Zero.                                     */
+};
+
+static_assert(sizeof(Binary_Header) == 64, "unexpected header padding");
+
+/**
+ * @brief Types of measurements.
+ *
+ */
+enum class Binary_Dtype : uint32_t {
+  float64_le = 1, /** IEEE 754 binary64, little-endian. */
+};
+
+/**
+ * @brief Constants of the binary format.
+ *
+ */
+namespace Binary_Format {
+constexpr char magic[8] = {'P', 'E', 'A', 'R', 'S', 'O', 'N', 'B'};
+constexpr uint32_t version = 1;
+constexpr size_t default_alignment = 4096;
+} // namespace Binary_Format
+
+/**
+ * @brief Tells whether a memory block starts with a binary header.
+ *
+ * @param data The first byte of the block.
+ * @param size The size of the block, in bytes.
+ */
+bool is_binary(const char *data, size_t size) noexcept;
+
+/**
+ * @brief Calculates, in parallel, the checksum of a pair of columns.
+ *
+ * The checksum is the sum, modulo 2^64, of a mix of every measurement with
+ * its position, so it catches altered as well as swapped values whatever the
+ * order in which it is accumulated.
+ *
+ * @param x The x column.
+ * @param y The y column.
+ * @param n The number of measurements.
+ * @return uint64_t The checksum.
+ */
+uint64_t column_checksum(const double *x, const double *y, size_t n) noexcept;
+
+/**
+ * @brief Writes a data set into a binary file.
+ *
+ * @param filename The file name.
+ * @param data_set The data set.
+ * @param alignment The alignment of the columns, a power of two multiple of 8.
+ * @throw std::system_error If the file cannot be written.
+ * @throw std::invalid_argument If the alignment is not valid.
+ */
+void save_binary(const char *filename, const Data_Set &data_set,
+                 size_t alignment = Binary_Format::default_alignment);
+
+/**
+ * @brief Checks the header of a binary file: format version, type of the
+ * measurements, and position of the columns inside the file.
+ *
+ * @param header The header.
+ * @param size The size of the file, in bytes.
+ * @throw std::runtime_error If the header is not valid.
+ */
+void check_binary_header(const Binary_Header &header, uint64_t size);
+
+/**
+ * @brief Turns the mapping of a binary file into a data set pointing into it.
+ *
+ * @param file The mapping, kept alive by the data set.
+ * @param verify Whether to check the checksum, which reads the whole file.
+ * @return Data_Set The data set.
+ * @throw std::runtime_error If the header is not valid or the checksum does
+ * not match.
+ */
+Data_Set load_binary(Mapped_File &&file, bool verify = false);
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef BOOTSTRAP_HPP
+#define BOOTSTRAP_HPP
+
+#include "correlation.hpp"
+#include "data_set.hpp"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Confidence interval.
+ *
+ */
+struct Interval {
+  double low;  /** Lower bound. */
+  double high; /** Upper bound. */
+};
+
+/**
+ * @brief Bootstrap confidence intervals of a parameter.
+ *
+ */
+struct Bootstrap_Intervals {
+  Interval percentile; /** Percentile interval.                     */
+  Interval bca;        /** Bias-corrected and accelerated interval. */
+};
+
+/**
+ * @brief Bootstrap confidence intervals of a Pearson correlation.
+ *
+ */
+struct Bootstrap_Result {
+  Correlation estimate;  /** Correlation of the data set. */
+  Bootstrap_Intervals a; /** Intervals of the slope.      */
+  Bootstrap_Intervals b; /** Intervals of the shift.      */
+  Bootstrap_Intervals r; /** Intervals of r.              */
+};
+
+/**
+ * @brief Calculates bootstrap confidence intervals of the Pearson correlation
+ * of a data set.
+ *
+ * The resamples are drawn in parallel. Measurement i of resample k is picked
+ * from the words (k, i / 2) of a Philox generator, so the intervals only
+ * depend on the seed, whatever the number of threads. A resample is never
+ * stored: its measurements are gathered by blocks and their moments merged.
+ * The acceleration of the BCa intervals comes from the jackknife, every
+ * leave-one-out estimate being the moments of the data set minus one
+ * measurement.
+ *
+ * @param data_set The data set, of at least 3 measurements.
+ * @param resamples The number of resamples, at least 2.
+ * @param confidence The confidence level, in (0, 1).
+ * @param seed The seed of the random generator.
+ * @return Bootstrap_Result The estimate and its intervals.
+ * @throw std::invalid_argument If an argument is out of range.
+ */
+Bootstrap_Result bootstrap(const Data_Set &data_set, size_t resamples,
+                           double confidence = 0.95, uint64_t seed = 0);
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef COLUMN_BUFFER_HPP
+#define COLUMN_BUFFER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <sys/mman.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/partitioner.h>
+
+/**
+ * @brief Owning buffer of columns of measurements, each starting on a cache
+ * line, mapped anonymously and first touched in parallel.
+ *
+ * A page belongs to the NUMA node of the thread that first writes it. The
+ * buffer writes the rows of every column with a static_partitioner over
+ * blocked_range(0, rows, page_rows), which hands a range of rows to the same
+ * thread as any later loop or reduction over the same range and grain with a
+ * static_partitioner: each thread of such a pass then reads memory of its own
+ * node, whoever fills the buffer afterwards.
+ */
+class Column_Buffer {
+public:
+  /** Measurements per page, the grain of the first touch. */
+  static constexpr size_t page_rows = 4096 / sizeof(double);
+
+  /**
+   * @brief Maps and first touches a buffer of zeros.
+   *
+   * @param rows The number of measurements.
+   * @param columns The number of columns.
+   * @param huge_pages Whether to ask for transparent huge pages, fewer TLB
+   * misses on a large buffer, when the kernel allows them.
+   * @throw std::bad_alloc If the buffer cannot be mapped.
+   */
+  Column_Buffer(size_t rows, size_t columns, bool huge_pages = true)
+      : values(nullptr), length(0),
+        column_stride((rows + line - 1) / line * line),
+        row_count(rows), column_count(columns) {
+    length = column_stride * columns * sizeof(double);
+    if (length == 0) {
+      return;
+    }
+
+    void *const mapping = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+    if (huge_pages && length >= huge_page_size) {
+      ::madvise(mapping, length, MADV_HUGEPAGE);
+    }
+    values = static_cast<double *>(mapping);
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, rows, page_rows),
+        [this](const tbb::blocked_range<size_t> &r) {
+          for (size_t c = 0; c != column_count; c++) {
+            std::fill(column(c) + r.begin(), column(c) + r.end(), 0.0);
+          }
+        },
+        tbb::static_partitioner());
+  }
+
+  Column_Buffer(const Column_Buffer &) = delete;
+  Column_Buffer &operator=(const Column_Buffer &) = delete;
+
+  Column_Buffer(Column_Buffer &&other) noexcept
+      : values(other.values), length(other.length),
+        column_stride(other.column_stride),
+        row_count(other.row_count), column_count(other.column_count) {
+    other.values = nullptr;
+    other.length = 0;
+  }
+
+  Column_Buffer &operator=(Column_Buffer &&other) noexcept {
+    std::swap(values, other.values);
+    std::swap(length, other.length);
+    std::swap(column_stride, other.column_stride);
+    std::swap(row_count, other.row_count);
+    std::swap(column_count, other.column_count);
+    return *this;
+  }
+
+  /**
+   * @brief Unmaps the buffer.
+   *
+   */
+  ~Column_Buffer() {
+    if (values != nullptr) {
+      ::munmap(values, length);
+    }
+  }
+
+  /** First measurement of a column, aligned on 64 bytes. */
+  double *column(size_t c) noexcept { return values + c * column_stride; }
+
+  /** First measurement of a column, aligned on 64 bytes. */
+  const double *column(size_t c) const noexcept {
+    return values + c * column_stride;
+  }
+
+  /** Distance between the columns, in measurements, a multiple of 8. */
+  size_t stride() const noexcept { return column_stride; }
+
+  /** Number of measurements. */
+  size_t rows() const noexcept { return row_count; }
+
+  /** Number of columns. */
+  size_t columns() const noexcept { return column_count; }
+
+private:
+  /** Measurements per cache line. */
+  static constexpr size_t line = 64 / sizeof(double);
+
+  /** Size of a huge page, in bytes. */
+  static constexpr size_t huge_page_size = size_t(2) << 20;
+
+  double *values;       /** Mapping address.            */
+  size_t length;        /** Mapping length, in bytes.   */
+  size_t column_stride; /** Distance between columns.   */
+  size_t row_count;     /** Number of measurements.     */
+  size_t column_count;  /** Number of columns.          */
+};
+
+#endif
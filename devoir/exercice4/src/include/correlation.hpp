@@ -0,0 +1,54 @@
+#ifndef CORRELATION_HPP
+#define CORRELATION_HPP
+
+#include "data_set.hpp"
+
+/**
+ * @brief Pearson correlation.
+ *
+ */
+struct Correlation {
+  double a; /** Right slope.         */
+  double b; /** Y-axis shift.        */
+  double r; /** Pearson coefficient. */
+};
+
+/**
+ * @brief Calculates then returns the Pearson correlation of a data set, in a
+ * single parallel pass merging the moments of its chunks (see Moments).
+ *
+ * @param data_set The data set.
+ * @return Correlation The corresponding Pearson correlation.
+ */
+Correlation calculate(const Data_Set &data_set) noexcept;
+
+/**
+ * @brief Calculates then returns the Pearson correlation of a data set like
+ * calculate, but always merging the moments of the same chunks in the same
+ * order, so that the result is bit-identical whatever the number of threads.
+ *
+ * @param data_set The data set.
+ * @return Correlation The corresponding Pearson correlation.
+ */
+Correlation calculate_deterministic(const Data_Set &data_set) noexcept;
+
+/**
+ * @brief Calculates then returns the Pearson correlation of a data set, in two
+ * parallel passes: one for the averages, one for the centered sums.
+ *
+ * @param data_set The data set.
+ * @return Correlation The corresponding Pearson correlation.
+ */
+Correlation calculate_two_pass(const Data_Set &data_set) noexcept;
+
+/**
+ * @brief Calculates then returns the Pearson correlation of a data set, in two
+ * parallel passes running the vectorized, compensated kernels of simd_kernels.hpp
+ * picked for the processor.
+ *
+ * @param data_set The data set.
+ * @return Correlation The corresponding Pearson correlation.
+ */
+Correlation calculate_simd(const Data_Set &data_set) noexcept;
+
+#endif
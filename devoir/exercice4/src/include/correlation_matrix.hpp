@@ -0,0 +1,21 @@
+#ifndef CORRELATION_MATRIX_HPP
+#define CORRELATION_MATRIX_HPP
+
+#include "data_set.hpp"
+#include <vector>
+
+/**
+ * @brief Calculates the Pearson coefficient of every pair of columns.
+ *
+ * The columns are centered and normalized, so that the matrix is the product
+ * of their transpose by themselves, calculated like a matrix product: block
+ * of rows by block of rows, each block packed once into a row-major panel,
+ * then every tile of the upper triangle updated in parallel from its two
+ * slices of the panel with a register-blocked kernel.
+ *
+ * @param column_set The column set.
+ * @return std::vector<double> The m x m matrix of coefficients, row-major.
+ */
+std::vector<double> correlation_matrix(const Column_Set &column_set);
+
+#endif
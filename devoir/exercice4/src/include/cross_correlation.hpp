@@ -0,0 +1,36 @@
+#ifndef CROSS_CORRELATION_HPP
+#define CROSS_CORRELATION_HPP
+
+#include "data_set.hpp"
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Pearson coefficients of x against y shifted by every lag of a range.
+ *
+ */
+struct Cross_Correlation {
+  std::vector<double> r; /** Coefficient of the lags -max_lag to max_lag. */
+  long peak;             /** Lag of the largest |r|.                     */
+};
+
+/**
+ * @brief Calculates, for every lag k in [-max_lag, max_lag], the Pearson
+ * coefficient of the pairs (x[i], y[i + k]) that exist, as calculate would on
+ * the shifted columns, in O((n + max_lag) log(n + max_lag)) whatever the
+ * number of lags.
+ *
+ * The sums of the products of the centered columns at every lag come from a
+ * single zero-padded circular cross-correlation: both real columns are
+ * transformed by one complex FFT of x + iy, their spectra parted by symmetry,
+ * and the product transformed back. The averages and the sums of squares of
+ * the overlapping parts come from a Prefix_Index.
+ *
+ * @param data_set The data set.
+ * @param max_lag The largest lag, leaving at least 2 pairs.
+ * @return Cross_Correlation The coefficients and the lag of the peak.
+ * @throw std::invalid_argument If max_lag leaves fewer than 2 pairs.
+ */
+Cross_Correlation cross_correlation(const Data_Set &data_set, size_t max_lag);
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef DATA_SET_HPP
+#define DATA_SET_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class Mapped_File;
+
+/**
+ * @brief Data measurement set.
+ *
+ * The measurements live in storage shared by every copy of the data set: a
+ * Column_Buffer filled by the text parser, or the memory mapping of a binary
+ * file.
+ */
+struct Data_Set {
+  size_t n;                           /** Number of measurements.  */
+  const double *x;                    /** Variable X measurements. */
+  const double *y;                    /** Variable Y measurements. */
+  std::shared_ptr<const void> storage; /** Keeps x and y alive.     */
+};
+
+/**
+ * @brief Measurement set of any number of variables, one column per variable.
+ *
+ */
+struct Column_Set {
+  size_t n;                            /** Number of measurements.  */
+  std::vector<const double *> columns; /** Measurements, by column. */
+  std::shared_ptr<const void> storage; /** Keeps columns alive.     */
+
+  /** Number of variables. */
+  size_t m() const noexcept { return columns.size(); }
+};
+
+/**
+ * @brief Parses a column set from its text representation: the number of
+ * measurements on the first line, then one line of m values per measurement,
+ * m being given by the first one.
+ *
+ * The text is split at line boundaries into chunks that are parsed in
+ * parallel, each chunk writing its rows at an offset given by the prefix sum
+ * of the row counts of the chunks before it.
+ *
+ * @param begin The first character of the text.
+ * @param end Past the last character of the text.
+ * @return Column_Set The column set.
+ * @throw std::runtime_error If the text is malformed or holds fewer rows than
+ * announced.
+ */
+Column_Set parse_columns(const char *begin, const char *end);
+
+/**
+ * @brief Parses a data set from its text representation: the number of
+ * measurements on the first line, then one "x y" pair per line (see
+ * parse_columns).
+ *
+ * @param begin The first character of the text.
+ * @param end Past the last character of the text.
+ * @return Data_Set The data set.
+ * @throw std::runtime_error If the text is malformed, holds fewer pairs than
+ * announced or other than two columns.
+ */
+Data_Set parse_text(const char *begin, const char *end);
+
+/**
+ * @brief Views a column set of two columns as a data set.
+ *
+ * @throw std::runtime_error If the column set has other than two columns.
+ */
+Data_Set to_data_set(const Column_Set &column_set);
+
+/**
+ * @brief Loads a data set from a file mapped into memory: a binary file (see
+ * binary_format.hpp) is used in place, a text file is parsed with parse_text.
+ *
+ * @param filename The file name.
+ * @param verify Whether to check the checksum of a binary file, which reads
+ * all of it.
+ * @return Data_Set The data set.
+ * @throw std::system_error If the file cannot be opened or mapped.
+ * @throw std::runtime_error If its content is malformed.
+ */
+Data_Set load_file(const char *filename, bool verify = false);
+
+/**
+ * @brief Turns a file already mapped into memory into a data set, like
+ * load_file.
+ *
+ * @param file The mapping, kept alive by the data set if it is binary.
+ * @param verify Whether to check the checksum of a binary file.
+ * @return Data_Set The data set.
+ * @throw std::runtime_error If its content is malformed.
+ */
+Data_Set load_mapped(Mapped_File &&file, bool verify = false);
+
+/**
+ * @brief Loads a column set from a file: a text file is parsed with
+ * parse_columns, a binary file gives its two columns.
+ *
+ * @param filename The file name.
+ * @return Column_Set The column set.
+ * @throw std::system_error If the file cannot be opened or mapped.
+ * @throw std::runtime_error If its content is malformed.
+ */
+Column_Set load_columns(const char *filename);
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef FFT_HPP
+#define FFT_HPP
+
+#include <complex>
+#include <cstddef>
+
+/**
+ * @brief Calculates in place the discrete Fourier transform of a sequence of
+ * power of 2 size, leaving it in bit-reversed order.
+ *
+ * Radix-2 decimation in frequency, in parallel: the butterflies of the first
+ * stages, which span more than a block, are split among the tasks, then the
+ * last stages run block by block, each block staying in cache. Every stage
+ * reads its twiddle factors in order from a table of its own.
+ *
+ * In bit-reversed order, the frequencies k and -k of a transform of size at
+ * least 2 both lie in [2^j, 2^(j+1)) for some j, at positions p and
+ * 3 * 2^j - 1 - p, or both at 0, or both at 1.
+ *
+ * @param values The sequence.
+ * @param size Its size, a power of 2.
+ */
+void fft_bit_reversed(std::complex<double> *values, size_t size);
+
+/**
+ * @brief Calculates in place the inverse discrete Fourier transform, without
+ * the 1 / size factor, of a sequence in bit-reversed order, leaving it in
+ * natural order: the reverse of fft_bit_reversed, up to that factor.
+ *
+ * Radix-2 decimation in time, the stages of fft_bit_reversed in the reverse
+ * order.
+ *
+ * @param values The sequence.
+ * @param size Its size, a power of 2.
+ */
+void inverse_fft_bit_reversed(std::complex<double> *values, size_t size);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef GROUPED_CORRELATION_HPP
+#define GROUPED_CORRELATION_HPP
+
+#include "correlation.hpp"
+#include "data_set.hpp"
+#include <vector>
+
+/**
+ * @brief Pearson correlation of the measurements sharing a key.
+ *
+ */
+struct Group {
+  double key;              /** Key of the group.          */
+  double n;                /** Number of measurements.    */
+  Correlation correlation; /** Their Pearson correlation. */
+};
+
+/**
+ * @brief Calculates the Pearson correlation of every group of a column set of
+ * three columns: the key, x and y.
+ *
+ * Every reducer of a parallel pass adds its measurements to the Moments of
+ * their group in an open-addressing hash table of its own, and join merges
+ * the smaller table into the larger one. So that no table grows past a fixed
+ * budget whatever the number of groups, a first pass estimates it with a
+ * HyperLogLog sketch, and the keys are then split by hash between enough
+ * passes.
+ *
+ * @param column_set The column set.
+ * @return std::vector<Group> The groups, by increasing key.
+ * @throw std::runtime_error If the column set has other than three columns.
+ */
+std::vector<Group> grouped_correlation(const Column_Set &column_set);
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cerrno>
+#include <cstddef>
+#include <system_error>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Read-only memory mapping of a whole file.
+ *
+ */
+class Mapped_File {
+public:
+  /**
+   * @brief Maps a file into memory.
+   *
+   * @param filename The file name.
+   * @param populate Whether to read the whole file in now rather than on the
+   * first access to each page.
+   * @throw std::system_error If the file cannot be opened or mapped.
+   */
+  explicit Mapped_File(const char *filename, bool populate = false)
+      : address(nullptr), length(0) {
+    const int fd = ::open(filename, O_RDONLY);
+    if (fd < 0) {
+      throw std::system_error(errno, std::generic_category(), filename);
+    }
+
+    struct stat status;
+    if (::fstat(fd, &status) != 0) {
+      const int error = errno;
+      ::close(fd);
+      throw std::system_error(error, std::generic_category(), filename);
+    }
+
+    // An empty file cannot be mapped, but is still a valid (empty) mapping.
+    length = static_cast<size_t>(status.st_size);
+    if (length != 0) {
+      void *const mapping =
+          ::mmap(nullptr, length, PROT_READ,
+                 MAP_PRIVATE | (populate ? MAP_POPULATE : 0), fd, 0);
+      if (mapping == MAP_FAILED) {
+        const int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), filename);
+      }
+      ::madvise(mapping, length, MADV_WILLNEED);
+      address = static_cast<const char *>(mapping);
+    }
+
+    ::close(fd);
+  }
+
+  Mapped_File(const Mapped_File &) = delete;
+  Mapped_File &operator=(const Mapped_File &) = delete;
+
+  Mapped_File(Mapped_File &&other) noexcept
+      : address(other.address), length(other.length) {
+    other.address = nullptr;
+    other.length = 0;
+  }
+
+  Mapped_File &operator=(Mapped_File &&other) noexcept {
+    std::swap(address, other.address);
+    std::swap(length, other.length);
+    return *this;
+  }
+
+  /**
+   * @brief Unmaps the file.
+   *
+   */
+  ~Mapped_File() {
+    if (address != nullptr) {
+      ::munmap(const_cast<char *>(address), length);
+    }
+  }
+
+  /** First byte of the file. */
+  const char *data() const noexcept { return address; }
+
+  /** Size of the file in bytes. */
+  size_t size() const noexcept { return length; }
+
+private:
+  const char *address; /** Mapping address. */
+  size_t length;       /** Mapping length.  */
+};
+
+#endif
@@ -0,0 +1,320 @@
+#ifndef MOMENTS_HPP
+#define MOMENTS_HPP
+
+#include "correlation.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+/**
+ * @brief Count, means and centered co-moments of a set of measurements.
+ *
+ * Moments of disjoint sets are merged with the pairwise formula of Chan et
+ * al., so a data set can be summarised chunk by chunk, in any order, without
+ * going twice over its measurements. Single measurements are added or removed
+ * in O(1) with Welford updates.
+ */
+struct Moments {
+  double n = 0.0;      /** Number of measurements.           */
+  double mean_x = 0.0; /** Average of X.                     */
+  double mean_y = 0.0; /** Average of Y.                     */
+  double m_xx = 0.0;   /** Sum of (x - mean_x)^2.            */
+  double m_xy = 0.0;   /** Sum of (x - mean_x)(y - mean_y).  */
+  double m_yy = 0.0;   /** Sum of (y - mean_y)^2.            */
+
+  /**
+   * @brief Calculates the moments of a block small enough to stay in cache,
+   * averages first then centered sums.
+   *
+   * The averages are taken from an origin: with one near the measurements,
+   * they keep the digits of the spread of the measurements rather than those
+   * of their offset. Moments from the same origin merge as usual; shift moves
+   * them back.
+   *
+   * @param x The X measurements.
+   * @param y The Y measurements.
+   * @param count The number of measurements.
+   * @param origin_x The origin of X.
+   * @param origin_y The origin of Y.
+   * @return Moments The moments of the block.
+   */
+  static Moments of(const double *x, const double *y, size_t count,
+                    double origin_x = 0.0, double origin_y = 0.0) noexcept {
+    Moments res;
+    if (count == 0) {
+      return res;
+    }
+
+    double sum_x = 0.0, sum_y = 0.0;
+    for (size_t i = 0; i != count; i++) {
+      sum_x += x[i] - origin_x;
+      sum_y += y[i] - origin_y;
+    }
+    res.n = static_cast<double>(count);
+    res.mean_x = sum_x / res.n;
+    res.mean_y = sum_y / res.n;
+
+    for (size_t i = 0; i != count; i++) {
+      const double dx = (x[i] - origin_x) - res.mean_x;
+      const double dy = (y[i] - origin_y) - res.mean_y;
+      res.m_xx += dx * dx;
+      res.m_xy += dx * dy;
+      res.m_yy += dy * dy;
+    }
+    return res;
+  }
+
+  /**
+   * @brief Moves the origin of the measurements by (x, y).
+   *
+   */
+  void shift(double x, double y) noexcept {
+    mean_x += x;
+    mean_y += y;
+  }
+
+  /**
+   * @brief Adds a measurement (Welford).
+   *
+   */
+  void push(double x, double y) noexcept {
+    n += 1.0;
+    const double dx = x - mean_x;
+    const double dy = y - mean_y;
+    mean_x += dx / n;
+    mean_y += dy / n;
+    m_xx += dx * (x - mean_x);
+    m_xy += dx * (y - mean_y);
+    m_yy += dy * (y - mean_y);
+  }
+
+  /**
+   * @brief Removes a measurement previously added, reversing push.
+   *
+   */
+  void pop(double x, double y) noexcept {
+    if (n <= 1.0) {
+      *this = Moments();
+      return;
+    }
+    n -= 1.0;
+    const double dx = x - mean_x;
+    const double dy = y - mean_y;
+    mean_x -= dx / n;
+    mean_y -= dy / n;
+    m_xx -= dx * (x - mean_x);
+    m_xy -= dy * (x - mean_x);
+    m_yy -= dy * (y - mean_y);
+  }
+
+  /**
+   * @brief Adds the moments of a disjoint set of measurements (Chan et al.).
+   *
+   * @param other The moments of the other set.
+   */
+  void merge(const Moments &other) noexcept {
+    if (other.n == 0.0) {
+      return;
+    }
+    if (n == 0.0) {
+      *this = other;
+      return;
+    }
+    const double total = n + other.n;
+    const double dx = other.mean_x - mean_x;
+    const double dy = other.mean_y - mean_y;
+    const double weight = n * other.n / total;
+    mean_x += dx * (other.n / total);
+    mean_y += dy * (other.n / total);
+    m_xx += other.m_xx + dx * dx * weight;
+    m_xy += other.m_xy + dx * dy * weight;
+    m_yy += other.m_yy + dy * dy * weight;
+    n = total;
+  }
+
+  /**
+   * @brief Removes the moments of a subset of the measurements, reversing
+   * merge.
+   *
+   * @param other The moments of the subset.
+   */
+  void remove(const Moments &other) noexcept {
+    if (other.n == 0.0) {
+      return;
+    }
+    const double rest = n - other.n;
+    if (rest <= 0.0) {
+      *this = Moments();
+      return;
+    }
+    const double rest_mean_x = mean_x + (mean_x - other.mean_x) * (other.n / rest);
+    const double rest_mean_y = mean_y + (mean_y - other.mean_y) * (other.n / rest);
+    const double dx = other.mean_x - rest_mean_x;
+    const double dy = other.mean_y - rest_mean_y;
+    const double weight = rest * other.n / n;
+    m_xx -= other.m_xx + dx * dx * weight;
+    m_xy -= other.m_xy + dx * dy * weight;
+    m_yy -= other.m_yy + dy * dy * weight;
+    mean_x = rest_mean_x;
+    mean_y = rest_mean_y;
+    n = rest;
+  }
+
+  /**
+   * @brief Returns the Pearson correlation of the measurements.
+   *
+   */
+  Correlation correlation() const noexcept {
+    Correlation res;
+    res.a = m_xy / m_xx;
+    res.b = mean_y - res.a * mean_x;
+    res.r = m_xy / std::sqrt(m_xx * m_yy);
+    return res;
+  }
+};
+
+/**
+ * @brief Merges the summaries of consecutive blocks of measurements like a
+ * binary counter: two summaries of 2^k blocks are merged into one of 2^(k+1)
+ * blocks as soon as both are complete.
+ *
+ * Folding thousands of small blocks one after another into a running total
+ * merges every block into a total thousands of times larger, and the rounding
+ * errors grow with the number of blocks; merged pairwise, the summaries keep
+ * similar sizes and every block goes through O(log(blocks)) merges only.
+ *
+ * @tparam Summary A summary with a default constructor for the empty set and
+ * a merge method, such as Moments or Column_Moments.
+ */
+template <typename Summary> class Pairwise_Merger {
+public:
+  /**
+   * @brief Adds the summary of the next block.
+   *
+   */
+  void push(const Summary &block) noexcept {
+    Summary carry = block;
+    size_t level = 0;
+    for (; blocks >> level & 1; level++) {
+      Summary merged = levels[level];
+      merged.merge(carry);
+      carry = merged;
+    }
+    levels[level] = carry;
+    blocks++;
+  }
+
+  /**
+   * @brief Returns the summary of all the blocks added so far.
+   *
+   */
+  Summary total() const noexcept {
+    Summary res;
+    for (size_t level = levels.size(); level-- != 0;) {
+      if (blocks >> level & 1) {
+        res.merge(levels[level]);
+      }
+    }
+    return res;
+  }
+
+private:
+  std::array<Summary, 64> levels; /** Summary of 2^k blocks at level k. */
+  size_t blocks = 0;              /** Number of blocks added.           */
+};
+
+/**
+ * @brief Calculates the moments of consecutive blocks of measurements with
+ * Moments::of, all from the same origin, and merges them pairwise.
+ *
+ * @param x The X measurements.
+ * @param y The Y measurements.
+ * @param count The number of measurements.
+ * @param block The number of measurements of a block.
+ * @param origin_x The origin of X.
+ * @param origin_y The origin of Y.
+ * @return Moments The moments of the measurements, from the origin.
+ */
+inline Moments block_moments(const double *x, const double *y, size_t count,
+                             size_t block, double origin_x,
+                             double origin_y) noexcept {
+  Pairwise_Merger<Moments> merger;
+  for (size_t i = 0; i < count; i += block) {
+    merger.push(Moments::of(x + i, y + i, std::min(block, count - i), origin_x,
+                            origin_y));
+  }
+  return merger.total();
+}
+
+/**
+ * @brief Moments of a stream of blocks of measurements, taken from the first
+ * measurement and merged pairwise, as block_moments does for measurements
+ * already in memory.
+ *
+ */
+class Block_Moments {
+public:
+  /**
+   * @brief Adds the next block.
+   *
+   * @param x The X measurements.
+   * @param y The Y measurements.
+   * @param count The number of measurements.
+   */
+  void push(const double *x, const double *y, size_t count) noexcept {
+    if (count == 0) {
+      return;
+    }
+    if (not started) {
+      origin_x = x[0];
+      origin_y = y[0];
+      started = true;
+    }
+    merger.push(Moments::of(x, y, count, origin_x, origin_y));
+  }
+
+  /**
+   * @brief Returns the moments of all the blocks added so far.
+   *
+   */
+  Moments total() const noexcept {
+    Moments res = merger.total();
+    if (res.n != 0.0) {
+      res.shift(origin_x, origin_y);
+    }
+    return res;
+  }
+
+private:
+  Pairwise_Merger<Moments> merger; /** Moments from the origin. */
+  double origin_x = 0.0;           /** First X measurement.     */
+  double origin_y = 0.0;           /** First Y measurement.     */
+  bool started = false;            /** Whether there is one.    */
+};
+
+/**
+ * @brief Calculates, in a single parallel pass, the moments of a set of
+ * measurements.
+ *
+ * @param x The X measurements.
+ * @param y The Y measurements.
+ * @param n The number of measurements.
+ * @return Moments The moments.
+ */
+Moments calculate_moments(const double *x, const double *y, size_t n) noexcept;
+
+/**
+ * @brief Calculates the moments of a set of measurements like
+ * calculate_moments, over a tree of chunks that depends only on n, so that
+ * the result does not depend on the number of threads.
+ *
+ * @param x The X measurements.
+ * @param y The Y measurements.
+ * @param n The number of measurements.
+ * @return Moments The moments.
+ */
+Moments calculate_moments_deterministic(const double *x, const double *y,
+                                        size_t n) noexcept;
+
+#endif
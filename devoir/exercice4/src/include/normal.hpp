@@ -0,0 +1,75 @@
+#ifndef NORMAL_HPP
+#define NORMAL_HPP
+
+#include <cmath>
+
+/**
+ * @brief Cumulative distribution function of the standard normal law.
+ *
+ */
+inline double normal_cdf(double z) noexcept {
+  return 0.5 * std::erfc(-z / std::sqrt(2.0));
+}
+
+/**
+ * @brief Quantile function of the standard normal law: Acklam's rational
+ * approximation, refined by one Halley step.
+ *
+ * @param p The probability, in (0, 1).
+ */
+inline double normal_quantile(double p) noexcept {
+  static constexpr double a[] = {-3.969683028665376e+01, 2.209460984245205e+02,
+                                 -2.759285104469687e+02, 1.383577518672690e+02,
+                                 -3.066479806614716e+01, 2.506628277459239e+00};
+  static constexpr double b[] = {-5.447609879822406e+01, 1.615858368580409e+02,
+                                 -1.556989798598866e+02, 6.680131188771972e+01,
+                                 -1.328068155288572e+01};
+  static constexpr double c[] = {-7.784894002430293e-03, -3.223964580411365e-01,
+                                 -2.400758277161838e+00, -2.549732539343734e+00,
+                                 4.374664141464968e+00,  2.938163982698783e+00};
+  static constexpr double d[] = {7.784695709041462e-03, 3.224671290700398e-01,
+                                 2.445134137142996e+00, 3.754408661907416e+00};
+  static constexpr double p_low = 0.02425;
+
+  double z;
+  if (p < p_low || p > 1.0 - p_low) {
+    // Tails.
+    const double q = std::sqrt(-2.0 * std::log(p < p_low ? p : 1.0 - p));
+    z = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+        ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    z = p < p_low ? z : -z;
+  } else {
+    // Central region.
+    const double q = p - 0.5;
+    const double s = q * q;
+    z = (((((a[0] * s + a[1]) * s + a[2]) * s + a[3]) * s + a[4]) * s + a[5]) *
+        q /
+        (((((b[0] * s + b[1]) * s + b[2]) * s + b[3]) * s + b[4]) * s + 1.0);
+  }
+
+  const double e = normal_cdf(z) - p;
+  const double u = e * std::sqrt(2.0 * M_PI) * std::exp(z * z / 2.0);
+  return z - u / (1.0 + z * u / 2.0);
+}
+
+/**
+ * @brief Quantile function of Student's t law, from the normal one by the
+ * Cornish-Fisher expansion (Abramowitz and Stegun 26.7.5), close enough from
+ * 3 degrees of freedom on.
+ *
+ * @param p The probability, in (0, 1).
+ * @param dof The number of degrees of freedom.
+ */
+inline double student_quantile(double p, double dof) noexcept {
+  const double z = normal_quantile(p);
+  const double z2 = z * z;
+  const double g1 = (z2 + 1.0) * z / 4.0;
+  const double g2 = ((5.0 * z2 + 16.0) * z2 + 3.0) * z / 96.0;
+  const double g3 = (((3.0 * z2 + 19.0) * z2 + 17.0) * z2 - 15.0) * z / 384.0;
+  const double g4 =
+      ((((79.0 * z2 + 776.0) * z2 + 1482.0) * z2 - 1920.0) * z2 - 945.0) * z /
+      92160.0;
+  return z + (g1 + (g2 + (g3 + g4 / dof) / dof) / dof) / dof;
+}
+
+#endif
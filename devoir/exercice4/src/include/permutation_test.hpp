@@ -0,0 +1,48 @@
+#ifndef PERMUTATION_TEST_HPP
+#define PERMUTATION_TEST_HPP
+
+#include "data_set.hpp"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Result of a permutation test.
+ *
+ */
+struct Permutation_Result {
+  double r;            /** Observed Pearson coefficient.                   */
+  double p_value;      /** Two-sided p-value, (extreme + 1) / (count + 1). */
+  double error;        /** Standard error of the p-value.                  */
+  size_t permutations; /** Number of permutations drawn.                   */
+  size_t extreme;      /** Permutations with |r| at least the observed.    */
+};
+
+/**
+ * @brief Tests the significance of the Pearson coefficient of a data set by
+ * permuting its y column.
+ *
+ * A permutation changes neither the averages nor the sums of squares, so
+ * only the cross term, the sum of dx[i] * dy[p(i)] over the centered columns,
+ * is calculated for each one, fused with its Fisher-Yates shuffle of dy.
+ * When dy is small enough for several copies to stay in cache, every task
+ * shuffles a few permutations together, each in its own copy, so that their
+ * dependency chains overlap. Permutation k is keyed by stream k of a Philox
+ * generator, so the result does not depend on the number of threads.
+ *
+ * The permutations are drawn by batches, in parallel within a batch; the test
+ * stops after the batch where the standard error of the p-value falls to the
+ * precision.
+ *
+ * @param data_set The data set, of at least 3 measurements.
+ * @param max_permutations The largest number of permutations, at least 1.
+ * @param precision The standard error of the p-value at which to stop, or 0
+ * to draw every permutation.
+ * @param seed The seed of the random generator.
+ * @return Permutation_Result The result of the test.
+ * @throw std::invalid_argument If an argument is out of range.
+ */
+Permutation_Result permutation_test(const Data_Set &data_set,
+                                    size_t max_permutations,
+                                    double precision = 0.0, uint64_t seed = 0);
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef PHILOX_HPP
+#define PHILOX_HPP
+
+#include <array>
+#include <cstdint>
+
+/**
+ * @brief Philox4x32-10 counter-based random number generator (Salmon et al.,
+ * "Parallel random numbers: as easy as 1, 2, 3").
+ *
+ * The output is a pure function of a key and a counter, so any thread can
+ * draw the k-th number of any stream without drawing the ones before it, and
+ * the numbers do not depend on how the work is split between threads.
+ */
+class Philox {
+public:
+  using Counter = std::array<uint32_t, 4>;
+
+  /**
+   * @brief Builds the generator of a key.
+   *
+   * @param seed The key.
+   */
+  explicit Philox(uint64_t seed) noexcept
+      : key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)} {}
+
+  /**
+   * @brief Returns the four random words of a counter.
+   *
+   */
+  Counter operator()(Counter counter) const noexcept {
+    uint32_t k0 = key[0], k1 = key[1];
+    for (int round = 0; round != 10; round++) {
+      const uint64_t p0 = uint64_t(0xD2511F53) * counter[0];
+      const uint64_t p1 = uint64_t(0xCD9E8D57) * counter[2];
+      counter = {static_cast<uint32_t>(p1 >> 32) ^ counter[1] ^ k0,
+                 static_cast<uint32_t>(p1),
+                 static_cast<uint32_t>(p0 >> 32) ^ counter[3] ^ k1,
+                 static_cast<uint32_t>(p0)};
+      k0 += 0x9E3779B9;
+      k1 += 0xBB67AE85;
+    }
+    return counter;
+  }
+
+  /**
+   * @brief Returns the two random 64-bit words of a position in a stream.
+   *
+   * @param stream The stream.
+   * @param position The position in the stream.
+   */
+  std::array<uint64_t, 2> operator()(uint64_t stream,
+                                     uint64_t position) const noexcept {
+    const Counter words = (*this)(
+        Counter{static_cast<uint32_t>(position),
+                static_cast<uint32_t>(position >> 32),
+                static_cast<uint32_t>(stream),
+                static_cast<uint32_t>(stream >> 32)});
+    return {uint64_t(words[1]) << 32 | words[0],
+            uint64_t(words[3]) << 32 | words[2]};
+  }
+
+private:
+  uint32_t key[2]; /** Key, low word first. */
+};
+
+/**
+ * @brief Next word of a splitmix64 sequence, a much cheaper generator to draw
+ * many numbers from a state seeded by Philox.
+ *
+ * @param state The state, advanced.
+ */
+inline uint64_t splitmix(uint64_t &state) noexcept {
+  uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef PREFIX_INDEX_HPP
+#define PREFIX_INDEX_HPP
+
+#include "correlation.hpp"
+#include "data_set.hpp"
+#include "moments.hpp"
+#include "simd_kernels.hpp"
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Cumulative sums of a data set answering the moments, hence the
+ * correlation, of any range of measurements in constant time.
+ *
+ * The sums are those of x, y, x^2, xy and y^2, shifted by the averages of
+ * the whole data set so that they stay small. They are stored on two levels
+ * to stay accurate: compensated sums up to the start of every block, built by
+ * a parallel prefix scan, plus plain sums from the start of its block for
+ * every measurement.
+ */
+class Prefix_Index {
+public:
+  /**
+   * @brief Builds the index.
+   *
+   * @param data_set The data set.
+   */
+  explicit Prefix_Index(const Data_Set &data_set);
+
+  /**
+   * @brief Returns the moments of the measurements [first, last).
+   *
+   * @param first The first measurement, at most last.
+   * @param last Past the last measurement, at most size().
+   */
+  Moments moments(size_t first, size_t last) const noexcept;
+
+  /**
+   * @brief Returns the Pearson correlation of the measurements [first, last).
+   *
+   */
+  Correlation correlation(size_t first, size_t last) const noexcept {
+    return moments(first, last).correlation();
+  }
+
+  /** Number of measurements. */
+  size_t size() const noexcept { return inner.size() - 1; }
+
+  /** Number of measurements per block. */
+  static constexpr size_t block = 256;
+
+private:
+  /**
+   * @brief Plain sums, from the start of a block.
+   *
+   */
+  struct Sums {
+    double x, y, xx, xy, yy;
+  };
+
+  /**
+   * @brief Compensated sums, from the first measurement.
+   *
+   */
+  struct Block_Sums {
+    Compensated x, y, xx, xy, yy;
+
+    void add(const Block_Sums &other) noexcept {
+      x.add(other.x);
+      y.add(other.y);
+      xx.add(other.xx);
+      xy.add(other.xy);
+      yy.add(other.yy);
+    }
+  };
+
+  double shift_x;                 /** Average of X.                       */
+  double shift_y;                 /** Average of Y.                       */
+  std::vector<Sums> inner;        /** Sums from the block start, by row.  */
+  std::vector<Block_Sums> blocks; /** Sums up to every block start.       */
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef PROGRESSIVE_CORRELATION_HPP
+#define PROGRESSIVE_CORRELATION_HPP
+
+#include "correlation.hpp"
+#include "data_set.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/**
+ * @brief Settings of a progressive correlation.
+ *
+ */
+struct Progressive_Options {
+  double confidence = 0.95; /** Confidence level of the bounds of r.       */
+  double precision = 0.001; /** Half-width of the bounds at which to stop,
+                                0 to never stop for it.                    */
+  double budget = 1.0;      /** Seconds after which to stop, 0 for none.   */
+  double cadence = 0.1;     /** Seconds between two reports.               */
+  size_t block = 16384;     /** Consecutive measurements drawn together.   */
+  uint64_t seed = 0;        /** Seed of the random order of the blocks.    */
+};
+
+/**
+ * @brief Estimate of a progressive correlation.
+ *
+ */
+struct Progress {
+  Correlation estimate; /** Correlation of the measurements seen so far. */
+  double low;           /** Lower confidence bound of r.                 */
+  double high;          /** Upper confidence bound of r.                 */
+  double measurements;  /** Number of measurements seen so far.          */
+  double fraction;      /** Their fraction of the data set.              */
+  double seconds;       /** Time since the start.                        */
+};
+
+/**
+ * @brief Estimates the Pearson correlation of a data set from a growing
+ * random sample of it, reporting refined estimates as it goes.
+ *
+ * The data set is cut into blocks, which are visited in a random order.
+ * Waves of a fixed number of blocks are summarised in parallel, and the
+ * Moments of the blocks are merged into those of the sample in their order.
+ * The bounds of r come from Fisher's z transformation, its variance being
+ * estimated by a jackknife over groups of blocks, with the finite population
+ * correction of the blocks, so they collapse to r once every block is seen.
+ * A binary file mapped in place is only read where the blocks are drawn.
+ *
+ * @param data_set The data set, of at least 2 measurements.
+ * @param options The settings.
+ * @param report Called with the estimate every cadence, and at the end.
+ * @return Progress The last estimate, once the bounds are precise enough,
+ * the budget is spent or every block is seen.
+ * @throw std::invalid_argument If an argument is out of range.
+ */
+Progress progressive_correlation(
+    const Data_Set &data_set, const Progressive_Options &options,
+    const std::function<void(const Progress &)> &report);
+
+#endif
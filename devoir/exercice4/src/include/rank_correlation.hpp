@@ -0,0 +1,47 @@
+#ifndef RANK_CORRELATION_HPP
+#define RANK_CORRELATION_HPP
+
+#include "data_set.hpp"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Calculates Spearman's rank correlation coefficient: the Pearson
+ * coefficient of the ranks, tied measurements sharing their average rank.
+ *
+ * Each column is ranked with a parallel sort; the runs of ties are then
+ * ranked in parallel.
+ *
+ * @param data_set The data set, without NaN.
+ * @return double The coefficient.
+ */
+double spearman(const Data_Set &data_set);
+
+/**
+ * @brief Calculates Kendall's tau-b rank correlation coefficient in
+ * O(n log n) (Knight's algorithm).
+ *
+ * The pairs are sorted by x then y, so that the discordant pairs are the
+ * inversions of the y column, counted by a parallel merge sort.
+ *
+ * @param data_set The data set, without NaN.
+ * @return double The coefficient.
+ */
+double kendall_tau_b(const Data_Set &data_set);
+
+/**
+ * @brief Sorts an array with a parallel merge sort, counting its inversions:
+ * the pairs i < j such that values[i] > values[j].
+ *
+ * The merges are split recursively like ParallelRecursiveMerge (exercice2):
+ * the middle element of the longer run is searched in the shorter one, the
+ * two halves are merged in parallel, and the inversions between them are
+ * known from the split positions.
+ *
+ * @param values The array.
+ * @param n Its size.
+ * @return uint64_t The number of inversions.
+ */
+uint64_t sort_count_inversions(double *values, size_t n);
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef REGRESSION_HPP
+#define REGRESSION_HPP
+
+#include "data_set.hpp"
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Ordinary least squares fit of a response on several predictors.
+ *
+ */
+struct Regression {
+  std::vector<double> coefficients; /** Intercept, then one per predictor.    */
+  std::vector<double> errors;       /** Their standard errors.                */
+  double r2;                        /** Coefficient of determination.         */
+  size_t rank;                      /** Number of independent predictors.     */
+  bool cholesky;                    /** Whether Cholesky solved it, not QR.   */
+};
+
+/**
+ * @brief Fits the last column of a column set on the other ones, with an
+ * intercept, by ordinary least squares.
+ *
+ * The centered cross products of the columns are accumulated in a single
+ * parallel pass: every reducer packs blocks of rows into a panel, multiplies
+ * it by its transpose with a register-blocked kernel, and merges the result
+ * into its sums like Moments::merge, which join does as well. The normal
+ * equations are then solved by Cholesky. If the predictors are too collinear
+ * for it, a QR factorization with column pivoting keeps an independent
+ * subset of them and solves for those, the others getting a zero coefficient
+ * and a NaN standard error.
+ *
+ * @param column_set The column set: the predictors then the response.
+ * @return Regression The fit.
+ * @throw std::runtime_error If there are fewer than two columns, or not more
+ * measurements than coefficients.
+ */
+Regression linear_regression(const Column_Set &column_set);
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef SIMD_KERNELS_HPP
+#define SIMD_KERNELS_HPP
+
+#include <cstddef>
+
+/**
+ * @brief Compensated sum: the rounded sum plus the rounding errors made while
+ * accumulating it (TwoSum error-free transformation).
+ *
+ */
+struct Compensated {
+  double sum = 0.0;   /** Rounded sum.            */
+  double error = 0.0; /** Accumulated round-offs. */
+
+  /**
+   * @brief Adds a value, keeping track of the rounding error.
+   *
+   */
+  void add(double value) noexcept {
+    const double t = sum + value;
+    const double z = t - sum;
+    error += (sum - (t - z)) + (value - z);
+    sum = t;
+  }
+
+  /**
+   * @brief Adds another compensated sum.
+   *
+   */
+  void add(const Compensated &other) noexcept {
+    add(other.sum);
+    error += other.error;
+  }
+
+  /**
+   * @brief Returns the corrected sum.
+   *
+   */
+  double value() const noexcept { return sum + error; }
+};
+
+/**
+ * @brief Compensated sums of two columns.
+ *
+ */
+struct Column_Sums {
+  Compensated x; /** Sum of X. */
+  Compensated y; /** Sum of Y. */
+
+  void add(const Column_Sums &other) noexcept {
+    x.add(other.x);
+    y.add(other.y);
+  }
+};
+
+/**
+ * @brief Compensated centered sums of products of two columns.
+ *
+ */
+struct Centered_Sums {
+  Compensated xx; /** Sum of (x - mean_x)^2.           */
+  Compensated xy; /** Sum of (x - mean_x)(y - mean_y). */
+  Compensated yy; /** Sum of (y - mean_y)^2.           */
+
+  void add(const Centered_Sums &other) noexcept {
+    xx.add(other.xx);
+    xy.add(other.xy);
+    yy.add(other.yy);
+  }
+};
+
+/**
+ * @brief Explicitly vectorized, compensated summation kernels.
+ *
+ * Each kernel keeps several independent vector accumulators, each one
+ * compensated with TwoSum; the AVX kernels also recover the rounding error of
+ * the products with a fused multiply-add. The instruction set is picked at
+ * run time among those the processor supports.
+ */
+namespace simd {
+
+/**
+ * @brief Instruction sets with a kernel.
+ *
+ */
+enum class Isa { scalar, avx2, avx512 };
+
+/**
+ * @brief Tells whether the processor supports an instruction set.
+ *
+ */
+bool supported(Isa isa) noexcept;
+
+/**
+ * @brief Returns the widest instruction set supported by the processor.
+ *
+ */
+Isa detected_isa() noexcept;
+
+/**
+ * @brief Returns the name of an instruction set.
+ *
+ */
+const char *isa_name(Isa isa) noexcept;
+
+/**
+ * @brief Sums two columns.
+ *
+ * @param x The X measurements.
+ * @param y The Y measurements.
+ * @param n The number of measurements.
+ * @param isa The instruction set to use, which must be supported.
+ * @return Column_Sums The compensated sums.
+ */
+Column_Sums sums(const double *x, const double *y, size_t n,
+                 Isa isa = detected_isa()) noexcept;
+
+/**
+ * @brief Sums the centered products of two columns.
+ *
+ * @param x The X measurements.
+ * @param y The Y measurements.
+ * @param n The number of measurements.
+ * @param mean_x The average of X.
+ * @param mean_y The average of Y.
+ * @param isa The instruction set to use, which must be supported.
+ * @return Centered_Sums The compensated sums.
+ */
+Centered_Sums centered_sums(const double *x, const double *y, size_t n,
+                            double mean_x, double mean_y,
+                            Isa isa = detected_isa()) noexcept;
+
+} // namespace simd
+
+#endif
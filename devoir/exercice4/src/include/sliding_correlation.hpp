@@ -0,0 +1,85 @@
+#ifndef SLIDING_CORRELATION_HPP
+#define SLIDING_CORRELATION_HPP
+
+#include "correlation.hpp"
+#include "moments.hpp"
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Pearson correlation of the last measurements of a stream.
+ *
+ * The measurements of the window are kept in a ring buffer and their moments
+ * are updated in O(1) per measurement: the oldest one is removed and the new
+ * one added with Welford updates. Since removals let round-off errors build
+ * up, the moments are periodically recalculated from the buffer (re-anchored),
+ * which costs O(window) every period measurements.
+ */
+class Sliding_Correlation {
+public:
+  /**
+   * @brief Constructor.
+   *
+   * @param window The number of measurements of the window.
+   * @param period The number of updates between two re-anchorings; 0 means
+   * once per window.
+   * @throw std::invalid_argument If the window is empty.
+   */
+  explicit Sliding_Correlation(size_t window, size_t period = 0);
+
+  /**
+   * @brief Appends a measurement, evicting the oldest one if the window is
+   * full.
+   *
+   */
+  void append(double x, double y) noexcept;
+
+  /**
+   * @brief Appends a batch of measurements, evicting the oldest ones as
+   * needed.
+   *
+   * The moments of the batch and of the evicted measurements are calculated in
+   * parallel, then merged into and removed from the moments of the window.
+   *
+   * @param x The X measurements.
+   * @param y The Y measurements.
+   * @param batch The number of measurements.
+   */
+  void append(const double *x, const double *y, size_t batch) noexcept;
+
+  /**
+   * @brief Recalculates the moments from the measurements of the window.
+   *
+   */
+  void reanchor() noexcept;
+
+  /** Number of measurements in the window. */
+  size_t size() const noexcept { return count; }
+
+  /** Maximum number of measurements in the window. */
+  size_t window() const noexcept { return xs.size(); }
+
+  /** Moments of the measurements in the window. */
+  const Moments &moments() const noexcept { return current; }
+
+  /** Pearson correlation of the measurements in the window. */
+  Correlation correlation() const noexcept { return current.correlation(); }
+
+private:
+  /**
+   * @brief Calculates the moments of length measurements of the window,
+   * starting offset measurements after the oldest one.
+   *
+   */
+  Moments segment_moments(size_t offset, size_t length) const noexcept;
+
+  std::vector<double> xs; /** X measurements (ring buffer).       */
+  std::vector<double> ys; /** Y measurements (ring buffer).       */
+  size_t head;            /** Position of the oldest measurement. */
+  size_t count;           /** Number of measurements.             */
+  size_t period;          /** Updates between re-anchorings.      */
+  size_t updates;         /** Updates since the last one.         */
+  Moments current;        /** Moments of the window.              */
+};
+
+#endif
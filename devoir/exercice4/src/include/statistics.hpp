@@ -0,0 +1,226 @@
+#ifndef STATISTICS_HPP
+#define STATISTICS_HPP
+
+#include "correlation.hpp"
+#include "data_set.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/** Default memory budget of a quantile sketch, in bytes. */
+constexpr size_t default_sketch_budget = 16384;
+
+/**
+ * @brief Count, average, centered moments up to the fourth, minimum and
+ * maximum of a column.
+ *
+ * Moments of disjoint sets are merged with the pairwise formulas of Pébay, as
+ * Moments does up to the second.
+ */
+struct Column_Moments {
+  double n = 0.0;         /** Number of values.       */
+  double mean = 0.0;      /** Average.                */
+  double m2 = 0.0;        /** Sum of (v - mean)^2.    */
+  double m3 = 0.0;        /** Sum of (v - mean)^3.    */
+  double m4 = 0.0;        /** Sum of (v - mean)^4.    */
+  double min = INFINITY;  /** Smallest value.         */
+  double max = -INFINITY; /** Largest value.          */
+
+  /**
+   * @brief Calculates the moments of a block small enough to stay in cache,
+   * average first then centered sums, the average being taken from an origin
+   * as in Moments::of.
+   *
+   * @param values The values.
+   * @param count The number of values.
+   * @param origin The origin of the values.
+   * @return Column_Moments The moments of the block.
+   */
+  static Column_Moments of(const double *values, size_t count,
+                           double origin = 0.0) noexcept {
+    Column_Moments res;
+    if (count == 0) {
+      return res;
+    }
+
+    double sum = 0.0;
+    for (size_t i = 0; i != count; i++) {
+      sum += values[i] - origin;
+      res.min = std::min(res.min, values[i]);
+      res.max = std::max(res.max, values[i]);
+    }
+    res.n = static_cast<double>(count);
+    res.mean = sum / res.n;
+
+    for (size_t i = 0; i != count; i++) {
+      const double d = (values[i] - origin) - res.mean;
+      const double d2 = d * d;
+      res.m2 += d2;
+      res.m3 += d2 * d;
+      res.m4 += d2 * d2;
+    }
+    return res;
+  }
+
+  /**
+   * @brief Moves the origin of the values by v.
+   *
+   */
+  void shift(double v) noexcept { mean += v; }
+
+  /**
+   * @brief Adds the moments of a disjoint set of values (Pébay).
+   *
+   * @param other The moments of the other set.
+   */
+  void merge(const Column_Moments &other) noexcept {
+    if (other.n == 0.0) {
+      return;
+    }
+    if (n == 0.0) {
+      *this = other;
+      return;
+    }
+    const double total = n + other.n;
+    const double d = other.mean - mean;
+    const double d2 = d * d;
+    const double weight = n * other.n / total;
+    m4 += other.m4 +
+          d2 * d2 * weight * (n * n - n * other.n + other.n * other.n) /
+              (total * total) +
+          6.0 * d2 * (n * n * other.m2 + other.n * other.n * m2) /
+              (total * total) +
+          4.0 * d * (n * other.m3 - other.n * m3) / total;
+    m3 += other.m3 + d2 * d * weight * (n - other.n) / total +
+          3.0 * d * (n * other.m2 - other.n * m2) / total;
+    m2 += other.m2 + d2 * weight;
+    mean += d * (other.n / total);
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+    n = total;
+  }
+};
+
+/**
+ * @brief KLL sketch of the quantiles of a stream of values, mergeable, whose
+ * memory stays within a budget whatever the length of the stream.
+ *
+ * The values are kept in a hierarchy of compactors, those of level h standing
+ * for 2^h values each. Every other value of a full compactor, from a random
+ * one of the first two, moves up a level, the levels above the first staying
+ * sorted. The capacities shrink geometrically, by 2/3, from k at the top level
+ * down to 8, so a sketch retains about 3k values: k is a third of the budget,
+ * a merge borrowing at most one more level's worth.
+ *
+ * The error on the rank of a quantile is below 1.5 / k whatever the number of
+ * values, about 0.2 % with the default budget (see the exercice4_statistics
+ * benchmark).
+ */
+class Quantile_Sketch {
+public:
+  /**
+   * @brief Builds an empty sketch.
+   *
+   * @param budget Its memory budget, in bytes, of retained values.
+   * @param seed The seed of the random choices of its compactions.
+   */
+  explicit Quantile_Sketch(size_t budget = default_sketch_budget,
+                           uint64_t seed = 0);
+
+  /**
+   * @brief Adds values, without NaN.
+   *
+   */
+  void push(const double *values, size_t count);
+
+  /**
+   * @brief Adds the values of another sketch, of the same budget.
+   *
+   */
+  void merge(const Quantile_Sketch &other);
+
+  /**
+   * @brief Returns an estimate of the q-quantile of the values, a value whose
+   * rank is about q times their number, or NaN without values.
+   *
+   * @param q The probability, in [0, 1].
+   */
+  double quantile(double q) const;
+
+  /** Number of values. */
+  double n() const noexcept { return count; }
+
+private:
+  size_t top_capacity;                         /** k.                          */
+  std::vector<std::vector<double>> compactors; /** Values, level by level.     */
+  std::vector<size_t> capacities;              /** Capacities of the levels.   */
+  std::vector<double> scratch;                 /** Buffer of the merges.       */
+  size_t retained;                             /** Number of values kept.      */
+  size_t max_retained;                         /** Sum of the capacities.      */
+  double count;                                /** Number of values added.     */
+  uint64_t state;                              /** State of the random coins.  */
+
+  /** Adds a level on top. */
+  void grow();
+
+  /** Merges the sorted halves [0, middle) and [middle, end) of a level. */
+  void merge_into(std::vector<double> &sorted, size_t middle);
+
+  /** Compacts levels until the values kept fit. */
+  void compress();
+};
+
+/**
+ * @brief Descriptive statistics of a column.
+ *
+ */
+struct Column_Statistics {
+  double n;               /** Number of values.                        */
+  double mean;            /** Average.                                 */
+  double variance;        /** Unbiased variance, m2 / (n - 1).         */
+  double skewness;        /** Skewness, sqrt(n) m3 / m2^1.5.           */
+  double kurtosis;        /** Excess kurtosis, n m4 / m2^2 - 3.        */
+  double min;             /** Smallest value.                          */
+  double max;             /** Largest value.                           */
+  Quantile_Sketch sketch; /** Sketch of the quantiles.                 */
+
+  /**
+   * @brief Returns an estimate of the q-quantile, exact at 0 and 1.
+   *
+   */
+  double quantile(double q) const {
+    return q <= 0.0 ? min : q >= 1.0 ? max : sketch.quantile(q);
+  }
+};
+
+/**
+ * @brief Pearson correlation and descriptive statistics of both columns.
+ *
+ */
+struct Statistics {
+  Correlation correlation; /** Pearson correlation. */
+  Column_Statistics x;     /** Statistics of X.     */
+  Column_Statistics y;     /** Statistics of Y.     */
+};
+
+/**
+ * @brief Calculates the Pearson correlation of a data set and the average,
+ * variance, skewness, kurtosis, extremes and quantiles of its columns, in a
+ * single parallel pass.
+ *
+ * Every reducer summarises its blocks into Moments, Column_Moments and a
+ * Quantile_Sketch per column, all merged by join, so the data set is read
+ * once whatever the number of statistics. The tree of reducers depends on the
+ * number of measurements only, so the result, quantiles included, does not
+ * depend on the number of threads.
+ *
+ * @param data_set The data set, without NaN.
+ * @param sketch_budget The memory budget of each quantile sketch, in bytes.
+ * @return Statistics The statistics.
+ */
+Statistics describe(const Data_Set &data_set,
+                    size_t sketch_budget = default_sketch_budget);
+
+#endif
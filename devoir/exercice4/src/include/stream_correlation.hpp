@@ -0,0 +1,34 @@
+#ifndef STREAM_CORRELATION_HPP
+#define STREAM_CORRELATION_HPP
+
+#include "moments.hpp"
+#include <cstddef>
+
+/**
+ * @brief Size of each of the two buffers of stream_moments, by default.
+ *
+ */
+constexpr size_t default_stream_chunk = 64 * 1024 * 1024;
+
+/**
+ * @brief Calculates the moments of a data set file without loading it, so
+ * that it may be larger than the memory.
+ *
+ * The file, text or binary, is read by chunks into two buffers in turn: while
+ * the chunk in one buffer is reduced in parallel, a reader thread fills the
+ * other one with the next chunk, so the reads overlap the calculation. The
+ * moments of the chunks are merged in file order. Besides the two buffers,
+ * the memory used does not depend on the size of the file.
+ *
+ * @param filename The file name.
+ * @param chunk_bytes The size of each buffer, in bytes, at least 4 KiB. Every
+ * line of a text file must fit in it.
+ * @return Moments The moments of the data set.
+ * @throw std::system_error If the file cannot be opened or read.
+ * @throw std::runtime_error If its content is malformed.
+ * @throw std::invalid_argument If the chunk size is too small.
+ */
+Moments stream_moments(const char *filename,
+                       size_t chunk_bytes = default_stream_chunk);
+
+#endif
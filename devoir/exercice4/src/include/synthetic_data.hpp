@@ -0,0 +1,45 @@
+#ifndef SYNTHETIC_DATA_HPP
+#define SYNTHETIC_DATA_HPP
+
+#include "column_buffer.hpp"
+#include "data_set.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+/**
+ * @brief Builds a synthetic data set for the benchmarks: a noisy line, starting
+ * far from the origin so that a careless summation loses digits.
+ *
+ * @param n The number of measurements.
+ * @param origin The first X measurement.
+ * @return Data_Set The data set.
+ */
+inline Data_Set make_synthetic_data_set(size_t n, double origin = 1e6) {
+  const std::shared_ptr<Column_Buffer> columns =
+      std::make_shared<Column_Buffer>(n, 2);
+  double *const x = columns->column(0);
+  double *const y = columns->column(1);
+
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, n),
+                    [x, y, origin](const tbb::blocked_range<size_t> &r) {
+                      for (size_t i = r.begin(); i != r.end(); i++) {
+                        uint64_t z = i * 0x9e3779b97f4a7c15ULL;
+                        z = (z ^ (z >> 31)) * 0xbf58476d1ce4e5b9ULL;
+                        const double noise = (z >> 11) * 0x1.0p-53 - 0.5;
+                        x[i] = origin + i * 1e-3;
+                        y[i] = 2.0 * x[i] - 30.0 + 100.0 * noise;
+                      }
+                    });
+
+  Data_Set res;
+  res.n = n;
+  res.x = x;
+  res.y = y;
+  res.storage = columns;
+  return res;
+}
+
+#endif
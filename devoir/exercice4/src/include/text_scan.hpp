@@ -0,0 +1,114 @@
+#ifndef TEXT_SCAN_HPP
+#define TEXT_SCAN_HPP
+
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+
+/**
+ * @brief Helpers scanning the text representation of a data set, shared by
+ * the in-memory parser and the streaming reader.
+ *
+ */
+namespace text_scan {
+
+/**
+ * @brief Tells whether a character separates two values on a line.
+ *
+ */
+inline bool is_blank(char c) noexcept {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/**
+ * @brief Returns the first non blank character of [p, end), or end.
+ *
+ */
+inline const char *skip_blanks(const char *p, const char *end) noexcept {
+  while (p != end && is_blank(*p)) {
+    ++p;
+  }
+  return p;
+}
+
+/**
+ * @brief Returns the end of line starting at p: its '\n', or end.
+ *
+ */
+inline const char *line_end(const char *p, const char *end) noexcept {
+  const void *const eol = std::memchr(p, '\n', static_cast<size_t>(end - p));
+  return eol == nullptr ? end : static_cast<const char *>(eol);
+}
+
+/**
+ * @brief Returns p past a leading '+', which stream extraction accepts but
+ * std::from_chars does not, or p.
+ *
+ */
+inline const char *skip_plus(const char *p, const char *end) noexcept {
+  return p != end && *p == '+' && (p + 1 == end || p[1] != '-') ? p + 1 : p;
+}
+
+/**
+ * @brief Counts the non blank lines of a chunk.
+ *
+ */
+inline size_t count_rows(const char *begin, const char *end) noexcept {
+  size_t rows = 0;
+  for (const char *p = begin; p < end;) {
+    const char *const eol = line_end(p, end);
+    if (skip_blanks(p, eol) != eol) {
+      ++rows;
+    }
+    p = eol + 1;
+  }
+  return rows;
+}
+
+/**
+ * @brief Parses the header of a text data set: the number of measurements,
+ * alone on the first non empty line.
+ *
+ * @param n Where to write the number of measurements.
+ * @return const char* The start of the line after the header, or nullptr if
+ * the header is malformed.
+ */
+inline const char *parse_header(const char *begin, const char *end,
+                                size_t &n) noexcept {
+  const char *p = begin;
+  while (p != end && (is_blank(*p) || *p == '\n')) {
+    ++p;
+  }
+  const auto header = std::from_chars(skip_plus(p, end), end, n);
+  const char *const header_end =
+      header.ec == std::errc() ? line_end(header.ptr, end) : nullptr;
+  if (header_end == nullptr || skip_blanks(header.ptr, header_end) != header_end) {
+    return nullptr;
+  }
+  return header_end == end ? end : header_end + 1;
+}
+
+/**
+ * @brief Parses the m values of a non blank line [p, eol).
+ *
+ * @param values Where to write the first value, the next ones following it
+ * every stride values.
+ * @return bool Whether the line holds exactly m values.
+ */
+inline bool parse_row(const char *p, const char *eol, double *values, size_t m,
+                      size_t stride = 1) noexcept {
+  const char *q = skip_blanks(p, eol);
+  for (size_t c = 0; c != m; ++c) {
+    const auto parsed = std::from_chars(skip_plus(q, eol), eol, values[c * stride]);
+    if (parsed.ec != std::errc() ||
+        (parsed.ptr != eol && not is_blank(*parsed.ptr))) {
+      return false;
+    }
+    q = skip_blanks(parsed.ptr, eol);
+  }
+  return q == eol;
+}
+
+} // namespace text_scan
+
+#endif
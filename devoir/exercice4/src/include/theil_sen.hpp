@@ -0,0 +1,49 @@
+#ifndef THEIL_SEN_HPP
+#define THEIL_SEN_HPP
+
+#include "data_set.hpp"
+
+/**
+ * @brief Robust line fit.
+ *
+ */
+struct Robust_Line {
+  double a; /** Right slope.  */
+  double b; /** Y-axis shift. */
+};
+
+/**
+ * @brief Fits a line with the Theil-Sen estimator: the slope is the median of
+ * the slopes of the pairs of measurements with different x, the shift the
+ * median of the residuals y - a * x.
+ *
+ * The slopes are never materialized. Once the measurements are sorted by x,
+ * the pairs whose slope is below t are the inversions of y - t * x, counted
+ * by the parallel merge sort of sort_count_inversions. The pairs whose slope
+ * lies in [lo, hi) are the inversions of y - hi * x taken in the order of
+ * y - lo * x, so a merge sort can draw a random sample of them, or list them
+ * all. The median is selected by shrinking such an interval around it with
+ * the order statistics of a sample, until it holds few enough slopes to be
+ * listed: O(n log n) expected.
+ *
+ * @param data_set The data set, without NaN, with two different x at least.
+ * @return Robust_Line The fit.
+ * @throw std::invalid_argument If every x is the same.
+ */
+Robust_Line theil_sen(const Data_Set &data_set);
+
+/**
+ * @brief Fits a line with Siegel's repeated median estimator: the slope is the
+ * median over the measurements of the median of their slopes to the other
+ * ones, the shift the median of the residuals y - a * x.
+ *
+ * The inner medians are selected in parallel, each in a buffer of the
+ * thread, in O(n^2) operations overall.
+ *
+ * @param data_set The data set, without NaN, with two different x at least.
+ * @return Robust_Line The fit.
+ * @throw std::invalid_argument If every x is the same.
+ */
+Robust_Line repeated_median(const Data_Set &data_set);
+
+#endif
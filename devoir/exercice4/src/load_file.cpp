@@ -0,0 +1,208 @@
+#include "data_set.hpp"
+#include "binary_format.hpp"
+#include "column_buffer.hpp"
+#include "mapped_file.hpp"
+#include "text_scan.hpp"
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+/* -------------------------------------------------------------------------- */
+/*                                   helpers                                  */
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+/** Approximate size, in bytes, of the text parsed by a single task. */
+constexpr size_t chunk_size = 1024 * 1024;
+
+using namespace text_scan;
+
+/**
+ * @brief Counts the values of the first non blank line of [begin, end).
+ *
+ */
+size_t count_columns(const char *begin, const char *end) noexcept {
+  for (const char *p = begin; p < end;) {
+    const char *const eol = line_end(p, end);
+    size_t columns = 0;
+    for (const char *q = skip_blanks(p, eol); q != eol; q = skip_blanks(q, eol)) {
+      while (q != eol && not is_blank(*q)) {
+        ++q;
+      }
+      ++columns;
+    }
+    if (columns != 0) {
+      return columns;
+    }
+    p = eol + 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Parses the rows of m values of a chunk into the columns of a
+ * column-major array, stride apart, starting at row first and ignoring the
+ * rows at or past n.
+ *
+ * @return const char* The first malformed line, or nullptr.
+ */
+const char *parse_rows(const char *begin, const char *end, double *values,
+                       size_t m, size_t stride, size_t first,
+                       size_t n) noexcept {
+  size_t row = first;
+  for (const char *p = begin; p < end && row < n;) {
+    const char *const eol = line_end(p, end);
+    if (skip_blanks(p, eol) != eol) {
+      if (not parse_row(p, eol, values + row, m, stride)) {
+        return p;
+      }
+      ++row;
+    }
+    p = eol + 1;
+  }
+  return nullptr;
+}
+
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/*                                parse_columns                               */
+/* -------------------------------------------------------------------------- */
+
+Column_Set parse_columns(const char *begin, const char *end) {
+  Column_Set res;
+
+  // Header: the number of measurements, alone on the first line.
+  const char *const body = parse_header(begin, end, res.n);
+  if (body == nullptr) {
+    throw std::runtime_error("malformed header: expected the number of measurements");
+  }
+  const size_t m = count_columns(body, end);
+
+  // Chunk boundaries, moved forward to the start of the next line.
+  const size_t length = static_cast<size_t>(end - body);
+  const size_t chunks = length / chunk_size + 1;
+  std::vector<const char *> bounds(chunks + 1);
+  bounds[0] = body;
+  for (size_t c = 1; c != chunks; ++c) {
+    const char *const nominal = body + length / chunks * c;
+    const char *const start = nominal < bounds[c - 1] ? bounds[c - 1] : nominal;
+    const char *const eol = line_end(start, end);
+    bounds[c] = eol == end ? end : eol + 1;
+  }
+  bounds[chunks] = end;
+
+  // Rows per chunk, then their prefix sum gives where each chunk writes.
+  std::vector<size_t> offsets(chunks + 1, 0);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, chunks),
+                    [&](const tbb::blocked_range<size_t> &r) {
+                      for (size_t c = r.begin(); c != r.end(); ++c) {
+                        offsets[c + 1] = count_rows(bounds[c], bounds[c + 1]);
+                      }
+                    });
+  for (size_t c = 0; c != chunks; ++c) {
+    offsets[c + 1] += offsets[c];
+  }
+  if (offsets[chunks] < res.n) {
+    throw std::runtime_error("expected " + std::to_string(res.n) +
+                             " measurements, found " +
+                             std::to_string(offsets[chunks]));
+  }
+
+  // All the columns in one buffer, owned by the column set.
+  const std::shared_ptr<Column_Buffer> values =
+      std::make_shared<Column_Buffer>(res.n, m);
+
+  // Parses every chunk, remembering its first malformed line if any.
+  std::vector<const char *> errors(chunks, nullptr);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, chunks),
+                    [&](const tbb::blocked_range<size_t> &r) {
+                      for (size_t c = r.begin(); c != r.end(); ++c) {
+                        errors[c] = parse_rows(bounds[c], bounds[c + 1],
+                                               values->column(0), m,
+                                               values->stride(), offsets[c],
+                                               res.n);
+                      }
+                    });
+  for (const char *const error : errors) {
+    if (error != nullptr) {
+      throw std::runtime_error(
+          "malformed measurement: \"" +
+          std::string(error, line_end(error, end)) + '"');
+    }
+  }
+
+  for (size_t c = 0; c != m; ++c) {
+    res.columns.push_back(values->column(c));
+  }
+  res.storage = values;
+  return res;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 parse_text                                 */
+/* -------------------------------------------------------------------------- */
+
+Data_Set parse_text(const char *begin, const char *end) {
+  return to_data_set(parse_columns(begin, end));
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 to_data_set                                */
+/* -------------------------------------------------------------------------- */
+
+Data_Set to_data_set(const Column_Set &column_set) {
+  if (column_set.m() != 2 and not(column_set.n == 0 and column_set.m() == 0)) {
+    throw std::runtime_error("expected 2 columns, found " +
+                             std::to_string(column_set.m()));
+  }
+
+  Data_Set res;
+  res.n = column_set.n;
+  res.x = column_set.m() == 2 ? column_set.columns[0] : nullptr;
+  res.y = column_set.m() == 2 ? column_set.columns[1] : nullptr;
+  res.storage = column_set.storage;
+  return res;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  load_file                                 */
+/* -------------------------------------------------------------------------- */
+
+Data_Set load_file(const char *filename, bool verify) {
+  return load_mapped(Mapped_File(filename), verify);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 load_mapped                                */
+/* -------------------------------------------------------------------------- */
+
+Data_Set load_mapped(Mapped_File &&file, bool verify) {
+  if (is_binary(file.data(), file.size())) {
+    return load_binary(std::move(file), verify);
+  }
+  return parse_text(file.data(), file.data() + file.size());
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                load_columns                                */
+/* -------------------------------------------------------------------------- */
+
+Column_Set load_columns(const char *filename) {
+  Mapped_File file(filename);
+  if (is_binary(file.data(), file.size())) {
+    const Data_Set data_set = load_binary(std::move(file));
+
+    Column_Set res;
+    res.n = data_set.n;
+    res.columns = {data_set.x, data_set.y};
+    res.storage = data_set.storage;
+    return res;
+  }
+  return parse_columns(file.data(), file.data() + file.size());
+}
@@ -0,0 +1,120 @@
+#include "cpp_argv.hpp"
+#include "correlation.hpp"
+#include "correlation_matrix.hpp"
+#include "data_set.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <tbb/blocked_range.h>
+#include <tbb/global_control.h>
+#include <tbb/parallel_for.h>
+
+#define DEFAULT_NAME "exercice4_matrix"
+
+/**
+ * @brief Builds a synthetic column set: every column is one of three latent
+ * signals plus noise, so that the coefficients spread over [-1, 1].
+ *
+ * @param n The number of measurements.
+ * @param m The number of columns.
+ * @return Column_Set The column set.
+ */
+static Column_Set make_column_set(size_t n, size_t m) {
+  const std::shared_ptr<double[]> values(new double[m * n]);
+
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, m * n),
+                    [&](const tbb::blocked_range<size_t> &r) {
+                      for (size_t k = r.begin(); k != r.end(); k++) {
+                        const size_t j = k / n, i = k % n;
+                        uint64_t z = k * 0x9e3779b97f4a7c15ULL;
+                        z = (z ^ (z >> 31)) * 0xbf58476d1ce4e5b9ULL;
+                        const double noise = (z >> 11) * 0x1.0p-53 - 0.5;
+                        const double signal = std::sin(i * 1e-3 * (j % 3 + 1));
+                        values[k] = (j % 2 ? -1.0 : 1.0) * signal +
+                                    noise * (j % 5 + 1) * 0.2 + j;
+                      }
+                    });
+
+  Column_Set res;
+  res.n = n;
+  for (size_t j = 0; j != m; j++) {
+    res.columns.push_back(values.get() + j * n);
+  }
+  res.storage = values;
+  return res;
+}
+
+/**
+ * @brief Compares the blocked correlation matrix with the two-column
+ * calculation repeated for every pair of columns.
+ *
+ * @param argc number of arguments in the command line.
+ * @param argv arguments of the command line.
+ * @return @c EXIT_SUCCESS if command succeeds else @c EXIT_FAILURE.
+ */
+int main(int argc, char *argv[]) {
+
+  // User expects help.
+  CPP_ARGV_TEST_HELP_REQUEST(argc, argv[0], DEFAULT_NAME, "size columns")
+
+  // Bad argument number.
+  CPP_ARGV_TEST_ARG_NUM(argc, 3)
+
+  // Retrieves the number of measurements and of columns.
+  size_t n, m;
+  {
+    std::istringstream size_arg(argv[1]), columns_arg(argv[2]);
+    size_arg >> n;
+    columns_arg >> m;
+    if (not size_arg or not columns_arg or n < 2 or m == 0) {
+      std::cerr << "Bad argument" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  const Column_Set column_set = make_column_set(n, m);
+
+  // Blocked matrix.
+  auto start = std::chrono::steady_clock::now();
+  const std::vector<double> matrix = correlation_matrix(column_set);
+  auto stop = std::chrono::steady_clock::now();
+  const double blocked = std::chrono::duration<double>(stop - start).count();
+
+  // Two-column path, once per pair.
+  double max_error = 0.0;
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i != m; i++) {
+    for (size_t j = i + 1; j != m; j++) {
+      Data_Set pair;
+      pair.n = n;
+      pair.x = column_set.columns[i];
+      pair.y = column_set.columns[j];
+      const double r = calculate(pair).r;
+      max_error = std::max(max_error, std::fabs(r - matrix[i * m + j]));
+    }
+  }
+  stop = std::chrono::steady_clock::now();
+  const double pairwise = std::chrono::duration<double>(stop - start).count();
+
+  // One multiply-add per pair of columns and measurement.
+  const double gigaflops = m * (m + 1) / 2.0 * n * 2.0 / 1e9;
+  std::cout << "Thread(s):\t"
+            << tbb::global_control::active_value(
+                   tbb::global_control::max_allowed_parallelism)
+            << std::endl;
+  std::cout << "Matrix:\t\t" << m << " x " << m << ", " << n << " rows"
+            << std::endl;
+  std::cout << "blocked:\t" << blocked << " s\t" << gigaflops / blocked
+            << " GFLOP/s" << std::endl;
+  std::cout << "pairwise:\t" << pairwise << " s" << std::endl;
+  std::cout << "Speedup:\t" << pairwise / blocked << std::endl;
+  std::cout << "max |delta r|:\t" << max_error << std::endl;
+
+  // It's over.
+  return EXIT_SUCCESS;
+}
@@ -1,203 +1,657 @@
 #include "cpp_argv.hpp"
-#include <cmath>
+#include "batch.hpp"
+#include "bootstrap.hpp"
+#include "correlation.hpp"
+#include "correlation_matrix.hpp"
+#include "cross_correlation.hpp"
+#include "data_set.hpp"
+#include "grouped_correlation.hpp"
+#include "permutation_test.hpp"
+#include "prefix_index.hpp"
+#include "progressive_correlation.hpp"
+#include "rank_correlation.hpp"
+#include "regression.hpp"
+#include "sliding_correlation.hpp"
+#include "statistics.hpp"
+#include "stream_correlation.hpp"
+#include "theil_sen.hpp"
+#include <chrono>
 #include <cstdlib>
 #include <cstring>
-#include <fstream>
+#include <exception>
+#include <filesystem>
 #include <iostream>
-#include <tbb/parallel_reduce.h>
-#include <tbb/blocked_range.h>
+#include <sstream>
+#include <utility>
+#include <vector>
+#include <tbb/parallel_for.h>
 
 #define DEFAULT_NAME "pearson"
 
 /**
- * @brief Data measurement set.
+ * @brief Reads measurements from the standard input, one "x y" pair per line,
+ * and prints the correlation of the last ones after each of them.
  *
+ * @param window_arg The window size argument.
+ * @return @c EXIT_SUCCESS if command succeeds else @c EXIT_FAILURE.
  */
-struct Data_Set {
-  size_t n;  /** Number of measurements.  */
-  double *x; /** Variable X measurements. */
-  double *y; /** Variable Y measurements. */
-};
+static int run_window(const char *window_arg) {
+  size_t window;
+  std::istringstream stream(window_arg);
+  if (not(stream >> window) or not stream.eof() or window == 0) {
+    std::cerr << "Bad window size" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  Sliding_Correlation sliding(window);
+  double x, y;
+  while (std::cin >> x >> y) {
+    sliding.append(x, y);
+    const Correlation result = sliding.correlation();
+    std::cout << "a: " << result.a << "\tb: " << result.b
+              << "\tr: " << result.r << std::endl;
+  }
+
+  if (not std::cin.eof()) {
+    std::cerr << "Bad measurement" << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
 
 /**
- * @brief Pearson correlation.
+ * @brief Loads a file of m columns and prints the m x m matrix of their
+ * Pearson coefficients, one row per line.
  *
+ * @param filename The file name.
+ * @return @c EXIT_SUCCESS if command succeeds else @c EXIT_FAILURE.
  */
-struct Correlation {
-  double a; /** Right slope.         */
-  double b; /** Y-axis shift.        */
-  double r; /** Pearson coefficient. */
-};
+static int run_matrix(const char *filename) {
+  try {
+    const Column_Set column_set = load_columns(filename);
+    const std::vector<double> matrix = correlation_matrix(column_set);
+
+    const size_t m = column_set.m();
+    for (size_t i = 0; i != m; i++) {
+      for (size_t j = 0; j != m; j++) {
+        std::cout << (j == 0 ? "" : "\t") << matrix[i * m + j];
+      }
+      std::cout << '\n';
+    }
+    std::cout << std::flush;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
 
 /**
- * @brief Loads a data set from a input stream then returns it.
+ * @brief Loads a data set and prints its rank correlation coefficients.
  *
- * @param stream The input stream.
- * @return Data_Set The data set.
+ * @param filename The file name.
+ * @return @c EXIT_SUCCESS if command succeeds else @c EXIT_FAILURE.
  */
-Data_Set load_file(std::istream &stream) noexcept;
+static int run_rank(const char *filename) {
+  try {
+    const Data_Set data_set = load_file(filename);
+    std::cout << "spearman: " << spearman(data_set)
+              << "\tkendall: " << kendall_tau_b(data_set) << std::endl;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
 
 /**
- * @brief Calculates then returns the Pearson correlation of a data set.
+ * @brief Calculates the Pearson correlation of every file of a directory or a
+ * file list, then reports the aggregate throughput.
  *
- * @param data_set The data set.
- * @return Correlation The corresponding Pearson correlation.
+ * @param path The directory or the file list.
+ * @return @c EXIT_SUCCESS if every file succeeds else @c EXIT_FAILURE.
  */
-Correlation calculate(const Data_Set &data_set) noexcept;
+static int run_batch(const char *path) {
+  try {
+    const Batch_Summary summary =
+        correlate_files(list_batch(path), std::cout, std::cerr);
+
+    const double megabytes = summary.bytes / 1e6;
+    std::clog << "batch: " << summary.files << " files ("
+              << summary.failures << " failed), " << megabytes << " MB in "
+              << summary.seconds << " s (" << summary.files / summary.seconds
+              << " files/s, " << megabytes / summary.seconds << " MB/s)"
+              << std::endl;
+    return summary.failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
 
 /**
- * @brief Main program.
+ * @brief Loads a data set, indexes it, then reads ranges "first last" from the
+ * standard input, one per line, and prints the correlation of the
+ * measurements [first, last) of each of them.
  *
- * @param argc number of arguments in the command line.
- * @param argv arguments of the command line.
+ * The ranges are answered in parallel, by batches, and printed in order.
+ *
+ * @param filename The file name.
  * @return @c EXIT_SUCCESS if command succeeds else @c EXIT_FAILURE.
  */
-int main(int argc, char *argv[]) {
+static int run_query(const char *filename) {
+  Data_Set data_set;
+  try {
+    data_set = load_file(filename);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  const Prefix_Index index(data_set);
+
+  const size_t batch = 4096;
+  std::vector<std::pair<size_t, size_t>> ranges;
+  std::vector<Correlation> results;
+  bool valid = true;
+
+  for (bool more = true; more;) {
+    ranges.clear();
+    size_t first, last;
+    while (ranges.size() != batch and (more = bool(std::cin >> first >> last))) {
+      ranges.emplace_back(first, last);
+    }
 
-  // User expects help.
-  CPP_ARGV_TEST_HELP_REQUEST(argc, argv[0], DEFAULT_NAME, "filename")
+    const auto in_range = [&](size_t q) {
+      return ranges[q].first < ranges[q].second and
+             ranges[q].second <= index.size();
+    };
 
-  // Bad argument number.
-  CPP_ARGV_TEST_ARG_NUM(argc, 2)
+    results.resize(ranges.size());
+    tbb::parallel_for(size_t(0), ranges.size(), [&](size_t q) {
+      if (in_range(q)) {
+        results[q] = index.correlation(ranges[q].first, ranges[q].second);
+      }
+    });
 
-  // Retrieves the data filename.
-  const char *const filename = argv[1];
+    for (size_t q = 0; q != ranges.size(); q++) {
+      if (not in_range(q)) {
+        std::cout << "bad range\n";
+        valid = false;
+        continue;
+      }
+      std::cout << "a: " << results[q].a << "\tb: " << results[q].b
+                << "\tr: " << results[q].r << '\n';
+    }
+    std::cout << std::flush;
+  }
 
-  // Tries to open it.
-  std::ifstream stream(filename);
-  if (not stream) {
-    std::cerr << std::strerror(errno) << std::endl;
+  if (not std::cin.eof()) {
+    std::cerr << "Bad range" << std::endl;
     return EXIT_FAILURE;
   }
+  return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @brief Calculates the Pearson correlation of a file read by chunks, without
+ * loading it, then reports the throughput.
+ *
+ * @param filename The file name.
+ * @param chunk_arg The size of each of the two buffers, in MiB, or nullptr
+ * for the default one.
+ * @return @c EXIT_SUCCESS if command succeeds else @c EXIT_FAILURE.
+ */
+static int run_stream(const char *filename, const char *chunk_arg) {
+  size_t chunk_bytes = default_stream_chunk;
+  if (chunk_arg != nullptr) {
+    size_t megabytes;
+    std::istringstream stream(chunk_arg);
+    if (not(stream >> megabytes) or not stream.eof() or megabytes == 0) {
+      std::cerr << "Bad chunk size" << std::endl;
+      return EXIT_FAILURE;
+    }
+    chunk_bytes = megabytes * 1024 * 1024;
+  }
 
-  // Loads the data set.
-  const Data_Set data_set = load_file(stream);
+  try {
+    const auto start = std::chrono::steady_clock::now();
+    const Correlation result = stream_moments(filename, chunk_bytes).correlation();
+    const auto stop = std::chrono::steady_clock::now();
+
+    const double seconds = std::chrono::duration<double>(stop - start).count();
+    const double megabytes = std::filesystem::file_size(filename) / 1e6;
+    std::clog << "stream: " << megabytes << " MB in " << seconds << " s ("
+              << megabytes / seconds << " MB/s, 2 x "
+              << chunk_bytes / (1024 * 1024) << " MiB buffers)" << std::endl;
+
+    std::cout << "a: " << result.a << "\tb: " << result.b
+              << "\tr: " << result.r << std::endl;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
 
-  // Calculates the corresponding Pearson correlation.
-  const Correlation result = calculate(data_set);
+/**
+ * @brief Loads a data set and prints its Pearson correlation, calculated over
+ * a fixed tree of chunks so that the output is the same on any machine
+ * running this build, whatever its number of cores.
+ *
+ * @param filename The file name.
+ * @return @c EXIT_SUCCESS if command succeeds else @c EXIT_FAILURE.
+ */
+static int run_deterministic(const char *filename) {
+  try {
+    const Correlation result = calculate_deterministic(load_file(filename));
+    std::cout << "a: " << result.a << "\tb: " << result.b
+              << "\tr: " << result.r << std::endl;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
 
-  // Prints results onto the standard output.
-  std::cout << "a: " << result.a << "\tb: " << result.b << "\tr: " << result.r
-            << std::endl;
+/**
+ * @brief Loads a data set and prints the 95% bootstrap confidence intervals,
+ * percentile and BCa, of the slope, the shift and the Pearson coefficient.
+ *
+ * @param filename The file name.
+ * @param resamples_arg The number of resamples, or nullptr for 10000.
+ * @return @c EXIT_SUCCESS if command succeeds else @c EXIT_FAILURE.
+ */
+static int run_bootstrap(const char *filename, const char *resamples_arg) {
+  size_t resamples = 10000;
+  if (resamples_arg != nullptr) {
+    std::istringstream stream(resamples_arg);
+    if (not(stream >> resamples) or not stream.eof()) {
+      std::cerr << "Bad number of resamples" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
 
-  // It's over.
+  try {
+    const Bootstrap_Result result = bootstrap(load_file(filename), resamples);
+
+    const auto print = [](const char *name, double estimate,
+                          const Bootstrap_Intervals &intervals) {
+      std::cout << name << ": " << estimate << "\tpercentile: ["
+                << intervals.percentile.low << ", "
+                << intervals.percentile.high << "]\tbca: ["
+                << intervals.bca.low << ", " << intervals.bca.high << "]\n";
+    };
+    print("a", result.estimate.a, result.a);
+    print("b", result.estimate.b, result.b);
+    print("r", result.estimate.r, result.r);
+    std::cout << std::flush;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
   return EXIT_SUCCESS;
 }
 
-/* -------------------------------------------------------------------------- */
-/*                                  load_file                                 */
-/* -------------------------------------------------------------------------- */
+/**
+ * @brief Loads a data set and prints the two-sided p-value of its Pearson
+ * coefficient, estimated by a permutation test.
+ *
+ * @param filename The file name.
+ * @param permutations_arg The largest number of permutations, or nullptr for
+ * a million.
+ * @param precision_arg The standard error of the p-value at which to stop, 0
+ * to draw every permutation, or nullptr for 0.001.
+ * @return @c EXIT_SUCCESS if command succeeds else @c EXIT_FAILURE.
+ */
+static int run_permutation(const char *filename, const char *permutations_arg,
+                           const char *precision_arg) {
+  size_t permutations = 1000000;
+  double precision = 0.001;
+  if (permutations_arg != nullptr) {
+    std::istringstream stream(permutations_arg);
+    if (not(stream >> permutations) or not stream.eof()) {
+      std::cerr << "Bad number of permutations" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if (precision_arg != nullptr) {
+    std::istringstream stream(precision_arg);
+    if (not(stream >> precision) or not stream.eof() or precision < 0.0) {
+      std::cerr << "Bad precision" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
 
-Data_Set load_file(std::istream &stream) noexcept {
-  Data_Set res;
+  try {
+    const Permutation_Result result =
+        permutation_test(load_file(filename), permutations, precision);
+    std::cout << "r: " << result.r << "\tp: " << result.p_value
+              << "\terror: " << result.error
+              << "\tpermutations: " << result.permutations << std::endl;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
 
-  stream >> res.n;
-  res.x = new double[res.n];
-  res.y = new double[res.n];
+/**
+ * @brief Loads a data set and prints estimates of its Pearson correlation,
+ * with confidence bounds of r, from a growing random sample of it.
+ *
+ * @param filename The file name.
+ * @param args The half-width of the bounds at which to stop, the time budget
+ * and the time between two reports, in seconds, each one optional (nullptr):
+ * 0.001, 1 and 0.1 by default.
+ * @return @c EXIT_SUCCESS if command succeeds else @c EXIT_FAILURE.
+ */
+static int run_progressive(const char *filename, const char *const args[3]) {
+  Progressive_Options options;
+  double *const settings[3] = {&options.precision, &options.budget,
+                               &options.cadence};
+  for (size_t k = 0; k != 3; k++) {
+    if (args[k] != nullptr) {
+      std::istringstream stream(args[k]);
+      if (not(stream >> *settings[k]) or not stream.eof() or
+          *settings[k] < 0.0) {
+        std::cerr << "Bad argument: " << args[k] << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
 
-  for (size_t i = 0; i < res.n; i++) {
-    stream >> res.x[i] >> res.y[i];
+  try {
+    const Data_Set data_set = load_file(filename);
+    progressive_correlation(data_set, options, [](const Progress &progress) {
+      std::cout << "r: " << progress.estimate.r << "\tlow: " << progress.low
+                << "\thigh: " << progress.high
+                << "\tsampled: " << progress.fraction
+                << "\ttime: " << progress.seconds << std::endl;
+    });
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
   }
+  return EXIT_SUCCESS;
+}
 
-  return res;
+/**
+ * @brief Loads a file of m columns, fits the last one on the others by
+ * ordinary least squares, and prints the coefficients, the intercept b0
+ * first, with their standard errors, then R^2.
+ *
+ * @param filename The file name.
+ * @return @c EXIT_SUCCESS if command succeeds else @c EXIT_FAILURE.
+ */
+static int run_regression(const char *filename) {
+  try {
+    const Regression result = linear_regression(load_columns(filename));
+    for (size_t j = 0; j != result.coefficients.size(); j++) {
+      std::cout << 'b' << j << ": " << result.coefficients[j]
+                << "\tse: " << result.errors[j] << '\n';
+    }
+    std::cout << "r2: " << result.r2 << "\trank: " << result.rank
+              << "\tsolver: " << (result.cholesky ? "cholesky" : "qr")
+              << std::endl;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
 }
 
-/* -------------------------------------------------------------------------- */
-/*                                  calculate                                 */
-/* -------------------------------------------------------------------------- */
+/**
+ * @brief Loads a data set then prints the Pearson coefficient of x against y
+ * shifted by every lag up to a bound, then the lag of the largest |r|.
+ *
+ * @param filename The data filename.
+ * @param lag_arg The largest lag argument.
+ * @return @c EXIT_SUCCESS if command succeeds else @c EXIT_FAILURE.
+ */
+static int run_cross(const char *filename, const char *lag_arg) {
+  size_t max_lag;
+  {
+    std::istringstream stream(lag_arg);
+    if (not(stream >> max_lag) or not stream.eof()) {
+      std::cerr << "Bad lag" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
 
-class AverageReducer {
-  public:
-    const double* x;
-    const double* y;
-    double sum_x, sum_y;
-    size_t n;
+  try {
+    const Cross_Correlation result =
+        cross_correlation(load_file(filename), max_lag);
+    const long lags = static_cast<long>(max_lag);
+    for (long k = -lags; k <= lags; k++) {
+      std::cout << k << '\t' << result.r[k + lags] << '\n';
+    }
+    std::cout << "peak: " << result.peak
+              << "\tr: " << result.r[result.peak + lags] << std::endl;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
 
-    AverageReducer (const double* x, const double* y) : x(x), y(y), sum_x(0.0), sum_y(0.0) {}
+/**
+ * @brief Loads a file of three columns, the key, x and y, then prints the
+ * Pearson correlation of every group of measurements sharing a key.
+ *
+ * @param filename The data filename.
+ * @return @c EXIT_SUCCESS if command succeeds else @c EXIT_FAILURE.
+ */
+static int run_group(const char *filename) {
+  try {
+    const std::vector<Group> groups =
+        grouped_correlation(load_columns(filename));
+    for (const Group &group : groups) {
+      std::cout << group.key << "\tn: " << group.n
+                << "\ta: " << group.correlation.a
+                << "\tb: " << group.correlation.b
+                << "\tr: " << group.correlation.r << '\n';
+    }
+    std::clog << "groups: " << groups.size() << std::endl;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
 
-    AverageReducer (const AverageReducer& other, tbb::split) : x(other.x), y(other.y), sum_x(0.0), sum_y(0.0) {}
+/**
+ * @brief Loads a data set then prints the line fitted by a robust estimator.
+ *
+ * @param filename The data filename.
+ * @param fit The estimator, theil_sen or repeated_median.
+ * @return @c EXIT_SUCCESS if command succeeds else @c EXIT_FAILURE.
+ */
+static int run_robust(const char *filename,
+                      Robust_Line (*fit)(const Data_Set &)) {
+  try {
+    const Robust_Line line = fit(load_file(filename));
+    std::cout << "a: " << line.a << "\tb: " << line.b << std::endl;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
 
-    void operator() (const tbb::blocked_range<size_t>& r) {
-      for (size_t i = r.begin(); i != r.end(); i ++) {
-        sum_x += x[i];
-        sum_y += y[i];
+/**
+ * @brief Loads a data set then prints its Pearson correlation and the
+ * descriptive statistics of both columns, all from a single pass.
+ *
+ * @param filename The data filename.
+ * @return @c EXIT_SUCCESS if command succeeds else @c EXIT_FAILURE.
+ */
+static int run_statistics(const char *filename) {
+  static const double probabilities[] = {0.01, 0.25, 0.5, 0.75, 0.99};
+  try {
+    const Statistics statistics = describe(load_file(filename));
+    std::cout << "a: " << statistics.correlation.a
+              << "\tb: " << statistics.correlation.b
+              << "\tr: " << statistics.correlation.r << '\n';
+    std::cout << "column\tn\tmean\tvariance\tskewness\tkurtosis\tmin";
+    for (const double q : probabilities) {
+      std::cout << '\t' << 100.0 * q << '%';
+    }
+    std::cout << "\tmax\n";
+    for (const auto &column : {std::make_pair("x", &statistics.x),
+                               std::make_pair("y", &statistics.y)}) {
+      const Column_Statistics &c = *column.second;
+      std::cout << column.first << '\t' << c.n << '\t' << c.mean << '\t'
+                << c.variance << '\t' << c.skewness << '\t' << c.kurtosis
+                << '\t' << c.min;
+      for (const double q : probabilities) {
+        std::cout << '\t' << c.quantile(q);
       }
+      std::cout << '\t' << c.max << '\n';
     }
+    std::cout << std::flush;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
 
-    void join (const AverageReducer& other) {
-      sum_x += other.sum_x;
-      sum_y += other.sum_y;
-    }
-};
+/**
+ * @brief Main program.
+ *
+ * @param argc number of arguments in the command line.
+ * @param argv arguments of the command line.
+ * @return @c EXIT_SUCCESS if command succeeds else @c EXIT_FAILURE.
+ */
+int main(int argc, char *argv[]) {
+
+  // User expects help.
+  CPP_ARGV_TEST_HELP_REQUEST(argc, argv[0], DEFAULT_NAME,
+                             "filename | --window size | --matrix filename | "
+                             "--rank filename | --batch directory_or_list | "
+                             "--query filename | "
+                             "--stream filename [chunk_megabytes] | "
+                             "--deterministic filename | "
+                             "--bootstrap filename [resamples] | "
+                             "--permutation filename [permutations "
+                             "[precision]] | --regression filename | "
+                             "--theil-sen filename | --siegel filename | "
+                             "--group filename | --progressive filename "
+                             "[precision [budget [cadence]]] | "
+                             "--cross filename max_lag | "
+                             "--statistics filename")
+
+  // Sliding window over the standard input.
+  if (argc == 3 and std::strcmp(argv[1], "--window") == 0) {
+    return run_window(argv[2]);
+  }
+
+  // Correlation matrix of a multi-column file.
+  if (argc == 3 and std::strcmp(argv[1], "--matrix") == 0) {
+    return run_matrix(argv[2]);
+  }
+
+  // Rank correlations.
+  if (argc == 3 and std::strcmp(argv[1], "--rank") == 0) {
+    return run_rank(argv[2]);
+  }
 
+  // Many files at once.
+  if (argc == 3 and std::strcmp(argv[1], "--batch") == 0) {
+    return run_batch(argv[2]);
+  }
 
-class PearsonReducer {
-  public:
-    const double* x;
-    const double* y;
-    double avg_x, avg_y;
-    double tot_xx, tot_xy, tot_yy;
+  // Correlation of ranges read from the standard input.
+  if (argc == 3 and std::strcmp(argv[1], "--query") == 0) {
+    return run_query(argv[2]);
+  }
 
-    PearsonReducer (const double* x, const double* y, double avg_x, double avg_y) : x(x), y(y), avg_x(avg_x), avg_y(avg_y), tot_xx(0.0), tot_xy(0.0), tot_yy(0.0) {}
+  // File read by chunks, larger than the memory.
+  if ((argc == 3 or argc == 4) and std::strcmp(argv[1], "--stream") == 0) {
+    return run_stream(argv[2], argc == 4 ? argv[3] : nullptr);
+  }
 
-    PearsonReducer (const PearsonReducer& other, tbb::split) : x(other.x), y(other.y), avg_x(other.avg_x), avg_y(other.avg_y), tot_xx(0.0), tot_xy(0.0), tot_yy(0.0) {}
+  // Reproducible on any number of threads.
+  if (argc == 3 and std::strcmp(argv[1], "--deterministic") == 0) {
+    return run_deterministic(argv[2]);
+  }
 
-    void operator() (const tbb::blocked_range<size_t>& r) {
-      for (size_t i = r.begin(); i != r.end(); i ++) {
-        const double dx = x[i] - avg_x;
-        const double dy = y[i] - avg_y;
-        tot_xx += dx * dx;
-        tot_xy += dx * dy;
-        tot_yy += dy * dy;
+  // Confidence intervals.
+  if ((argc == 3 or argc == 4) and std::strcmp(argv[1], "--bootstrap") == 0) {
+    return run_bootstrap(argv[2], argc == 4 ? argv[3] : nullptr);
+  }
 
-      }
-    }
+  // Significance.
+  if (argc >= 3 and argc <= 5 and std::strcmp(argv[1], "--permutation") == 0) {
+    return run_permutation(argv[2], argc >= 4 ? argv[3] : nullptr,
+                           argc == 5 ? argv[4] : nullptr);
+  }
 
-    void join (const PearsonReducer& other) {
-      tot_xx += other.tot_xx;
-      tot_xy += other.tot_xy;
-      tot_yy += other.tot_yy;
-    }
-};
+  // Several predictors.
+  if (argc == 3 and std::strcmp(argv[1], "--regression") == 0) {
+    return run_regression(argv[2]);
+  }
+
+  // Robust line fits, insensitive to a few outliers.
+  if (argc == 3 and std::strcmp(argv[1], "--theil-sen") == 0) {
+    return run_robust(argv[2], theil_sen);
+  }
+  if (argc == 3 and std::strcmp(argv[1], "--siegel") == 0) {
+    return run_robust(argv[2], repeated_median);
+  }
 
-Correlation calculate(const Data_Set &data_set) noexcept {
+  // One correlation per key of a three-column file.
+  if (argc == 3 and std::strcmp(argv[1], "--group") == 0) {
+    return run_group(argv[2]);
+  }
 
-  AverageReducer avg_reducer(data_set.x, data_set.y);
-  tbb::parallel_reduce(tbb::blocked_range<size_t>(0, data_set.n), avg_reducer);
+  // Refined estimates from a growing sample.
+  if (argc >= 3 and argc <= 6 and std::strcmp(argv[1], "--progressive") == 0) {
+    const char *const args[3] = {argc >= 4 ? argv[3] : nullptr,
+                                 argc >= 5 ? argv[4] : nullptr,
+                                 argc == 6 ? argv[5] : nullptr};
+    return run_progressive(argv[2], args);
+  }
 
-  const double moy_x = avg_reducer.sum_x / data_set.n;
-  const double moy_y = avg_reducer.sum_y / data_set.n;
+  // Correlation at every lag up to a bound.
+  if (argc == 4 and std::strcmp(argv[1], "--cross") == 0) {
+    return run_cross(argv[2], argv[3]);
+  }
 
-  PearsonReducer pearson_reducer(data_set.x, data_set.y, moy_x, moy_y);
-  tbb::parallel_reduce(tbb::blocked_range<size_t>(0, data_set.n), pearson_reducer);
+  // Descriptive statistics of both columns.
+  if (argc == 3 and std::strcmp(argv[1], "--statistics") == 0) {
+    return run_statistics(argv[2]);
+  }
 
-  Correlation res;
-  res.a = pearson_reducer.tot_xy / pearson_reducer.tot_xx;
-  res.b = moy_y - res.a * moy_x;
-  res.r = pearson_reducer.tot_xy / std::sqrt(pearson_reducer.tot_xx * pearson_reducer.tot_yy);
+  // Bad argument number.
+  CPP_ARGV_TEST_ARG_NUM(argc, 2)
 
-  return res;
-}
+  // Retrieves the data filename.
+  const char *const filename = argv[1];
+
+  // Loads the data set and reports the load throughput.
+  Data_Set data_set{};
+  try {
+    const auto start = std::chrono::steady_clock::now();
+    data_set = load_file(filename);
+    const auto stop = std::chrono::steady_clock::now();
+
+    const double seconds = std::chrono::duration<double>(stop - start).count();
+    const double megabytes = std::filesystem::file_size(filename) / 1e6;
+    std::clog << "load: " << megabytes << " MB in " << seconds << " s ("
+              << megabytes / seconds << " MB/s)" << std::endl;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
 
-// Correlation calculate (const Data_Set &data_set) noexcept {
-//   double tot_x = 0.0, tot_y = 0.0;
-//   for (size_t i = 0; i != data_set.n; i ++) {
-//     tot_x += data_set.x[i];
-//     tot_y += data_set.y[i];
-//   }
-//   const double moy_x = tot_x / data_set.n, moy_y = tot_y / data_set.n;
-  
-//   double tot_xx = 0.0, tot_xy = 0.0, tot_yy = 0.0;
-//   for (size_t i = 0; i != data_set.n; i ++) {
-//     tot_xy += (data_set.x[i] - moy_x) * (data_set.y[i] - moy_y);
-//     tot_xx += (data_set.x[i] - moy_x) * (data_set.x[i] - moy_x);
-//     tot_yy += (data_set.y[i] - moy_y) * (data_set.y[i] - moy_x);
-//   }
+  // Calculates the corresponding Pearson correlation.
+  const Correlation result = calculate(data_set);
 
-//   Correlation res;
-//   res.a = tot_xy / tot_xx;
-//   res.b = moy_y - res.a * moy_x;
-//   res.r = tot_xy / std::sqrt(tot_xx * tot_yy);
+  // Prints results onto the standard output.
+  std::cout << "a: " << result.a << "\tb: " << result.b << "\tr: " << result.r
+            << std::endl;
 
-//   return res;
-// }
\ No newline at end of file
+  // It's over.
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,150 @@
+#include "permutation_test.hpp"
+#include "moments.hpp"
+#include "philox.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+
+/* -------------------------------------------------------------------------- */
+/*                                   helpers                                  */
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+/** Number of permutations shuffled together by a task, when their copies of
+ * dy fit in the cache budget; one at a time otherwise. */
+constexpr size_t max_group = 4;
+
+/** Size, in bytes, of the copies of dy that a task may shuffle together. */
+constexpr size_t cache_budget = 256 * 1024;
+
+/** Number of permutations between two checks of the precision. */
+constexpr size_t batch = 1024;
+
+/**
+ * @brief Shuffles the permutations [first, first + Group) of dy, each one
+ * from a fresh copy, and calculates their cross terms with dx.
+ *
+ * The Fisher-Yates shuffle fixes the elements from the last one down, so
+ * each term is added as soon as its element is drawn. The draws of
+ * permutation k come from a splitmix64 sequence started at the first word of
+ * stream k of the Philox generator, much cheaper than a Philox call per draw.
+ *
+ * @param work Room for Group copies of dy.
+ * @param cross Where to write the Group cross terms.
+ */
+template <size_t Group>
+void cross_terms(const double *dx, const double *dy, size_t n,
+                 const Philox &philox, uint64_t first, double *work,
+                 double *cross) noexcept {
+  uint64_t states[Group];
+  double sums[Group];
+  for (size_t g = 0; g != Group; g++) {
+    std::memcpy(work + g * n, dy, n * sizeof(double));
+    states[g] = philox(first + g, 0)[0];
+    sums[g] = 0.0;
+  }
+
+  for (size_t i = n - 1; i != 0; i--) {
+    for (size_t g = 0; g != Group; g++) {
+      // Maps the word to [0, i] by a multiplication (Lemire).
+      double *const values = work + g * n;
+      const size_t j = static_cast<size_t>(
+          static_cast<unsigned __int128>(splitmix(states[g])) * (i + 1) >> 64);
+      std::swap(values[i], values[j]);
+      sums[g] += dx[i] * values[i];
+    }
+  }
+
+  for (size_t g = 0; g != Group; g++) {
+    cross[g] = sums[g] + dx[0] * work[g * n];
+  }
+}
+
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/*                              permutation_test                              */
+/* -------------------------------------------------------------------------- */
+
+Permutation_Result permutation_test(const Data_Set &data_set,
+                                    size_t max_permutations, double precision,
+                                    uint64_t seed) {
+  const size_t n = data_set.n;
+  if (n < 3) {
+    throw std::invalid_argument("the test needs at least 3 measurements");
+  }
+  if (max_permutations == 0) {
+    throw std::invalid_argument("the test needs at least 1 permutation");
+  }
+
+  const Moments moments =
+      calculate_moments_deterministic(data_set.x, data_set.y, n);
+
+  // The centered columns, computed once.
+  std::vector<double> dx(n), dy(n);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, n),
+                    [&](const tbb::blocked_range<size_t> &r) {
+                      for (size_t i = r.begin(); i != r.end(); i++) {
+                        dx[i] = data_set.x[i] - moments.mean_x;
+                        dy[i] = data_set.y[i] - moments.mean_y;
+                      }
+                    });
+
+  // A permutation that only reorders the sum of the observed cross term must
+  // count as extreme.
+  const double threshold = std::fabs(moments.m_xy) * (1.0 - 1e-12);
+
+  const Philox philox(seed);
+  const size_t group =
+      max_group * n * sizeof(double) <= cache_budget ? max_group : 1;
+  tbb::enumerable_thread_specific<std::vector<double>> work(group * n);
+
+  Permutation_Result res;
+  res.r = moments.correlation().r;
+  res.permutations = 0;
+  res.extreme = 0;
+  while (res.permutations != max_permutations) {
+    const size_t count = std::min(batch, max_permutations - res.permutations);
+    const size_t groups = (count + group - 1) / group;
+    const uint64_t first = res.permutations;
+
+    res.extreme += tbb::parallel_reduce(
+        tbb::blocked_range<size_t>(0, groups), size_t(0),
+        [&](const tbb::blocked_range<size_t> &r, size_t extreme) {
+          double cross[max_group];
+          for (size_t q = r.begin(); q != r.end(); q++) {
+            if (group == max_group) {
+              cross_terms<max_group>(dx.data(), dy.data(), n, philox,
+                                     first + q * group, work.local().data(),
+                                     cross);
+            } else {
+              cross_terms<1>(dx.data(), dy.data(), n, philox, first + q,
+                             work.local().data(), cross);
+            }
+            // The last group of the test may go past it.
+            const size_t valid = std::min(group, count - q * group);
+            for (size_t g = 0; g != valid; g++) {
+              extreme += std::fabs(cross[g]) >= threshold;
+            }
+          }
+          return extreme;
+        },
+        std::plus<size_t>());
+    res.permutations += count;
+
+    res.p_value = (res.extreme + 1.0) / (res.permutations + 1.0);
+    res.error = std::sqrt(res.p_value * (1.0 - res.p_value) / res.permutations);
+    if (precision > 0.0 && res.error <= precision) {
+      break;
+    }
+  }
+  return res;
+}
@@ -0,0 +1,115 @@
+#include "prefix_index.hpp"
+#include <algorithm>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_scan.h>
+
+/* -------------------------------------------------------------------------- */
+/*                                   helpers                                  */
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+/**
+ * @brief Returns hi - lo for two compensated sums, lo being a prefix of hi.
+ *
+ */
+inline double difference(const Compensated &hi, const Compensated &lo) noexcept {
+  Compensated res = hi;
+  res.add(-lo.sum);
+  res.error -= lo.error;
+  return res.value();
+}
+
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/*                                Prefix_Index                                */
+/* -------------------------------------------------------------------------- */
+
+Prefix_Index::Prefix_Index(const Data_Set &data_set)
+    : inner(data_set.n + 1), blocks((data_set.n + block - 1) / block + 1) {
+  const size_t n = data_set.n;
+  const double *const x = data_set.x;
+  const double *const y = data_set.y;
+
+  const Moments whole = calculate_moments(x, y, n);
+  shift_x = whole.mean_x;
+  shift_y = whole.mean_y;
+
+  // Sums from the start of each block, and the total of each block.
+  const size_t block_count = (n + block - 1) / block;
+  std::vector<Block_Sums> totals(block_count);
+  tbb::parallel_for(size_t(0), block_count, [&](size_t b) {
+    const size_t first = b * block, last = std::min(n, first + block);
+    Sums acc{0.0, 0.0, 0.0, 0.0, 0.0};
+    inner[first] = acc;
+    for (size_t k = first; k != last; k++) {
+      const double dx = x[k] - shift_x;
+      const double dy = y[k] - shift_y;
+      acc.x += dx;
+      acc.y += dy;
+      acc.xx += dx * dx;
+      acc.xy += dx * dy;
+      acc.yy += dy * dy;
+      if ((k + 1) % block != 0) {
+        inner[k + 1] = acc;
+      }
+    }
+    totals[b].x.add(acc.x);
+    totals[b].y.add(acc.y);
+    totals[b].xx.add(acc.xx);
+    totals[b].xy.add(acc.xy);
+    totals[b].yy.add(acc.yy);
+  });
+  if (n % block == 0) {
+    inner[n] = Sums{0.0, 0.0, 0.0, 0.0, 0.0};
+  }
+
+  // Exclusive prefix scan of the block totals.
+  tbb::parallel_scan(
+      tbb::blocked_range<size_t>(0, block_count), Block_Sums(),
+      [&](const tbb::blocked_range<size_t> &r, Block_Sums sum,
+          bool is_final_scan) {
+        for (size_t b = r.begin(); b != r.end(); b++) {
+          sum.add(totals[b]);
+          if (is_final_scan) {
+            blocks[b + 1] = sum;
+          }
+        }
+        return sum;
+      },
+      [](Block_Sums lhs, const Block_Sums &rhs) {
+        lhs.add(rhs);
+        return lhs;
+      });
+}
+
+Moments Prefix_Index::moments(size_t first, size_t last) const noexcept {
+  Moments res;
+  if (last <= first) {
+    return res;
+  }
+
+  const Block_Sums &head = blocks[first / block];
+  const Block_Sums &tail = blocks[last / block];
+  const Sums &head_inner = inner[first];
+  const Sums &tail_inner = inner[last];
+
+  const double sx = difference(tail.x, head.x) + (tail_inner.x - head_inner.x);
+  const double sy = difference(tail.y, head.y) + (tail_inner.y - head_inner.y);
+  const double sxx =
+      difference(tail.xx, head.xx) + (tail_inner.xx - head_inner.xx);
+  const double sxy =
+      difference(tail.xy, head.xy) + (tail_inner.xy - head_inner.xy);
+  const double syy =
+      difference(tail.yy, head.yy) + (tail_inner.yy - head_inner.yy);
+
+  res.n = static_cast<double>(last - first);
+  res.mean_x = shift_x + sx / res.n;
+  res.mean_y = shift_y + sy / res.n;
+  res.m_xx = sxx - sx * sx / res.n;
+  res.m_xy = sxy - sx * sy / res.n;
+  res.m_yy = syy - sy * sy / res.n;
+  return res;
+}
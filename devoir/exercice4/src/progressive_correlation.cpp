@@ -0,0 +1,176 @@
+#include "progressive_correlation.hpp"
+#include "moments.hpp"
+#include "normal.hpp"
+#include "philox.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+/* -------------------------------------------------------------------------- */
+/*                                   helpers                                  */
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+/** Number of measurements summarised at once, small enough to stay in L1. */
+constexpr size_t moments_block = 256;
+
+/** Number of blocks between two looks at the clock and at the bounds. */
+constexpr size_t wave_blocks = 64;
+
+/** Number of groups of blocks of the jackknife. */
+constexpr size_t jackknife_groups = 32;
+
+using Groups = std::array<Moments, jackknife_groups>;
+
+/**
+ * @brief Returns the estimate of a sample of blocks.
+ *
+ * The variance of the Fisher z of r is estimated by a delete-a-group
+ * jackknife: the blocks are dealt in turn to the groups, and each group is
+ * removed from the sample in its turn. The variation between blocks, and
+ * within them, is thus accounted for.
+ *
+ * @param sample The moments of the sample.
+ * @param groups The moments of the groups of blocks.
+ * @param seen The number of blocks of the sample.
+ * @param blocks The number of blocks of the data set.
+ * @param total The number of measurements of the data set.
+ * @param confidence The confidence level of the bounds.
+ */
+Progress progress_of(const Moments &sample, const Groups &groups, size_t seen,
+                     size_t blocks, double total, double confidence,
+                     double seconds) noexcept {
+  Progress res;
+  res.estimate = sample.correlation();
+  res.measurements = sample.n;
+  res.fraction = sample.n / total;
+  res.seconds = seconds;
+
+  const double r = res.estimate.r;
+  res.low = res.high = r;
+  if (seen == blocks) {
+    return res;
+  }
+
+  const size_t count = std::min(seen, jackknife_groups);
+  double estimates[jackknife_groups];
+  double mean = 0.0;
+  for (size_t j = 0; j != count; j++) {
+    Moments rest = sample;
+    rest.remove(groups[j]);
+    estimates[j] = std::atanh(rest.correlation().r);
+    mean += estimates[j] / count;
+  }
+  double variance = 0.0;
+  for (size_t j = 0; j != count; j++) {
+    variance += (estimates[j] - mean) * (estimates[j] - mean);
+  }
+  variance *= (count - 1.0) / count *
+              (1.0 - static_cast<double>(seen) / static_cast<double>(blocks));
+
+  const double error = std::sqrt(variance);
+  if (count < 2 || not std::isfinite(error) || not(std::fabs(r) < 1.0)) {
+    res.low = -1.0;
+    res.high = 1.0;
+    return res;
+  }
+  // Student's law, the jackknife having count - 1 degrees of freedom.
+  const double z = student_quantile(0.5 + confidence / 2.0, count - 1.0);
+  res.low = std::tanh(std::atanh(r) - z * error);
+  res.high = std::tanh(std::atanh(r) + z * error);
+  return res;
+}
+
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/*                           progressive_correlation                          */
+/* -------------------------------------------------------------------------- */
+
+Progress progressive_correlation(
+    const Data_Set &data_set, const Progressive_Options &options,
+    const std::function<void(const Progress &)> &report) {
+  const auto start = std::chrono::steady_clock::now();
+  const size_t n = data_set.n;
+  if (n < 2) {
+    throw std::invalid_argument("the estimate needs at least 2 measurements");
+  }
+  if (not(options.confidence > 0.0 && options.confidence < 1.0)) {
+    throw std::invalid_argument("the confidence level must be in (0, 1)");
+  }
+  if (options.block == 0) {
+    throw std::invalid_argument("the blocks need at least 1 measurement");
+  }
+
+  // Random order of the blocks (Fisher-Yates).
+  const size_t blocks = (n + options.block - 1) / options.block;
+  std::vector<size_t> order(blocks);
+  std::iota(order.begin(), order.end(), size_t(0));
+  uint64_t state = Philox(options.seed)(0, 0)[0];
+  for (size_t i = blocks - 1; i != 0; i--) {
+    const size_t j = static_cast<size_t>(
+        static_cast<unsigned __int128>(splitmix(state)) * (i + 1) >> 64);
+    std::swap(order[i], order[j]);
+  }
+
+  const auto elapsed = [&start] {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+  };
+
+  // Moments of the blocks of a wave, merged in their order afterwards. As the
+  // waves have a fixed number of blocks, the estimates and the points where
+  // the bounds are checked do not depend on the number of threads; only the
+  // stops on the budget and the reports, timed on the clock, do.
+  std::vector<Moments> wave_moments(wave_blocks);
+  Pairwise_Merger<Moments> sample;
+  Groups groups;
+  double next_report = options.cadence;
+  for (size_t first = 0;; first += wave_blocks) {
+    const size_t last = std::min(first + wave_blocks, blocks);
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(first, last),
+        [&](const tbb::blocked_range<size_t> &r) {
+          for (size_t k = r.begin(); k != r.end(); k++) {
+            const size_t begin = order[k] * options.block;
+            const size_t end = std::min(begin + options.block, n);
+            Moments moments =
+                block_moments(data_set.x + begin, data_set.y + begin,
+                              end - begin, moments_block, data_set.x[begin],
+                              data_set.y[begin]);
+            moments.shift(data_set.x[begin], data_set.y[begin]);
+            wave_moments[k - first] = moments;
+          }
+        });
+    for (size_t k = first; k != last; k++) {
+      sample.push(wave_moments[k - first]);
+      groups[k % jackknife_groups].merge(wave_moments[k - first]);
+    }
+
+    const double seconds = elapsed();
+    const Progress progress =
+        progress_of(sample.total(), groups, last, blocks, static_cast<double>(n),
+                    options.confidence, seconds);
+    const bool done =
+        last == blocks ||
+        (options.precision > 0.0 &&
+         (progress.high - progress.low) / 2.0 <= options.precision) ||
+        (options.budget > 0.0 && seconds >= options.budget);
+    if (done || seconds >= next_report) {
+      report(progress);
+      next_report = seconds + options.cadence;
+    }
+    if (done) {
+      return progress;
+    }
+  }
+}
@@ -0,0 +1,140 @@
+#include "cpp_argv.hpp"
+#include "correlation.hpp"
+#include "data_set.hpp"
+#include "rank_correlation.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <tbb/blocked_range.h>
+#include <tbb/global_control.h>
+#include <tbb/parallel_for.h>
+
+#define DEFAULT_NAME "exercice4_rank"
+
+/**
+ * @brief Builds a synthetic data set with outliers and many ties: x takes 1000
+ * distinct values, y follows it with noise and a few wild measurements.
+ *
+ * @param n The number of measurements.
+ * @return Data_Set The data set.
+ */
+static Data_Set make_tied_data_set(size_t n) {
+  const std::shared_ptr<double[]> columns(new double[2 * n]);
+  double *const x = columns.get();
+  double *const y = x + n;
+
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, n),
+                    [x, y](const tbb::blocked_range<size_t> &r) {
+                      for (size_t i = r.begin(); i != r.end(); i++) {
+                        uint64_t z = i * 0x9e3779b97f4a7c15ULL;
+                        z = (z ^ (z >> 31)) * 0xbf58476d1ce4e5b9ULL;
+                        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+                        const double u = (z >> 11) * 0x1.0p-53;
+                        x[i] = static_cast<double>(z % 1000);
+                        y[i] = std::round(x[i] + 300.0 * (u - 0.5));
+                        if (z % 97 == 0) {
+                          y[i] = 1e6 * u;
+                        }
+                      }
+                    });
+
+  Data_Set res;
+  res.n = n;
+  res.x = x;
+  res.y = y;
+  res.storage = columns;
+  return res;
+}
+
+/**
+ * @brief Calculates Kendall's tau-b by comparing every pair, in O(n^2).
+ *
+ */
+static double kendall_brute_force(const Data_Set &data_set) {
+  double concordant_minus_discordant = 0.0, untied_x = 0.0, untied_y = 0.0;
+  for (size_t i = 0; i != data_set.n; i++) {
+    for (size_t j = i + 1; j != data_set.n; j++) {
+      const double dx = data_set.x[i] - data_set.x[j];
+      const double dy = data_set.y[i] - data_set.y[j];
+      concordant_minus_discordant += (dx > 0) - (dx < 0) == 0 ? 0.0
+                                     : ((dx > 0) == (dy > 0) && dy != 0) ? 1.0
+                                     : dy == 0 ? 0.0 : -1.0;
+      untied_x += dx != 0;
+      untied_y += dy != 0;
+    }
+  }
+  return concordant_minus_discordant / std::sqrt(untied_x * untied_y);
+}
+
+/**
+ * @brief Returns the duration of a call, in seconds.
+ *
+ */
+template <typename Function> static double time_it(const Function &f) {
+  const auto start = std::chrono::steady_clock::now();
+  f();
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(stop - start).count();
+}
+
+/**
+ * @brief Times Pearson, Spearman and Kendall tau-b on data sets of growing
+ * sizes, ten times larger each time, and checks Kendall tau-b against the
+ * quadratic definition on a small one.
+ *
+ * @param argc number of arguments in the command line.
+ * @param argv arguments of the command line.
+ * @return @c EXIT_SUCCESS if command succeeds else @c EXIT_FAILURE.
+ */
+int main(int argc, char *argv[]) {
+
+  // User expects help.
+  CPP_ARGV_TEST_HELP_REQUEST(argc, argv[0], DEFAULT_NAME, "max_size")
+
+  // Bad argument number.
+  CPP_ARGV_TEST_ARG_NUM(argc, 2)
+
+  // Retrieves the largest size.
+  size_t max_size;
+  {
+    std::istringstream size_arg(argv[1]);
+    size_arg >> max_size;
+    if (not size_arg or max_size < 2) {
+      std::cerr << "Bad argument" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Agreement with the definition.
+  {
+    const Data_Set small = make_tied_data_set(2000);
+    std::cout << "|tau-b - brute force|:\t"
+              << std::fabs(kendall_tau_b(small) - kendall_brute_force(small))
+              << std::endl;
+  }
+
+  std::cout << "Thread(s):\t"
+            << tbb::global_control::active_value(
+                   tbb::global_control::max_allowed_parallelism)
+            << std::endl;
+  std::cout << "size\tpearson (s)\tspearman (s)\tkendall (s)\tr\trho\ttau-b"
+            << std::endl;
+
+  for (size_t n = 1000; n <= max_size; n *= 10) {
+    const Data_Set data_set = make_tied_data_set(n);
+    double r = 0.0, rho = 0.0, tau = 0.0;
+    const double pearson_time = time_it([&] { r = calculate(data_set).r; });
+    const double spearman_time = time_it([&] { rho = spearman(data_set); });
+    const double kendall_time = time_it([&] { tau = kendall_tau_b(data_set); });
+    std::cout << n << '\t' << pearson_time << '\t' << spearman_time << '\t'
+              << kendall_time << '\t' << r << '\t' << rho << '\t' << tau
+              << std::endl;
+  }
+
+  // It's over.
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,262 @@
+#include "rank_correlation.hpp"
+#include "column_buffer.hpp"
+#include "correlation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/parallel_sort.h>
+
+/* -------------------------------------------------------------------------- */
+/*                                   helpers                                  */
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+/** Size below which sorts and merges run sequentially. */
+constexpr size_t cutoff = 16 * 1024;
+
+/** Size below which sorts are insertion sorts. */
+constexpr size_t insertion_cutoff = 16;
+
+/**
+ * @brief Sequentially merges two sorted runs, counting the pairs (a, b) of
+ * the first and second runs such that a > b.
+ *
+ */
+uint64_t merge_count_sequential(const double *a, size_t na, const double *b,
+                                size_t nb, double *out) noexcept {
+  uint64_t inversions = 0;
+  size_t p = 0, q = 0;
+  while (p != na && q != nb) {
+    if (b[q] < a[p]) {
+      inversions += na - p;
+      *out++ = b[q++];
+    } else {
+      *out++ = a[p++];
+    }
+  }
+  std::copy(a + p, a + na, out);
+  std::copy(b + q, b + nb, out + (na - p));
+  return inversions;
+}
+
+/**
+ * @brief Merges two sorted runs in parallel, counting the pairs (a, b) of the
+ * first and second runs such that a > b.
+ *
+ */
+uint64_t merge_count(const double *a, size_t na, const double *b, size_t nb,
+                     double *out) noexcept {
+  if (na + nb <= cutoff) {
+    return merge_count_sequential(a, na, b, nb, out);
+  }
+
+  // Middle of the longer run, searched in the shorter one so that equal
+  // elements of the first run stay first: a[i..] > b[..j) in both cases.
+  size_t i, j;
+  if (na >= nb) {
+    i = na / 2;
+    j = std::lower_bound(b, b + nb, a[i]) - b;
+  } else {
+    j = nb / 2;
+    i = std::upper_bound(a, a + na, b[j]) - a;
+  }
+
+  uint64_t left = 0, right = 0;
+  tbb::parallel_invoke(
+      [&] { left = merge_count(a, i, b, j, out); },
+      [&] { right = merge_count(a + i, na - i, b + j, nb - j, out + i + j); });
+  return left + right + static_cast<uint64_t>(na - i) * j;
+}
+
+/**
+ * @brief Sorts a, or a copy of it into b, counting the inversions; a and b
+ * exchange their roles at each level of the recursion.
+ *
+ */
+uint64_t sort_count(double *a, double *b, size_t n, bool into_b) noexcept {
+  if (n <= insertion_cutoff) {
+    uint64_t inversions = 0;
+    for (size_t k = 1; k < n; k++) {
+      const double value = a[k];
+      size_t j = k;
+      for (; j != 0 && a[j - 1] > value; j--) {
+        a[j] = a[j - 1];
+      }
+      a[j] = value;
+      inversions += k - j;
+    }
+    if (into_b) {
+      std::copy(a, a + n, b);
+    }
+    return inversions;
+  }
+
+  // The halves are sorted into the array the merge reads from.
+  const size_t half = n / 2;
+  uint64_t left = 0, right = 0;
+  const auto sort_left = [&] { left = sort_count(a, b, half, not into_b); };
+  const auto sort_right = [&] {
+    right = sort_count(a + half, b + half, n - half, not into_b);
+  };
+  if (n <= cutoff) {
+    sort_left();
+    sort_right();
+  } else {
+    tbb::parallel_invoke(sort_left, sort_right);
+  }
+
+  const double *const from = into_b ? a : b;
+  double *const to = into_b ? b : a;
+  return left + right + merge_count(from, half, from + half, n - half, to);
+}
+
+/**
+ * @brief Calls f(first, last) on every run [first, last) of consecutive
+ * positions of [0, n) such that same(k - 1, k), in parallel.
+ *
+ * A run is handled by the chunk holding its first position, which may read
+ * past its end.
+ */
+template <typename Same, typename Function>
+void for_each_run(size_t n, const Same &same, const Function &f) {
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, n),
+                    [&](const tbb::blocked_range<size_t> &r) {
+                      size_t first = r.begin();
+                      while (first != r.end() && first != 0 && same(first - 1, first)) {
+                        first++;
+                      }
+                      while (first < r.end()) {
+                        size_t last = first + 1;
+                        while (last != n && same(last - 1, last)) {
+                          last++;
+                        }
+                        f(first, last);
+                        first = last;
+                      }
+                    });
+}
+
+/**
+ * @brief Counts the pairs of tied positions of [0, n), runs being defined as
+ * in for_each_run.
+ *
+ */
+template <typename Same>
+uint64_t tied_pairs(size_t n, const Same &same) {
+  return tbb::parallel_reduce(
+      tbb::blocked_range<size_t>(0, n), uint64_t(0),
+      [&](const tbb::blocked_range<size_t> &r, uint64_t pairs) {
+        size_t first = r.begin();
+        while (first != r.end() && first != 0 && same(first - 1, first)) {
+          first++;
+        }
+        while (first < r.end()) {
+          size_t last = first + 1;
+          while (last != n && same(last - 1, last)) {
+            last++;
+          }
+          const uint64_t t = last - first;
+          pairs += t * (t - 1) / 2;
+          first = last;
+        }
+        return pairs;
+      },
+      [](uint64_t lhs, uint64_t rhs) { return lhs + rhs; });
+}
+
+/**
+ * @brief Ranks a column, from 1, tied measurements sharing their average rank.
+ *
+ */
+void rank(const double *values, size_t n, double *ranks) {
+  std::vector<std::pair<double, size_t>> sorted(n);
+  tbb::parallel_for(size_t(0), n, [&](size_t i) {
+    sorted[i] = std::make_pair(values[i], i);
+  });
+  tbb::parallel_sort(sorted.begin(), sorted.end());
+
+  for_each_run(
+      n, [&](size_t i, size_t j) { return sorted[i].first == sorted[j].first; },
+      [&](size_t first, size_t last) {
+        const double average = (first + last - 1) / 2.0 + 1.0;
+        for (size_t k = first; k != last; k++) {
+          ranks[sorted[k].second] = average;
+        }
+      });
+}
+
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/*                            sort_count_inversions                           */
+/* -------------------------------------------------------------------------- */
+
+uint64_t sort_count_inversions(double *values, size_t n) {
+  const std::unique_ptr<double[]> buffer(new double[n]);
+  return sort_count(values, buffer.get(), n, false);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  spearman                                  */
+/* -------------------------------------------------------------------------- */
+
+double spearman(const Data_Set &data_set) {
+  const size_t n = data_set.n;
+  const std::shared_ptr<Column_Buffer> ranks =
+      std::make_shared<Column_Buffer>(n, 2);
+
+  // One column after the other, each sort being parallel already, so that a
+  // single sorted copy is alive at a time.
+  rank(data_set.x, n, ranks->column(0));
+  rank(data_set.y, n, ranks->column(1));
+
+  Data_Set ranked;
+  ranked.n = n;
+  ranked.x = ranks->column(0);
+  ranked.y = ranks->column(1);
+  ranked.storage = ranks;
+  return calculate(ranked).r;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                kendall_tau_b                               */
+/* -------------------------------------------------------------------------- */
+
+double kendall_tau_b(const Data_Set &data_set) {
+  const size_t n = data_set.n;
+
+  // Pairs ordered by x, then y.
+  std::vector<std::pair<double, double>> pairs(n);
+  tbb::parallel_for(size_t(0), n, [&](size_t i) {
+    pairs[i] = std::make_pair(data_set.x[i], data_set.y[i]);
+  });
+  tbb::parallel_sort(pairs.begin(), pairs.end());
+
+  // Pairs tied in x, and in both x and y.
+  const uint64_t tied_x = tied_pairs(
+      n, [&](size_t i, size_t j) { return pairs[i].first == pairs[j].first; });
+  const uint64_t tied_xy =
+      tied_pairs(n, [&](size_t i, size_t j) { return pairs[i] == pairs[j]; });
+
+  // Discordant pairs: inversions of y, the pairs tied in x being ordered by y.
+  std::vector<double> y(n);
+  tbb::parallel_for(size_t(0), n, [&](size_t i) { y[i] = pairs[i].second; });
+  const uint64_t discordant = sort_count_inversions(y.data(), n);
+
+  // Pairs tied in y, y being sorted now.
+  const uint64_t tied_y =
+      tied_pairs(n, [&](size_t i, size_t j) { return y[i] == y[j]; });
+
+  const double total = static_cast<double>(n) * (n - 1) / 2.0;
+  const double concordant_minus_discordant =
+      total - tied_x - tied_y + tied_xy - 2.0 * discordant;
+  return concordant_minus_discordant /
+         std::sqrt((total - tied_x) * (total - tied_y));
+}
@@ -0,0 +1,408 @@
+#include "regression.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+
+/* -------------------------------------------------------------------------- */
+/*                                   helpers                                  */
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+/** Number of rows packed into the panel at once. */
+constexpr size_t row_block = 256;
+
+/** Size of the register block of the kernel: rows then columns. */
+constexpr size_t kernel_rows = 4;
+constexpr size_t kernel_columns = 8;
+
+/** Relative size under which a pivot is taken for zero. */
+constexpr double rank_tolerance = 1e-10;
+
+/**
+ * @brief Calculates the upper triangle of the product of a panel by its
+ * transpose: sums[i][j] = sum over r of panel[r][i] * panel[r][j], j >= i.
+ *
+ * The register blocks along the diagonal also write a few entries below it.
+ * The kernel is compiled for several instruction sets, the widest one the
+ * processor supports being picked when the program is loaded.
+ *
+ * @param panel The panel, row-major, width columns per row.
+ * @param rows The number of rows of the panel.
+ * @param width The number of columns, a multiple of kernel_columns.
+ * @param sums The sums, row-major, width x width.
+ */
+__attribute__((target_clones("avx512f", "avx2,fma", "default")))
+void gram_kernel(const double *panel, size_t rows, size_t width,
+                 double *sums) noexcept {
+  for (size_t i0 = 0; i0 != width; i0 += kernel_rows) {
+    for (size_t j0 = i0 / kernel_columns * kernel_columns; j0 != width;
+         j0 += kernel_columns) {
+      // Independent accumulators, kept in registers over the whole panel.
+      double acc[kernel_rows][kernel_columns] = {};
+      for (size_t r = 0; r != rows; r++) {
+        const double *const row = panel + r * width;
+        for (size_t ii = 0; ii != kernel_rows; ii++) {
+          const double a = row[i0 + ii];
+          for (size_t jj = 0; jj != kernel_columns; jj++) {
+            acc[ii][jj] += a * row[j0 + jj];
+          }
+        }
+      }
+      for (size_t ii = 0; ii != kernel_rows; ii++) {
+        for (size_t jj = 0; jj != kernel_columns; jj++) {
+          sums[(i0 + ii) * width + j0 + jj] = acc[ii][jj];
+        }
+      }
+    }
+  }
+}
+
+class GramReducer {
+  public:
+    const std::vector<const double*>& columns;
+    size_t width;
+    double n;
+    std::vector<double> means;
+    std::vector<double> sums;
+    std::vector<double> panel;
+    std::vector<double> block_means;
+    std::vector<double> block_sums;
+
+    GramReducer (const std::vector<const double*>& columns) : columns(columns), width((columns.size() + kernel_columns - 1) / kernel_columns * kernel_columns), n(0.0), means(columns.size(), 0.0), sums(width * width, 0.0), panel(row_block * width, 0.0), block_means(columns.size()), block_sums(width * width) {}
+
+    GramReducer (const GramReducer& other, tbb::split) : GramReducer(other.columns) {}
+
+    void operator() (const tbb::blocked_range<size_t>& r) {
+      const size_t q = columns.size();
+      for (size_t first = r.begin(); first < r.end(); first += row_block) {
+        const size_t rows = std::min(row_block, r.end() - first);
+
+        // Packs the block centered on its own averages; the padding columns
+        // stay at zero.
+        for (size_t v = 0; v != q; v++) {
+          const double *const column = columns[v] + first;
+          double sum = 0.0;
+          for (size_t i = 0; i != rows; i++) {
+            sum += column[i];
+          }
+          block_means[v] = sum / rows;
+          for (size_t i = 0; i != rows; i++) {
+            panel[i * width + v] = column[i] - block_means[v];
+          }
+        }
+
+        gram_kernel(panel.data(), rows, width, block_sums.data());
+        merge(static_cast<double>(rows), block_means, block_sums);
+      }
+    }
+
+    void join (const GramReducer& other) {
+      merge(other.n, other.means, other.sums);
+    }
+
+    /**
+     * @brief Adds the centered sums of a disjoint set of rows, like
+     * Moments::merge: sums += other + n * count / (n + count) * d * d^T,
+     * d being the difference of the averages.
+     *
+     */
+    void merge (double count, const std::vector<double>& other_means, const std::vector<double>& other_sums) {
+      if (count == 0.0) {
+        return;
+      }
+      const size_t q = columns.size();
+      const double total = n + count;
+      const double weight = n * count / total;
+      for (size_t i = 0; i != q; i++) {
+        const double di = other_means[i] - means[i];
+        for (size_t j = i; j != q; j++) {
+          const double dj = other_means[j] - means[j];
+          sums[i * width + j] += other_sums[i * width + j] + weight * di * dj;
+        }
+      }
+      for (size_t i = 0; i != q; i++) {
+        means[i] += (other_means[i] - means[i]) * (count / total);
+      }
+      n = total;
+    }
+};
+
+/**
+ * @brief Cholesky factorization L L^T of a symmetric matrix.
+ *
+ */
+struct Cholesky {
+  size_t k;              /** Order of the matrix.                    */
+  std::vector<double> l; /** L, row-major.                           */
+  bool valid;            /** Whether every pivot is clearly positive. */
+
+  /**
+   * @brief Factorizes a matrix, failing on a pivot that is small compared
+   * with its diagonal entry: a column almost a combination of the previous
+   * ones.
+   *
+   * @param a The matrix, row-major, k x k.
+   */
+  Cholesky(const std::vector<double> &a, size_t k)
+      : k(k), l(k * k, 0.0), valid(true) {
+    for (size_t j = 0; j != k && valid; j++) {
+      double d = a[j * k + j];
+      for (size_t p = 0; p != j; p++) {
+        d -= l[j * k + p] * l[j * k + p];
+      }
+      if (not(d > rank_tolerance * a[j * k + j])) {
+        valid = false;
+        break;
+      }
+      l[j * k + j] = std::sqrt(d);
+      for (size_t i = j + 1; i != k; i++) {
+        double s = a[i * k + j];
+        for (size_t p = 0; p != j; p++) {
+          s -= l[i * k + p] * l[j * k + p];
+        }
+        l[i * k + j] = s / l[j * k + j];
+      }
+    }
+  }
+
+  /**
+   * @brief Solves a x = b.
+   *
+   */
+  std::vector<double> solve(std::vector<double> b) const {
+    for (size_t i = 0; i != k; i++) {
+      for (size_t p = 0; p != i; p++) {
+        b[i] -= l[i * k + p] * b[p];
+      }
+      b[i] /= l[i * k + i];
+    }
+    for (size_t i = k; i-- != 0;) {
+      for (size_t p = i + 1; p != k; p++) {
+        b[i] -= l[p * k + i] * b[p];
+      }
+      b[i] /= l[i * k + i];
+    }
+    return b;
+  }
+};
+
+/**
+ * @brief Householder QR factorization A P = Q R of a square matrix, with
+ * optional column pivoting.
+ *
+ */
+struct Householder_Qr {
+  size_t k;                           /** Order of the matrix.          */
+  std::vector<double> r;              /** R, row-major.                 */
+  std::vector<std::vector<double>> v; /** Reflectors, from row c on.    */
+  std::vector<size_t> permutation;    /** Column c of R is column p[c]. */
+  size_t rank;                        /** Number of nonzero pivots.     */
+
+  /**
+   * @brief Factorizes a matrix.
+   *
+   * @param a The matrix, row-major, k x k.
+   * @param pivot Whether to bring the remaining column of largest norm first
+   * at every step, so that R reveals the rank.
+   */
+  Householder_Qr(std::vector<double> a, size_t k, bool pivot)
+      : k(k), r(std::move(a)), v(k), permutation(k), rank(0) {
+    std::iota(permutation.begin(), permutation.end(), size_t(0));
+    for (size_t c = 0; c != k; c++) {
+      if (pivot) {
+        size_t best = c;
+        double best_norm = -1.0;
+        for (size_t j = c; j != k; j++) {
+          double norm = 0.0;
+          for (size_t i = c; i != k; i++) {
+            norm += r[i * k + j] * r[i * k + j];
+          }
+          if (norm > best_norm) {
+            best = j;
+            best_norm = norm;
+          }
+        }
+        for (size_t i = 0; i != k; i++) {
+          std::swap(r[i * k + c], r[i * k + best]);
+        }
+        std::swap(permutation[c], permutation[best]);
+      }
+
+      // Reflector sending the rows c.. of column c onto the first of them.
+      double alpha = 0.0;
+      for (size_t i = c; i != k; i++) {
+        alpha += r[i * k + c] * r[i * k + c];
+      }
+      alpha = r[c * k + c] > 0.0 ? -std::sqrt(alpha) : std::sqrt(alpha);
+      v[c].resize(k - c);
+      for (size_t i = c; i != k; i++) {
+        v[c][i - c] = r[i * k + c];
+      }
+      v[c][0] -= alpha;
+      for (size_t j = c; j != k; j++) {
+        reflect(c, r.data() + j, k);
+      }
+    }
+
+    const double largest = k == 0 ? 0.0 : std::fabs(r[0]);
+    while (rank != k &&
+           std::fabs(r[rank * k + rank]) > rank_tolerance * largest) {
+      ++rank;
+    }
+  }
+
+  /**
+   * @brief Applies the reflector c to the rows c.. of a column whose values
+   * are stride apart.
+   *
+   */
+  void reflect(size_t c, double *column, size_t stride) const noexcept {
+    double norm = 0.0, dot = 0.0;
+    for (size_t i = 0; i != k - c; i++) {
+      norm += v[c][i] * v[c][i];
+      dot += v[c][i] * column[(c + i) * stride];
+    }
+    if (norm == 0.0) {
+      return;
+    }
+    const double scale = 2.0 * dot / norm;
+    for (size_t i = 0; i != k - c; i++) {
+      column[(c + i) * stride] -= scale * v[c][i];
+    }
+  }
+
+  /**
+   * @brief Solves a x = b in the least squares sense over the first rank
+   * columns of A P, the other unknowns being zero.
+   *
+   */
+  std::vector<double> solve(std::vector<double> b) const {
+    for (size_t c = 0; c != k; c++) {
+      reflect(c, b.data(), 1);
+    }
+    std::vector<double> x(k, 0.0);
+    for (size_t c = rank; c-- != 0;) {
+      double s = b[c];
+      for (size_t j = c + 1; j != rank; j++) {
+        s -= r[c * k + j] * b[j];
+      }
+      b[c] = s / r[c * k + c];
+      x[permutation[c]] = b[c];
+    }
+    return x;
+  }
+};
+
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/*                              linear_regression                             */
+/* -------------------------------------------------------------------------- */
+
+Regression linear_regression(const Column_Set &column_set) {
+  const size_t q = column_set.m();
+  if (q < 2) {
+    throw std::runtime_error("expected at least 2 columns, found " +
+                             std::to_string(q));
+  }
+  const size_t k = q - 1;
+  if (column_set.n <= q) {
+    throw std::runtime_error("expected more than " + std::to_string(q) +
+                             " measurements, found " +
+                             std::to_string(column_set.n));
+  }
+
+  GramReducer gram_reducer(column_set.columns);
+  tbb::parallel_reduce(
+      tbb::blocked_range<size_t>(0, column_set.n, row_block), gram_reducer);
+
+  // The centered normal equations: c_xx beta = c_xy.
+  const size_t width = gram_reducer.width;
+  const std::vector<double> &sums = gram_reducer.sums;
+  const auto sum = [&](size_t i, size_t j) {
+    return i <= j ? sums[i * width + j] : sums[j * width + i];
+  };
+  const double c_yy = sum(k, k);
+
+  // The predictors kept, all of them unless Cholesky fails.
+  std::vector<size_t> kept(k);
+  std::iota(kept.begin(), kept.end(), size_t(0));
+  const auto kept_matrix = [&] {
+    std::vector<double> a(kept.size() * kept.size());
+    for (size_t i = 0; i != kept.size(); i++) {
+      for (size_t j = 0; j != kept.size(); j++) {
+        a[i * kept.size() + j] = sum(kept[i], kept[j]);
+      }
+    }
+    return a;
+  };
+
+  Regression res;
+  const Cholesky cholesky(kept_matrix(), k);
+  res.cholesky = cholesky.valid;
+  Householder_Qr qr({}, 0, false);
+  if (not res.cholesky) {
+    // Keeps the columns before the first negligible pivot of R, then solves
+    // for them alone.
+    const Householder_Qr pivoted(kept_matrix(), k, true);
+    kept.assign(pivoted.permutation.begin(),
+                pivoted.permutation.begin() + pivoted.rank);
+    std::sort(kept.begin(), kept.end());
+    qr = Householder_Qr(kept_matrix(), kept.size(), false);
+  }
+  const auto solve = [&](std::vector<double> b) {
+    return res.cholesky ? cholesky.solve(std::move(b)) : qr.solve(std::move(b));
+  };
+  const size_t rank = kept.size();
+  res.rank = rank;
+
+  // Slopes of the kept predictors, and the inverse of their matrix.
+  std::vector<double> c_xy(rank);
+  for (size_t i = 0; i != rank; i++) {
+    c_xy[i] = sum(kept[i], k);
+  }
+  const std::vector<double> beta = solve(c_xy);
+  std::vector<double> inverse(rank * rank);
+  for (size_t j = 0; j != rank; j++) {
+    std::vector<double> unit(rank, 0.0);
+    unit[j] = 1.0;
+    const std::vector<double> column = solve(std::move(unit));
+    for (size_t i = 0; i != rank; i++) {
+      inverse[i * rank + j] = column[i];
+    }
+  }
+
+  // Residual sum of squares and variance.
+  double explained = 0.0;
+  for (size_t i = 0; i != rank; i++) {
+    explained += beta[i] * c_xy[i];
+  }
+  const double residual = std::max(c_yy - explained, 0.0);
+  const double n = gram_reducer.n;
+  const double variance = residual / (n - rank - 1.0);
+  res.r2 = 1.0 - residual / c_yy;
+
+  // Coefficients in the order of the columns, the intercept first.
+  const std::vector<double> &means = gram_reducer.means;
+  res.coefficients.assign(q, 0.0);
+  res.errors.assign(q, NAN);
+  double intercept = means[k], leverage = 1.0 / n;
+  for (size_t i = 0; i != rank; i++) {
+    res.coefficients[kept[i] + 1] = beta[i];
+    res.errors[kept[i] + 1] = std::sqrt(variance * inverse[i * rank + i]);
+    intercept -= beta[i] * means[kept[i]];
+    for (size_t j = 0; j != rank; j++) {
+      leverage += means[kept[i]] * inverse[i * rank + j] * means[kept[j]];
+    }
+  }
+  res.coefficients[0] = intercept;
+  res.errors[0] = std::sqrt(variance * leverage);
+  return res;
+}
@@ -0,0 +1,164 @@
+#include "cpp_argv.hpp"
+#include "correlation.hpp"
+#include "data_set.hpp"
+#include "simd_kernels.hpp"
+#include "synthetic_data.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <tbb/global_control.h>
+
+#define DEFAULT_NAME "exercice4_simd"
+
+/**
+ * @brief Long double sum compensated with TwoSum, used as the reference.
+ *
+ */
+struct Reference_Sum {
+  long double sum = 0.0L, error = 0.0L;
+
+  void add(long double value) {
+    const long double t = sum + value;
+    const long double z = t - sum;
+    error += (sum - (t - z)) + (value - z);
+    sum = t;
+  }
+
+  long double value() const { return sum + error; }
+};
+
+/**
+ * @brief Calculates the reference correlation, in extended precision with
+ * compensated sums.
+ *
+ */
+static Correlation calculate_reference(const Data_Set &data_set) {
+  Reference_Sum sum_x, sum_y;
+  for (size_t i = 0; i != data_set.n; i++) {
+    sum_x.add(data_set.x[i]);
+    sum_y.add(data_set.y[i]);
+  }
+  const long double moy_x = sum_x.value() / data_set.n;
+  const long double moy_y = sum_y.value() / data_set.n;
+
+  Reference_Sum tot_xx, tot_xy, tot_yy;
+  for (size_t i = 0; i != data_set.n; i++) {
+    const long double dx = data_set.x[i] - moy_x;
+    const long double dy = data_set.y[i] - moy_y;
+    tot_xx.add(dx * dx);
+    tot_xy.add(dx * dy);
+    tot_yy.add(dy * dy);
+  }
+
+  const long double a = tot_xy.value() / tot_xx.value();
+  Correlation res;
+  res.a = static_cast<double>(a);
+  res.b = static_cast<double>(moy_y - a * moy_x);
+  res.r = static_cast<double>(
+      tot_xy.value() / std::sqrt(tot_xx.value() * tot_yy.value()));
+  return res;
+}
+
+/**
+ * @brief Calculates the correlation on the calling thread only, with the
+ * kernels of a given instruction set.
+ *
+ */
+static Correlation calculate_serial(const Data_Set &data_set, simd::Isa isa) {
+  const Column_Sums sums = simd::sums(data_set.x, data_set.y, data_set.n, isa);
+  const double moy_x = sums.x.value() / data_set.n;
+  const double moy_y = sums.y.value() / data_set.n;
+
+  const Centered_Sums tot =
+      simd::centered_sums(data_set.x, data_set.y, data_set.n, moy_x, moy_y, isa);
+
+  Correlation res;
+  res.a = tot.xy.value() / tot.xx.value();
+  res.b = moy_y - res.a * moy_x;
+  res.r = tot.xy.value() / std::sqrt(tot.xx.value() * tot.yy.value());
+  return res;
+}
+
+/**
+ * @brief Runs a calculation several times, then prints its duration per run,
+ * its read bandwidth and its errors against the reference.
+ *
+ */
+template <typename Calculation>
+static void report(const char *name, Calculation calculation,
+                   const Data_Set &data_set, size_t iters,
+                   const Correlation &reference) {
+  Correlation result{};
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i != iters; i++) {
+    result = calculation(data_set);
+  }
+  const auto stop = std::chrono::steady_clock::now();
+  const double seconds =
+      std::chrono::duration<double>(stop - start).count() / iters;
+
+  // Two passes, each one reading both columns.
+  const double gigabytes = 2.0 * 2.0 * data_set.n * sizeof(double) / 1e9;
+  std::cout << name << "\t" << seconds << " s\t" << gigabytes / seconds
+            << " GB/s\t|err a|: " << std::fabs(result.a - reference.a)
+            << "\t|err r|: " << std::fabs(result.r - reference.r) << std::endl;
+}
+
+/**
+ * @brief Compares the scalar reducers with the vectorized, compensated
+ * kernels: throughput and accuracy against an extended precision reference.
+ *
+ * @param argc number of arguments in the command line.
+ * @param argv arguments of the command line.
+ * @return @c EXIT_SUCCESS if command succeeds else @c EXIT_FAILURE.
+ */
+int main(int argc, char *argv[]) {
+
+  // User expects help.
+  CPP_ARGV_TEST_HELP_REQUEST(argc, argv[0], DEFAULT_NAME, "size iterations")
+
+  // Bad argument number.
+  CPP_ARGV_TEST_ARG_NUM(argc, 3)
+
+  // Retrieves the data set size and the number of iterations.
+  size_t n, iters;
+  {
+    std::istringstream size_arg(argv[1]), iters_arg(argv[2]);
+    size_arg >> n;
+    iters_arg >> iters;
+    if (not size_arg or not iters_arg or n == 0 or iters == 0) {
+      std::cerr << "Bad argument" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Far from the origin, so that naive sums lose digits.
+  const Data_Set data_set = make_synthetic_data_set(n, 1e8);
+  const Correlation reference = calculate_reference(data_set);
+
+  std::cout << "Thread(s):\t"
+            << tbb::global_control::active_value(
+                   tbb::global_control::max_allowed_parallelism)
+            << std::endl;
+  std::cout << "Detected:\t" << simd::isa_name(simd::detected_isa())
+            << std::endl;
+
+  // Parallel versions.
+  report("two-pass", calculate_two_pass, data_set, iters, reference);
+  report("simd", calculate_simd, data_set, iters, reference);
+
+  // Every supported kernel, on a single thread.
+  for (const simd::Isa isa :
+       {simd::Isa::scalar, simd::Isa::avx2, simd::Isa::avx512}) {
+    if (simd::supported(isa)) {
+      report(simd::isa_name(isa),
+             [isa](const Data_Set &d) { return calculate_serial(d, isa); },
+             data_set, iters, reference);
+    }
+  }
+
+  // It's over.
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,310 @@
+#include "simd_kernels.hpp"
+#include <immintrin.h>
+
+// This file must be compiled without floating-point contraction: a multiply
+// fused into the following addition would break the error-free
+// transformations (see CMakeLists.txt).
+
+#define AVX2_TARGET __attribute__((target("avx2,fma")))
+#define AVX512_TARGET __attribute__((target("avx512f")))
+
+/* -------------------------------------------------------------------------- */
+/*                                   scalar                                   */
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+/** Number of independent accumulators per sum of the scalar kernels. */
+constexpr size_t scalar_lanes = 4;
+
+Column_Sums sums_scalar(const double *x, const double *y, size_t n) noexcept {
+  Compensated sx[scalar_lanes], sy[scalar_lanes];
+  size_t i = 0;
+  for (; i + scalar_lanes <= n; i += scalar_lanes) {
+    for (size_t k = 0; k != scalar_lanes; k++) {
+      sx[k].add(x[i + k]);
+      sy[k].add(y[i + k]);
+    }
+  }
+  for (; i != n; i++) {
+    sx[0].add(x[i]);
+    sy[0].add(y[i]);
+  }
+
+  Column_Sums res;
+  for (size_t k = 0; k != scalar_lanes; k++) {
+    res.x.add(sx[k]);
+    res.y.add(sy[k]);
+  }
+  return res;
+}
+
+Centered_Sums centered_sums_scalar(const double *x, const double *y, size_t n,
+                                   double mean_x, double mean_y) noexcept {
+  Compensated sxx[scalar_lanes], sxy[scalar_lanes], syy[scalar_lanes];
+  size_t i = 0;
+  for (; i + scalar_lanes <= n; i += scalar_lanes) {
+    for (size_t k = 0; k != scalar_lanes; k++) {
+      const double dx = x[i + k] - mean_x;
+      const double dy = y[i + k] - mean_y;
+      sxx[k].add(dx * dx);
+      sxy[k].add(dx * dy);
+      syy[k].add(dy * dy);
+    }
+  }
+  for (; i != n; i++) {
+    const double dx = x[i] - mean_x;
+    const double dy = y[i] - mean_y;
+    sxx[0].add(dx * dx);
+    sxy[0].add(dx * dy);
+    syy[0].add(dy * dy);
+  }
+
+  Centered_Sums res;
+  for (size_t k = 0; k != scalar_lanes; k++) {
+    res.xx.add(sxx[k]);
+    res.xy.add(sxy[k]);
+    res.yy.add(syy[k]);
+  }
+  return res;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                    avx2                                    */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief TwoSum on every lane: s += v, c accumulating the rounding errors.
+ *
+ */
+AVX2_TARGET inline void two_sum(__m256d &s, __m256d &c, __m256d v) noexcept {
+  const __m256d t = _mm256_add_pd(s, v);
+  const __m256d z = _mm256_sub_pd(t, s);
+  const __m256d e = _mm256_add_pd(_mm256_sub_pd(s, _mm256_sub_pd(t, z)),
+                                  _mm256_sub_pd(v, z));
+  c = _mm256_add_pd(c, e);
+  s = t;
+}
+
+/**
+ * @brief s += a * b on every lane, c accumulating the rounding errors of both
+ * the product and the sum.
+ *
+ */
+AVX2_TARGET inline void two_product_sum(__m256d &s, __m256d &c, __m256d a,
+                                        __m256d b) noexcept {
+  const __m256d p = _mm256_mul_pd(a, b);
+  two_sum(s, c, p);
+  c = _mm256_add_pd(c, _mm256_fmsub_pd(a, b, p));
+}
+
+/**
+ * @brief Adds the lanes of a vector accumulator to a compensated sum.
+ *
+ */
+AVX2_TARGET void drain(Compensated &res, __m256d s, __m256d c) noexcept {
+  alignas(32) double sums[4], errors[4];
+  _mm256_store_pd(sums, s);
+  _mm256_store_pd(errors, c);
+  for (size_t k = 0; k != 4; k++) {
+    res.add(sums[k]);
+    res.error += errors[k];
+  }
+}
+
+AVX2_TARGET Column_Sums sums_avx2(const double *x, const double *y,
+                                  size_t n) noexcept {
+  __m256d sx0 = _mm256_setzero_pd(), cx0 = sx0, sx1 = sx0, cx1 = sx0;
+  __m256d sy0 = sx0, cy0 = sx0, sy1 = sx0, cy1 = sx0;
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    two_sum(sx0, cx0, _mm256_loadu_pd(x + i));
+    two_sum(sx1, cx1, _mm256_loadu_pd(x + i + 4));
+    two_sum(sy0, cy0, _mm256_loadu_pd(y + i));
+    two_sum(sy1, cy1, _mm256_loadu_pd(y + i + 4));
+  }
+
+  Column_Sums res = sums_scalar(x + i, y + i, n - i);
+  drain(res.x, sx0, cx0);
+  drain(res.x, sx1, cx1);
+  drain(res.y, sy0, cy0);
+  drain(res.y, sy1, cy1);
+  return res;
+}
+
+AVX2_TARGET Centered_Sums centered_sums_avx2(const double *x, const double *y,
+                                             size_t n, double mean_x,
+                                             double mean_y) noexcept {
+  const __m256d mx = _mm256_set1_pd(mean_x), my = _mm256_set1_pd(mean_y);
+  __m256d sxx0 = _mm256_setzero_pd(), cxx0 = sxx0, sxx1 = sxx0, cxx1 = sxx0;
+  __m256d sxy0 = sxx0, cxy0 = sxx0, sxy1 = sxx0, cxy1 = sxx0;
+  __m256d syy0 = sxx0, cyy0 = sxx0, syy1 = sxx0, cyy1 = sxx0;
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256d dx0 = _mm256_sub_pd(_mm256_loadu_pd(x + i), mx);
+    const __m256d dx1 = _mm256_sub_pd(_mm256_loadu_pd(x + i + 4), mx);
+    const __m256d dy0 = _mm256_sub_pd(_mm256_loadu_pd(y + i), my);
+    const __m256d dy1 = _mm256_sub_pd(_mm256_loadu_pd(y + i + 4), my);
+    two_product_sum(sxx0, cxx0, dx0, dx0);
+    two_product_sum(sxx1, cxx1, dx1, dx1);
+    two_product_sum(sxy0, cxy0, dx0, dy0);
+    two_product_sum(sxy1, cxy1, dx1, dy1);
+    two_product_sum(syy0, cyy0, dy0, dy0);
+    two_product_sum(syy1, cyy1, dy1, dy1);
+  }
+
+  Centered_Sums res =
+      centered_sums_scalar(x + i, y + i, n - i, mean_x, mean_y);
+  drain(res.xx, sxx0, cxx0);
+  drain(res.xx, sxx1, cxx1);
+  drain(res.xy, sxy0, cxy0);
+  drain(res.xy, sxy1, cxy1);
+  drain(res.yy, syy0, cyy0);
+  drain(res.yy, syy1, cyy1);
+  return res;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   avx512                                   */
+/* -------------------------------------------------------------------------- */
+
+AVX512_TARGET inline void two_sum(__m512d &s, __m512d &c, __m512d v) noexcept {
+  const __m512d t = _mm512_add_pd(s, v);
+  const __m512d z = _mm512_sub_pd(t, s);
+  const __m512d e = _mm512_add_pd(_mm512_sub_pd(s, _mm512_sub_pd(t, z)),
+                                  _mm512_sub_pd(v, z));
+  c = _mm512_add_pd(c, e);
+  s = t;
+}
+
+AVX512_TARGET inline void two_product_sum(__m512d &s, __m512d &c, __m512d a,
+                                          __m512d b) noexcept {
+  const __m512d p = _mm512_mul_pd(a, b);
+  two_sum(s, c, p);
+  c = _mm512_add_pd(c, _mm512_fmsub_pd(a, b, p));
+}
+
+AVX512_TARGET void drain(Compensated &res, __m512d s, __m512d c) noexcept {
+  alignas(64) double sums[8], errors[8];
+  _mm512_store_pd(sums, s);
+  _mm512_store_pd(errors, c);
+  for (size_t k = 0; k != 8; k++) {
+    res.add(sums[k]);
+    res.error += errors[k];
+  }
+}
+
+AVX512_TARGET Column_Sums sums_avx512(const double *x, const double *y,
+                                      size_t n) noexcept {
+  __m512d sx0 = _mm512_setzero_pd(), cx0 = sx0, sx1 = sx0, cx1 = sx0;
+  __m512d sy0 = sx0, cy0 = sx0, sy1 = sx0, cy1 = sx0;
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    two_sum(sx0, cx0, _mm512_loadu_pd(x + i));
+    two_sum(sx1, cx1, _mm512_loadu_pd(x + i + 8));
+    two_sum(sy0, cy0, _mm512_loadu_pd(y + i));
+    two_sum(sy1, cy1, _mm512_loadu_pd(y + i + 8));
+  }
+
+  Column_Sums res = sums_scalar(x + i, y + i, n - i);
+  drain(res.x, sx0, cx0);
+  drain(res.x, sx1, cx1);
+  drain(res.y, sy0, cy0);
+  drain(res.y, sy1, cy1);
+  return res;
+}
+
+AVX512_TARGET Centered_Sums centered_sums_avx512(const double *x,
+                                                 const double *y, size_t n,
+                                                 double mean_x,
+                                                 double mean_y) noexcept {
+  const __m512d mx = _mm512_set1_pd(mean_x), my = _mm512_set1_pd(mean_y);
+  __m512d sxx0 = _mm512_setzero_pd(), cxx0 = sxx0, sxx1 = sxx0, cxx1 = sxx0;
+  __m512d sxy0 = sxx0, cxy0 = sxx0, sxy1 = sxx0, cxy1 = sxx0;
+  __m512d syy0 = sxx0, cyy0 = sxx0, syy1 = sxx0, cyy1 = sxx0;
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m512d dx0 = _mm512_sub_pd(_mm512_loadu_pd(x + i), mx);
+    const __m512d dx1 = _mm512_sub_pd(_mm512_loadu_pd(x + i + 8), mx);
+    const __m512d dy0 = _mm512_sub_pd(_mm512_loadu_pd(y + i), my);
+    const __m512d dy1 = _mm512_sub_pd(_mm512_loadu_pd(y + i + 8), my);
+    two_product_sum(sxx0, cxx0, dx0, dx0);
+    two_product_sum(sxx1, cxx1, dx1, dx1);
+    two_product_sum(sxy0, cxy0, dx0, dy0);
+    two_product_sum(sxy1, cxy1, dx1, dy1);
+    two_product_sum(syy0, cyy0, dy0, dy0);
+    two_product_sum(syy1, cyy1, dy1, dy1);
+  }
+
+  Centered_Sums res =
+      centered_sums_scalar(x + i, y + i, n - i, mean_x, mean_y);
+  drain(res.xx, sxx0, cxx0);
+  drain(res.xx, sxx1, cxx1);
+  drain(res.xy, sxy0, cxy0);
+  drain(res.xy, sxy1, cxy1);
+  drain(res.yy, syy0, cyy0);
+  drain(res.yy, syy1, cyy1);
+  return res;
+}
+
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/*                                  dispatch                                  */
+/* -------------------------------------------------------------------------- */
+
+namespace simd {
+
+bool supported(Isa isa) noexcept {
+  switch (isa) {
+  case Isa::avx512:
+    return __builtin_cpu_supports("avx512f");
+  case Isa::avx2:
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  default:
+    return true;
+  }
+}
+
+Isa detected_isa() noexcept {
+  static const Isa isa = supported(Isa::avx512) ? Isa::avx512
+                         : supported(Isa::avx2) ? Isa::avx2
+                                                : Isa::scalar;
+  return isa;
+}
+
+const char *isa_name(Isa isa) noexcept {
+  switch (isa) {
+  case Isa::avx512:
+    return "avx512";
+  case Isa::avx2:
+    return "avx2";
+  default:
+    return "scalar";
+  }
+}
+
+Column_Sums sums(const double *x, const double *y, size_t n, Isa isa) noexcept {
+  switch (isa) {
+  case Isa::avx512:
+    return sums_avx512(x, y, n);
+  case Isa::avx2:
+    return sums_avx2(x, y, n);
+  default:
+    return sums_scalar(x, y, n);
+  }
+}
+
+Centered_Sums centered_sums(const double *x, const double *y, size_t n,
+                            double mean_x, double mean_y, Isa isa) noexcept {
+  switch (isa) {
+  case Isa::avx512:
+    return centered_sums_avx512(x, y, n, mean_x, mean_y);
+  case Isa::avx2:
+    return centered_sums_avx2(x, y, n, mean_x, mean_y);
+  default:
+    return centered_sums_scalar(x, y, n, mean_x, mean_y);
+  }
+}
+
+} // namespace simd
@@ -0,0 +1,95 @@
+#include "sliding_correlation.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <tbb/parallel_invoke.h>
+
+/* -------------------------------------------------------------------------- */
+/*                             Sliding_Correlation                            */
+/* -------------------------------------------------------------------------- */
+
+Sliding_Correlation::Sliding_Correlation(size_t window, size_t period)
+    : xs(window), ys(window), head(0), count(0),
+      period(period == 0 ? window : period), updates(0) {
+  if (window == 0) {
+    throw std::invalid_argument("empty correlation window");
+  }
+}
+
+void Sliding_Correlation::append(double x, double y) noexcept {
+  const size_t capacity = xs.size();
+  if (count == capacity) {
+    current.pop(xs[head], ys[head]);
+    xs[head] = x;
+    ys[head] = y;
+    head = (head + 1) % capacity;
+  } else {
+    const size_t position = (head + count) % capacity;
+    xs[position] = x;
+    ys[position] = y;
+    count++;
+  }
+  current.push(x, y);
+
+  if (++updates >= period) {
+    reanchor();
+  }
+}
+
+void Sliding_Correlation::append(const double *x, const double *y,
+                                 size_t batch) noexcept {
+  const size_t capacity = xs.size();
+
+  // The batch fills the whole window by itself.
+  if (batch >= capacity) {
+    const size_t skipped = batch - capacity;
+    std::copy(x + skipped, x + batch, xs.begin());
+    std::copy(y + skipped, y + batch, ys.begin());
+    head = 0;
+    count = capacity;
+    reanchor();
+    return;
+  }
+
+  // Moments of what comes in and of what goes out.
+  const size_t evicted = count + batch > capacity ? count + batch - capacity : 0;
+  Moments incoming, outgoing;
+  tbb::parallel_invoke(
+      [&] { incoming = calculate_moments(x, y, batch); },
+      [&] { outgoing = segment_moments(0, evicted); });
+
+  current.remove(outgoing);
+  head = (head + evicted) % capacity;
+  count -= evicted;
+
+  // Copies the batch after the newest measurement, wrapping around.
+  const size_t position = (head + count) % capacity;
+  const size_t first = std::min(batch, capacity - position);
+  std::copy(x, x + first, xs.begin() + position);
+  std::copy(y, y + first, ys.begin() + position);
+  std::copy(x + first, x + batch, xs.begin());
+  std::copy(y + first, y + batch, ys.begin());
+  count += batch;
+
+  current.merge(incoming);
+
+  updates += batch;
+  if (updates >= period) {
+    reanchor();
+  }
+}
+
+void Sliding_Correlation::reanchor() noexcept {
+  current = segment_moments(0, count);
+  updates = 0;
+}
+
+Moments Sliding_Correlation::segment_moments(size_t offset,
+                                             size_t length) const noexcept {
+  const size_t capacity = xs.size();
+  const size_t start = (head + offset) % capacity;
+  const size_t first = std::min(length, capacity - start);
+
+  Moments res = calculate_moments(xs.data() + start, ys.data() + start, first);
+  res.merge(calculate_moments(xs.data(), ys.data(), length - first));
+  return res;
+}
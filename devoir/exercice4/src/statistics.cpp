@@ -0,0 +1,247 @@
+#include "statistics.hpp"
+#include "moments.hpp"
+#include "philox.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+
+/* -------------------------------------------------------------------------- */
+/*                                   helpers                                  */
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+/** Smallest capacity of a compactor. */
+constexpr size_t min_capacity = 8;
+
+/** Number of measurements summarised at once, small enough to stay in L1. */
+constexpr size_t statistics_block = 256;
+
+/** Largest number of measurements of a leaf of the tree of describe. */
+constexpr size_t statistics_grain = 1024 * statistics_block;
+
+/**
+ * @brief Returns the statistics of a column from its moments and sketch.
+ *
+ */
+Column_Statistics column_statistics(const Column_Moments &moments,
+                                    const Quantile_Sketch &sketch) {
+  return {moments.n,
+          moments.mean,
+          moments.m2 / (moments.n - 1.0),
+          std::sqrt(moments.n) * moments.m3 / std::pow(moments.m2, 1.5),
+          moments.n * moments.m4 / (moments.m2 * moments.m2) - 3.0,
+          moments.min,
+          moments.max,
+          sketch};
+}
+
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/*                               Quantile_Sketch                              */
+/* -------------------------------------------------------------------------- */
+
+Quantile_Sketch::Quantile_Sketch(size_t budget, uint64_t seed)
+    : top_capacity(std::max(min_capacity, budget / (3 * sizeof(double)))),
+      retained(0), max_retained(0), count(0.0), state(seed) {
+  grow();
+}
+
+void Quantile_Sketch::grow() {
+  compactors.emplace_back();
+  capacities.resize(compactors.size());
+  max_retained = 0;
+  for (size_t level = 0; level != compactors.size(); level++) {
+    const double depth = static_cast<double>(compactors.size() - 1 - level);
+    capacities[level] = std::max(
+        min_capacity, static_cast<size_t>(std::ceil(
+                          top_capacity * std::pow(2.0 / 3.0, depth))));
+    max_retained += capacities[level];
+  }
+}
+
+void Quantile_Sketch::merge_into(std::vector<double> &sorted, size_t middle) {
+  scratch.resize(sorted.size());
+  std::merge(sorted.begin(), sorted.begin() + middle, sorted.begin() + middle,
+             sorted.end(), scratch.begin());
+  std::swap(sorted, scratch);
+}
+
+void Quantile_Sketch::compress() {
+  for (size_t level = 0; level != compactors.size(); level++) {
+    if (compactors[level].size() < capacities[level]) {
+      continue;
+    }
+    if (level + 1 == compactors.size()) {
+      grow();
+    }
+
+    // The levels above the first stay sorted, so a compaction merges. An odd
+    // value out, the smallest, stays.
+    std::vector<double> &compactor = compactors[level];
+    if (level == 0) {
+      std::sort(compactor.begin(), compactor.end());
+    }
+    const size_t kept = compactor.size() % 2;
+    std::vector<double> &above = compactors[level + 1];
+    const size_t before = above.size();
+    for (size_t i = kept + (splitmix(state) & 1); i < compactor.size();
+         i += 2) {
+      above.push_back(compactor[i]);
+    }
+    merge_into(above, before);
+    retained -= compactor.size() - kept - (above.size() - before);
+    compactor.resize(kept);
+    if (retained < max_retained) {
+      return;
+    }
+  }
+}
+
+void Quantile_Sketch::push(const double *values, size_t count) {
+  this->count += static_cast<double>(count);
+  while (count != 0) {
+    const size_t room = max_retained > retained ? max_retained - retained : 0;
+    const size_t taken = std::min(std::max<size_t>(room, 1), count);
+    compactors[0].insert(compactors[0].end(), values, values + taken);
+    retained += taken;
+    values += taken;
+    count -= taken;
+    if (retained >= max_retained) {
+      compress();
+    }
+  }
+}
+
+void Quantile_Sketch::merge(const Quantile_Sketch &other) {
+  while (compactors.size() < other.compactors.size()) {
+    grow();
+  }
+  for (size_t level = 0; level != other.compactors.size(); level++) {
+    std::vector<double> &compactor = compactors[level];
+    const size_t before = compactor.size();
+    compactor.insert(compactor.end(), other.compactors[level].begin(),
+                     other.compactors[level].end());
+    if (level != 0) {
+      merge_into(compactor, before);
+    }
+    retained += other.compactors[level].size();
+  }
+  count += other.count;
+  while (retained >= max_retained) {
+    compress();
+  }
+}
+
+double Quantile_Sketch::quantile(double q) const {
+  if (count == 0.0) {
+    return NAN;
+  }
+
+  // The values kept, each weighing 2^level of those added.
+  std::vector<std::pair<double, double>> weighted;
+  weighted.reserve(retained);
+  for (size_t level = 0; level != compactors.size(); level++) {
+    for (const double value : compactors[level]) {
+      weighted.emplace_back(value, std::ldexp(1.0, static_cast<int>(level)));
+    }
+  }
+  std::sort(weighted.begin(), weighted.end());
+
+  // The compactions keep the total weight, up to the odd values out.
+  double total = 0.0;
+  for (const auto &value : weighted) {
+    total += value.second;
+  }
+  const double target = q * total;
+  double cumulated = 0.0;
+  for (const auto &value : weighted) {
+    cumulated += value.second;
+    if (cumulated >= target) {
+      return value.first;
+    }
+  }
+  return weighted.back().first;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                   describe                                 */
+/* -------------------------------------------------------------------------- */
+
+class StatisticsReducer {
+  public:
+    const double* x;
+    const double* y;
+    size_t budget;
+    double origin_x;
+    double origin_y;
+    uint64_t seed;
+    bool seeded;
+    Moments moments;
+    Column_Moments x_moments, y_moments;
+    Quantile_Sketch x_sketch, y_sketch;
+
+    StatisticsReducer (const double* x, const double* y, size_t n, size_t budget) : x(x), y(y), budget(budget), origin_x(n != 0 ? x[0] : 0.0), origin_y(n != 0 ? y[0] : 0.0), seed(0), seeded(false), x_sketch(budget), y_sketch(budget) {}
+
+    StatisticsReducer (const StatisticsReducer& other, tbb::split) : x(other.x), y(other.y), budget(other.budget), origin_x(other.origin_x), origin_y(other.origin_y), seed(other.seed), seeded(false), x_sketch(budget), y_sketch(budget) {}
+
+    void operator() (const tbb::blocked_range<size_t>& r) {
+      // Every reducer draws the coins of its sketches from the seed mixed with
+      // its first measurement. The splits of describe depend on n only, so do
+      // the coins, and the sketches do not depend on the threads.
+      if (not seeded) {
+        uint64_t state = seed ^ r.begin();
+        x_sketch = Quantile_Sketch(budget, splitmix(state));
+        y_sketch = Quantile_Sketch(budget, splitmix(state));
+        seeded = true;
+      }
+      // All the moments are taken from the first measurement, like those of
+      // calculate_moments, and the blocks of the range merged pairwise.
+      Pairwise_Merger<Moments> range_moments;
+      Pairwise_Merger<Column_Moments> range_x_moments, range_y_moments;
+      for (size_t i = r.begin(); i < r.end(); i += statistics_block) {
+        const size_t count = std::min(statistics_block, r.end() - i);
+        range_moments.push(Moments::of(x + i, y + i, count, origin_x, origin_y));
+        range_x_moments.push(Column_Moments::of(x + i, count, origin_x));
+        range_y_moments.push(Column_Moments::of(y + i, count, origin_y));
+        x_sketch.push(x + i, count);
+        y_sketch.push(y + i, count);
+      }
+      moments.merge(range_moments.total());
+      x_moments.merge(range_x_moments.total());
+      y_moments.merge(range_y_moments.total());
+    }
+
+    void join (const StatisticsReducer& other) {
+      moments.merge(other.moments);
+      x_moments.merge(other.x_moments);
+      y_moments.merge(other.y_moments);
+      x_sketch.merge(other.x_sketch);
+      y_sketch.merge(other.y_sketch);
+    }
+};
+
+Statistics describe(const Data_Set &data_set, size_t sketch_budget) {
+
+  StatisticsReducer statistics_reducer(data_set.x, data_set.y, data_set.n, sketch_budget);
+  // The range is halved down to the grain whatever the number of threads, and
+  // every half gets its own reducer, as in calculate_moments_deterministic.
+  tbb::parallel_deterministic_reduce(
+      tbb::blocked_range<size_t>(0, data_set.n, statistics_grain), statistics_reducer,
+      tbb::simple_partitioner());
+
+  // Moves the moments back from the first measurement.
+  if (data_set.n != 0) {
+    statistics_reducer.moments.shift(statistics_reducer.origin_x, statistics_reducer.origin_y);
+    statistics_reducer.x_moments.shift(statistics_reducer.origin_x);
+    statistics_reducer.y_moments.shift(statistics_reducer.origin_y);
+  }
+
+  return {statistics_reducer.moments.correlation(),
+          column_statistics(statistics_reducer.x_moments, statistics_reducer.x_sketch),
+          column_statistics(statistics_reducer.y_moments, statistics_reducer.y_sketch)};
+}
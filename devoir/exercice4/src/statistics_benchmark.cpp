@@ -0,0 +1,226 @@
+#include "cpp_argv.hpp"
+#include "correlation.hpp"
+#include "data_set.hpp"
+#include "statistics.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
+#include <tbb/blocked_range.h>
+#include <tbb/global_control.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/parallel_sort.h>
+
+#define DEFAULT_NAME "exercice4_statistics"
+
+/** Probabilities of the quantiles checked. */
+static const double probabilities[] = {0.001, 0.01, 0.05, 0.1, 0.25, 0.5,
+                                       0.75,  0.9,  0.95, 0.99, 0.999};
+
+/**
+ * @brief Builds a synthetic data set: x is exponential, so skewed, and y a
+ * line of it with uniform noise.
+ *
+ * @param n The number of measurements.
+ * @return Data_Set The data set.
+ */
+static Data_Set make_skewed_data_set(size_t n) {
+  const std::shared_ptr<double[]> columns(new double[2 * n]);
+  double *const x = columns.get();
+  double *const y = x + n;
+
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, n),
+                    [x, y](const tbb::blocked_range<size_t> &r) {
+                      for (size_t i = r.begin(); i != r.end(); i++) {
+                        uint64_t z = i * 0x9e3779b97f4a7c15ULL;
+                        z = (z ^ (z >> 31)) * 0xbf58476d1ce4e5b9ULL;
+                        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+                        const double u = ((z >> 11) + 0.5) * 0x1.0p-53;
+                        const double v = (z & 0x7ff) / 2048.0;
+                        x[i] = -std::log(u);
+                        y[i] = 2.0 * x[i] + 1.0 + v;
+                      }
+                    });
+
+  Data_Set res;
+  res.n = n;
+  res.x = x;
+  res.y = y;
+  res.storage = columns;
+  return res;
+}
+
+/**
+ * @brief Sums f(i) over [0, n) in a parallel pass.
+ *
+ */
+static double pass(size_t n, const std::function<double(size_t)> &f,
+                   const std::function<double(double, double)> &combine =
+                       std::plus<double>(),
+                   double identity = 0.0) {
+  return tbb::parallel_reduce(
+      tbb::blocked_range<size_t>(0, n), identity,
+      [&](const tbb::blocked_range<size_t> &r, double res) {
+        for (size_t i = r.begin(); i != r.end(); i++) {
+          res = combine(res, f(i));
+        }
+        return res;
+      },
+      combine);
+}
+
+/**
+ * @brief Calculates the statistics of a column as one would without describe:
+ * a pass per statistic, and the quantiles of a sorted copy.
+ *
+ * @param sorted Set to the sorted copy.
+ */
+static Column_Statistics multi_pass(const double *values, size_t n,
+                                    std::vector<double> &sorted) {
+  const double count = static_cast<double>(n);
+  const double mean = pass(n, [=](size_t i) { return values[i]; }) / count;
+  const auto centered = [=](int power) {
+    return pass(n, [=](size_t i) { return std::pow(values[i] - mean, power); });
+  };
+  const double m2 = centered(2), m3 = centered(3), m4 = centered(4);
+  const double min = pass(
+      n, [=](size_t i) { return values[i]; },
+      [](double lhs, double rhs) { return std::min(lhs, rhs); }, INFINITY);
+  const double max = pass(
+      n, [=](size_t i) { return values[i]; },
+      [](double lhs, double rhs) { return std::max(lhs, rhs); }, -INFINITY);
+  sorted.assign(values, values + n);
+  tbb::parallel_sort(sorted.begin(), sorted.end());
+  return {count,
+          mean,
+          m2 / (count - 1.0),
+          std::sqrt(count) * m3 / std::pow(m2, 1.5),
+          count * m4 / (m2 * m2) - 3.0,
+          min,
+          max,
+          Quantile_Sketch()};
+}
+
+/**
+ * @brief Returns the largest distance between the probability of a quantile
+ * and the range of ranks, over the sorted values, of its estimate.
+ *
+ */
+static double rank_error(const Column_Statistics &statistics,
+                         const std::vector<double> &sorted) {
+  const double n = static_cast<double>(sorted.size());
+  double res = 0.0;
+  for (const double q : probabilities) {
+    const double estimate = statistics.quantile(q);
+    const double low =
+        (std::lower_bound(sorted.begin(), sorted.end(), estimate) -
+         sorted.begin()) / n;
+    const double high =
+        (std::upper_bound(sorted.begin(), sorted.end(), estimate) -
+         sorted.begin()) / n;
+    res = std::max(res, q < low ? low - q : q > high ? q - high : 0.0);
+  }
+  return res;
+}
+
+/**
+ * @brief Returns the largest relative difference of the moments of a column.
+ *
+ */
+static double moment_difference(const Column_Statistics &lhs,
+                                const Column_Statistics &rhs) {
+  double res = 0.0;
+  for (const auto &pair : {std::make_pair(lhs.mean, rhs.mean),
+                           std::make_pair(lhs.variance, rhs.variance),
+                           std::make_pair(lhs.skewness, rhs.skewness),
+                           std::make_pair(lhs.kurtosis, rhs.kurtosis)}) {
+    res = std::max(res, std::fabs(pair.first - pair.second) /
+                            std::fabs(pair.second));
+  }
+  return res;
+}
+
+/**
+ * @brief Returns the duration of a call, in seconds.
+ *
+ */
+template <typename Function> static double time_it(const Function &f) {
+  const auto start = std::chrono::steady_clock::now();
+  f();
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(stop - start).count();
+}
+
+/**
+ * @brief Times the statistics of a skewed data set calculated with a pass per
+ * statistic and a sort for the quantiles, then in a single pass by describe
+ * with sketches of growing budgets, and reports the error of the latter.
+ *
+ * @param argc number of arguments in the command line.
+ * @param argv arguments of the command line.
+ * @return @c EXIT_SUCCESS if command succeeds else @c EXIT_FAILURE.
+ */
+int main(int argc, char *argv[]) {
+
+  // User expects help.
+  CPP_ARGV_TEST_HELP_REQUEST(argc, argv[0], DEFAULT_NAME, "size")
+
+  // Bad argument number.
+  CPP_ARGV_TEST_ARG_NUM(argc, 2)
+
+  // Retrieves the size.
+  size_t n;
+  {
+    std::istringstream size_arg(argv[1]);
+    size_arg >> n;
+    if (not size_arg or n < 2) {
+      std::cerr << "Bad argument" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  const Data_Set data_set = make_skewed_data_set(n);
+
+  std::vector<double> sorted_x, sorted_y;
+  Correlation correlation{};
+  Column_Statistics x, y;
+  const double multi_pass_time = time_it([&] {
+    correlation = calculate(data_set);
+    x = multi_pass(data_set.x, n, sorted_x);
+    y = multi_pass(data_set.y, n, sorted_y);
+  });
+
+  std::cout << "Thread(s):\t"
+            << tbb::global_control::active_value(
+                   tbb::global_control::max_allowed_parallelism)
+            << std::endl;
+  std::cout << "multi-pass (s):\t" << multi_pass_time << std::endl;
+  std::cout << "budget (B)\tone pass (s)\tspeedup\tmax rank error"
+               "\tmax relative moment difference\t|r difference|"
+            << std::endl;
+
+  for (size_t budget = 4096; budget <= 65536; budget *= 4) {
+    Statistics statistics;
+    const double one_pass_time =
+        time_it([&] { statistics = describe(data_set, budget); });
+    std::cout << budget << '\t' << one_pass_time << '\t'
+              << multi_pass_time / one_pass_time << '\t'
+              << std::max(rank_error(statistics.x, sorted_x),
+                          rank_error(statistics.y, sorted_y))
+              << '\t'
+              << std::max(moment_difference(statistics.x, x),
+                          moment_difference(statistics.y, y))
+              << '\t' << std::fabs(statistics.correlation.r - correlation.r)
+              << std::endl;
+  }
+
+  // It's over.
+  return EXIT_SUCCESS;
+}
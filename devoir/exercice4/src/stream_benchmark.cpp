@@ -0,0 +1,126 @@
+#include "cpp_argv.hpp"
+#include "stream_correlation.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <system_error>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <tbb/global_control.h>
+
+#define DEFAULT_NAME "exercice4_stream"
+
+/**
+ * @brief Drops the pages of a file from the page cache, so that the next read
+ * comes from the disk.
+ *
+ * @return size_t The size of the file, in bytes.
+ */
+static size_t evict(const char *filename) {
+  const int fd = ::open(filename, O_RDONLY);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(), filename);
+  }
+  ::fdatasync(fd);
+  ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  const off_t size = ::lseek(fd, 0, SEEK_END);
+  ::close(fd);
+  return static_cast<size_t>(size);
+}
+
+/**
+ * @brief Reads a whole file sequentially, doing nothing with it.
+ *
+ */
+static void read_through(const char *filename, size_t chunk_bytes) {
+  const int fd = ::open(filename, O_RDONLY);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(), filename);
+  }
+  ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  std::vector<char> buffer(chunk_bytes);
+  while (::read(fd, buffer.data(), buffer.size()) > 0) {
+  }
+  ::close(fd);
+}
+
+/**
+ * @brief Returns the duration of a call, in seconds.
+ *
+ */
+template <typename Function> static double time_it(Function function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(stop - start).count();
+}
+
+/**
+ * @brief Compares the sustained throughput of the streaming calculation with
+ * the bandwidth of a plain sequential read of the same file, both from the
+ * disk, then with the file in the page cache.
+ *
+ * @param argc number of arguments in the command line.
+ * @param argv arguments of the command line.
+ * @return @c EXIT_SUCCESS if command succeeds else @c EXIT_FAILURE.
+ */
+int main(int argc, char *argv[]) {
+
+  // User expects help.
+  CPP_ARGV_TEST_HELP_REQUEST(argc, argv[0], DEFAULT_NAME,
+                             "filename chunk_megabytes")
+
+  // Bad argument number.
+  CPP_ARGV_TEST_ARG_NUM(argc, 3)
+
+  // Retrieves the file name and the buffer size.
+  const char *const filename = argv[1];
+  size_t chunk_bytes;
+  {
+    std::istringstream chunk_arg(argv[2]);
+    chunk_arg >> chunk_bytes;
+    if (not chunk_arg or chunk_bytes == 0) {
+      std::cerr << "Bad argument" << std::endl;
+      return EXIT_FAILURE;
+    }
+    chunk_bytes *= 1024 * 1024;
+  }
+
+  const int threads = tbb::global_control::active_value(
+      tbb::global_control::max_allowed_parallelism);
+
+  try {
+    const double megabytes = evict(filename) / 1e6;
+    const double disk_time =
+        time_it([&] { read_through(filename, chunk_bytes); });
+
+    Moments moments;
+    evict(filename);
+    const double cold_time =
+        time_it([&] { moments = stream_moments(filename, chunk_bytes); });
+    const double warm_time =
+        time_it([&] { moments = stream_moments(filename, chunk_bytes); });
+
+    std::cout << "Thread(s):\t" << threads << std::endl;
+    std::cout << "File:\t\t" << megabytes << " MB" << std::endl;
+    std::cout << "Buffers:\t2 x " << chunk_bytes / (1024 * 1024) << " MiB"
+              << std::endl;
+    std::cout << "disk read:\t" << disk_time << " s\t"
+              << megabytes / disk_time << " MB/s" << std::endl;
+    std::cout << "stream, cold:\t" << cold_time << " s\t"
+              << megabytes / cold_time << " MB/s" << std::endl;
+    std::cout << "stream, warm:\t" << warm_time << " s\t"
+              << megabytes / warm_time << " MB/s" << std::endl;
+    std::cout << "Efficiency:\t" << disk_time / cold_time << std::endl;
+    std::cout << "r:\t\t" << moments.correlation().r << std::endl;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // It's over.
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,341 @@
+#include "stream_correlation.hpp"
+#include "binary_format.hpp"
+#include "text_scan.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+/* -------------------------------------------------------------------------- */
+/*                                   helpers                                  */
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+using namespace text_scan;
+
+/** Approximate size, in bytes, of the text reduced by a single task. */
+constexpr size_t part_size = 1024 * 1024;
+
+/** Number of measurements parsed before their moments are calculated. */
+constexpr size_t block = 256;
+
+/** Smallest buffer size. */
+constexpr size_t min_chunk = 4096;
+
+/**
+ * @brief File read with positioned reads, which several threads may issue at
+ * once.
+ *
+ */
+class Input_File {
+public:
+  /**
+   * @brief Opens a file for sequential reading.
+   *
+   * @throw std::system_error If the file cannot be opened.
+   */
+  explicit Input_File(const char *filename)
+      : name(filename), fd(::open(filename, O_RDONLY)) {
+    if (fd < 0) {
+      throw std::system_error(errno, std::generic_category(), filename);
+    }
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  }
+
+  Input_File(const Input_File &) = delete;
+  Input_File &operator=(const Input_File &) = delete;
+
+  /**
+   * @brief Closes the file.
+   *
+   */
+  ~Input_File() { ::close(fd); }
+
+  /**
+   * @brief Reads count bytes at an offset, or fewer at the end of the file.
+   *
+   * @return size_t The number of bytes read.
+   * @throw std::system_error If the file cannot be read.
+   */
+  size_t read(char *buffer, size_t count, uint64_t offset) const {
+    size_t done = 0;
+    while (done != count) {
+      const ssize_t res = ::pread(fd, buffer + done, count - done,
+                                  static_cast<off_t>(offset + done));
+      if (res < 0 && errno == EINTR) {
+        continue;
+      }
+      if (res < 0) {
+        throw std::system_error(errno, std::generic_category(), name);
+      }
+      if (res == 0) {
+        break;
+      }
+      done += static_cast<size_t>(res);
+    }
+    return done;
+  }
+
+  /**
+   * @brief Returns the size of the file, in bytes.
+   *
+   * @throw std::system_error If it cannot be known.
+   */
+  uint64_t size() const {
+    struct stat status;
+    if (::fstat(fd, &status) != 0) {
+      throw std::system_error(errno, std::generic_category(), name);
+    }
+    return static_cast<uint64_t>(status.st_size);
+  }
+
+private:
+  const char *name; /** File name, for the errors. */
+  int fd;           /** File descriptor.            */
+};
+
+/**
+ * @brief Calculates, in parallel, the moments of the first lines of a chunk of
+ * text made of whole "x y" lines.
+ *
+ * The chunk is split into parts like in parse_columns; every part parses its
+ * lines by blocks and merges their moments, then the moments of the parts are
+ * merged in order.
+ *
+ * @param limit The number of lines to take at most.
+ * @param rows Where to write the number of lines taken.
+ * @throw std::runtime_error If a line taken is malformed.
+ */
+Moments reduce_lines(const char *begin, const char *end, size_t limit,
+                     size_t &rows) {
+  const size_t length = static_cast<size_t>(end - begin);
+  const size_t parts = length / part_size + 1;
+  std::vector<const char *> bounds(parts + 1);
+  bounds[0] = begin;
+  for (size_t c = 1; c != parts; ++c) {
+    const char *const nominal = begin + length / parts * c;
+    const char *const start = nominal < bounds[c - 1] ? bounds[c - 1] : nominal;
+    const char *const eol = line_end(start, end);
+    bounds[c] = eol == end ? end : eol + 1;
+  }
+  bounds[parts] = end;
+
+  std::vector<size_t> offsets(parts + 1, 0);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, parts),
+                    [&](const tbb::blocked_range<size_t> &r) {
+                      for (size_t c = r.begin(); c != r.end(); ++c) {
+                        offsets[c + 1] = count_rows(bounds[c], bounds[c + 1]);
+                      }
+                    });
+  for (size_t c = 0; c != parts; ++c) {
+    offsets[c + 1] += offsets[c];
+  }
+
+  std::vector<Moments> moments(parts);
+  std::vector<const char *> errors(parts, nullptr);
+  tbb::parallel_for(
+      tbb::blocked_range<size_t>(0, parts),
+      [&](const tbb::blocked_range<size_t> &r) {
+        // x in the first half, y in the second one.
+        double values[2 * block];
+        for (size_t c = r.begin(); c != r.end(); ++c) {
+          Block_Moments part;
+          size_t row = offsets[c], count = 0;
+          for (const char *p = bounds[c]; p < bounds[c + 1] && row < limit;) {
+            const char *const eol = line_end(p, bounds[c + 1]);
+            if (skip_blanks(p, eol) != eol) {
+              if (not parse_row(p, eol, values + count, 2, block)) {
+                errors[c] = p;
+                break;
+              }
+              if (++count == block) {
+                part.push(values, values + block, count);
+                count = 0;
+              }
+              ++row;
+            }
+            p = eol + 1;
+          }
+          part.push(values, values + block, count);
+          moments[c] = part.total();
+        }
+      });
+
+  for (const char *const error : errors) {
+    if (error != nullptr) {
+      throw std::runtime_error("malformed measurement: \"" +
+                               std::string(error, line_end(error, end)) + '"');
+    }
+  }
+
+  Pairwise_Merger<Moments> res;
+  for (const Moments &part : moments) {
+    res.push(part);
+  }
+  rows = std::min(offsets[parts], limit);
+  return res.total();
+}
+
+/**
+ * @brief Streams a text file: the chunks end at their last newline, the rest
+ * of the line being carried over to the start of the next chunk.
+ *
+ */
+Moments stream_text(const Input_File &file, size_t chunk_bytes) {
+  // A small file fits in a single, shorter, chunk.
+  chunk_bytes = static_cast<size_t>(
+      std::min<uint64_t>(chunk_bytes, file.size() + 1));
+  const std::unique_ptr<char[]> buffers[2] = {
+      std::unique_ptr<char[]>(new char[chunk_bytes]),
+      std::unique_ptr<char[]>(new char[chunk_bytes])};
+
+  // Copies the carried over text, then fills the rest of the buffer.
+  const auto read_chunk = [&file, chunk_bytes](char *buffer, const char *carry,
+                                               size_t carried, uint64_t offset) {
+    if (carried != 0) {
+      std::memcpy(buffer, carry, carried);
+    }
+    return carried + file.read(buffer + carried, chunk_bytes - carried, offset);
+  };
+
+  size_t filled = read_chunk(buffers[0].get(), nullptr, 0, 0);
+  uint64_t offset = filled;
+  bool last = filled != chunk_bytes;
+
+  size_t n;
+  const char *begin =
+      parse_header(buffers[0].get(), buffers[0].get() + filled, n);
+  if (begin == nullptr || (begin == buffers[0].get() + filled && not last)) {
+    throw std::runtime_error("malformed header: expected the number of measurements");
+  }
+
+  Pairwise_Merger<Moments> res;
+  size_t rows = 0;
+  for (size_t k = 0;; k ^= 1) {
+    const char *const end = buffers[k].get() + filled;
+    const char *cut = end;
+    if (not last) {
+      const void *const eol =
+          ::memrchr(begin, '\n', static_cast<size_t>(end - begin));
+      if (eol == nullptr) {
+        throw std::runtime_error("line longer than the chunk size");
+      }
+      cut = static_cast<const char *>(eol) + 1;
+    }
+
+    // Reads the next chunk while this one is reduced.
+    const size_t carried = static_cast<size_t>(end - cut);
+    std::future<size_t> next;
+    if (not last) {
+      next = std::async(std::launch::async, read_chunk, buffers[k ^ 1].get(),
+                        cut, carried, offset);
+    }
+
+    size_t count;
+    res.push(reduce_lines(begin, cut, n - rows, count));
+    rows += count;
+
+    if (last) {
+      break;
+    }
+    filled = next.get();
+    offset += filled - carried;
+    last = filled != chunk_bytes;
+    begin = buffers[k ^ 1].get();
+    if (rows == n) {
+      break;
+    }
+  }
+
+  if (rows < n) {
+    throw std::runtime_error("expected " + std::to_string(n) +
+                             " measurements, found " + std::to_string(rows));
+  }
+  return res.total();
+}
+
+/**
+ * @brief Streams a binary file: every chunk holds the same range of rows of
+ * both columns, each one in half of the buffer.
+ *
+ */
+Moments stream_binary(const Input_File &file, const Binary_Header &header,
+                      size_t chunk_bytes) {
+  check_binary_header(header, file.size());
+
+  const size_t rows = static_cast<size_t>(std::max<uint64_t>(
+      1, std::min<uint64_t>(chunk_bytes / (2 * sizeof(double)), header.n)));
+  const std::unique_ptr<double[]> buffers[2] = {
+      std::unique_ptr<double[]>(new double[2 * rows]),
+      std::unique_ptr<double[]>(new double[2 * rows])};
+
+  // Reads the rows [first, first + rows) of both columns, or fewer at the end.
+  const auto read_chunk = [&file, &header, rows](double *buffer,
+                                                 uint64_t first) {
+    const size_t count =
+        static_cast<size_t>(std::min<uint64_t>(rows, header.n - first));
+    const size_t bytes = count * sizeof(double);
+    const uint64_t position = first * sizeof(double);
+    if (file.read(reinterpret_cast<char *>(buffer), bytes,
+                  header.x_offset + position) != bytes ||
+        file.read(reinterpret_cast<char *>(buffer + rows), bytes,
+                  header.y_offset + position) != bytes) {
+      throw std::runtime_error("truncated binary data set");
+    }
+    return count;
+  };
+
+  Pairwise_Merger<Moments> res;
+  size_t count = read_chunk(buffers[0].get(), 0);
+  for (uint64_t first = 0, k = 0; first != header.n; k ^= 1) {
+    const uint64_t after = first + count;
+
+    // Reads the next chunk while this one is reduced.
+    std::future<size_t> next;
+    if (after != header.n) {
+      next = std::async(std::launch::async, read_chunk, buffers[k ^ 1].get(),
+                        after);
+    }
+
+    res.push(calculate_moments(buffers[k].get(), buffers[k].get() + rows,
+                               count));
+
+    first = after;
+    count = next.valid() ? next.get() : 0;
+  }
+  return res.total();
+}
+
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/*                               stream_moments                               */
+/* -------------------------------------------------------------------------- */
+
+Moments stream_moments(const char *filename, size_t chunk_bytes) {
+  if (chunk_bytes < min_chunk) {
+    throw std::invalid_argument("the chunk size must be at least 4 KiB");
+  }
+
+  const Input_File file(filename);
+
+  Binary_Header header{};
+  const size_t head =
+      file.read(reinterpret_cast<char *>(&header), sizeof header, 0);
+  if (is_binary(reinterpret_cast<const char *>(&header), head)) {
+    return stream_binary(file, header, chunk_bytes);
+  }
+  return stream_text(file, chunk_bytes);
+}
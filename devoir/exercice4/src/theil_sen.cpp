@@ -0,0 +1,512 @@
+#include "theil_sen.hpp"
+#include "philox.hpp"
+#include "rank_correlation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
+#include <tbb/parallel_sort.h>
+
+/* -------------------------------------------------------------------------- */
+/*                                   helpers                                  */
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+/** Size below which sorts run sequentially. */
+constexpr size_t cutoff = 16 * 1024;
+
+/** Size below which sorts are insertion sorts. */
+constexpr size_t insertion_cutoff = 16;
+
+/** Number of slopes per measurement below which an interval is listed. */
+constexpr uint64_t listing_factor = 8;
+
+/** Half-width of the interval kept around the wanted ranks, in standard
+ * deviations of their position in a sample. */
+constexpr double spread = 3.0;
+
+constexpr double infinity = std::numeric_limits<double>::infinity();
+
+/**
+ * @brief Measurements sorted by x then y.
+ *
+ */
+struct Sorted_Points {
+  std::vector<double> x;
+  std::vector<double> y;
+  uint64_t duplicates; /** Pairs of equal measurements. */
+};
+
+/**
+ * @brief Measurement of a merge sort, with its key, carried along so that the
+ * slopes drawn in a merge read the runs being merged only.
+ *
+ */
+struct Item {
+  double key; /** Key of the sort. */
+  double x;
+  double y;
+};
+
+/**
+ * @brief Draws each of a sequence of inversions with a probability, skipping
+ * a geometric number of them between two draws so that the cost is that of
+ * the drawn ones.
+ *
+ */
+class Inversion_Sampler {
+public:
+  /**
+   * @brief Builds the sampler of a node of a merge sort.
+   *
+   * @param philox The generator.
+   * @param node The node, which is also the stream of the generator.
+   * @param round The round of the selection.
+   * @param probability The probability of each inversion, in (0, 1].
+   */
+  Inversion_Sampler(const Philox &philox, uint64_t node, uint64_t round,
+                    double probability) noexcept
+      : state(philox(node, round)[0]),
+        log_q(probability < 1.0 ? std::log1p(-probability) : 0.0),
+        skip(draw()) {}
+
+  /**
+   * @brief Passes the next count inversions, calling keep with the offset of
+   * each drawn one.
+   *
+   */
+  template <typename Keep> void pass(size_t count, const Keep &keep) {
+    size_t offset = 0;
+    while (skip < count - offset) {
+      offset += skip;
+      keep(offset++);
+      skip = draw();
+    }
+    skip -= count - offset;
+  }
+
+private:
+  uint64_t state; /** State of the splitmix64 sequence. */
+  double log_q;   /** Log of the probability to skip.   */
+  size_t skip;    /** Inversions left before a draw.    */
+
+  /**
+   * @brief Returns a number of inversions to skip.
+   *
+   */
+  size_t draw() noexcept {
+    if (log_q == 0.0) {
+      return 0;
+    }
+    const double u = static_cast<double>((splitmix(state) >> 11) + 1) * 0x1.0p-53;
+    return static_cast<size_t>(std::min(std::floor(std::log(u) / log_q), 1e18));
+  }
+};
+
+/**
+ * @brief Shared state of a merge sort drawing slopes.
+ *
+ */
+struct Sampling {
+  const Philox &philox;
+  uint64_t round;
+  double probability;
+  tbb::enumerable_thread_specific<std::vector<double>> slopes;
+};
+
+/**
+ * @brief Returns the slope of a pair of items.
+ *
+ */
+inline double slope(const Item &lhs, const Item &rhs) noexcept {
+  return (rhs.y - lhs.y) / (rhs.x - lhs.x);
+}
+
+/**
+ * @brief Sorts items by key with a merge sort, drawing the inversions met on
+ * the way, the pairs of items whose keys are in decreasing order.
+ *
+ * @param buffer Room for n items.
+ * @param node The node of the recursion, 1 for the root, 2k and 2k + 1 for
+ * the children of k.
+ */
+void sort_sample(Item *items, Item *buffer, size_t n, uint64_t node,
+                 Sampling &sampling) {
+  Inversion_Sampler sampler(sampling.philox, node, sampling.round,
+                            sampling.probability);
+
+  if (n <= insertion_cutoff) {
+    std::vector<double> &slopes = sampling.slopes.local();
+    for (size_t i = 1; i < n; i++) {
+      const Item item = items[i];
+      size_t j = i;
+      while (j != 0 && item.key < items[j - 1].key) {
+        items[j] = items[j - 1];
+        j--;
+      }
+      // The items passed over are now in (j, i].
+      sampler.pass(i - j, [&](size_t offset) {
+        slopes.push_back(slope(items[j + 1 + offset], item));
+      });
+      items[j] = item;
+    }
+    return;
+  }
+
+  const size_t half = n / 2;
+  if (n > cutoff) {
+    tbb::parallel_invoke(
+        [&] { sort_sample(items, buffer, half, 2 * node, sampling); },
+        [&] {
+          sort_sample(items + half, buffer + half, n - half, 2 * node + 1,
+                      sampling);
+        });
+  } else {
+    sort_sample(items, buffer, half, 2 * node, sampling);
+    sort_sample(items + half, buffer + half, n - half, 2 * node + 1, sampling);
+  }
+
+  // The thread is the one of the recursive calls, parallel_invoke waiting.
+  std::vector<double> &slopes = sampling.slopes.local();
+  size_t p = 0, q = half;
+  Item *out = buffer;
+  while (p != half && q != n) {
+    if (items[q].key < items[p].key) {
+      sampler.pass(half - p, [&](size_t offset) {
+        slopes.push_back(slope(items[p + offset], items[q]));
+      });
+      *out++ = items[q++];
+    } else {
+      *out++ = items[p++];
+    }
+  }
+  out = std::copy(items + p, items + half, out);
+  std::copy(buffer, out, items);
+}
+
+/**
+ * @brief Draws each slope in [lo, hi), or in (lo, hi), with a probability.
+ *
+ * In the order of y - lo * x, ties broken by the order of x then y, the pairs
+ * whose slope is at least lo are in the order of x; ties broken the other way
+ * round, those whose slope is above lo. Among them, those whose slope is
+ * below hi are the inversions of y - hi * x. A pair of equal x is never one
+ * of them.
+ *
+ * @param lo The lower bound, -infinity for the order of x.
+ * @param open Whether lo itself is excluded.
+ * @param hi The upper bound, +infinity for -x.
+ * @param round The round of the selection.
+ */
+std::vector<double> sample_slopes(const Sorted_Points &points, double lo,
+                                  bool open, double hi, double probability,
+                                  uint64_t round, const Philox &philox) {
+  const size_t n = points.x.size();
+  std::vector<Item> items(n);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, n),
+                    [&](const tbb::blocked_range<size_t> &r) {
+                      for (size_t k = r.begin(); k != r.end(); k++) {
+                        const double x = points.x[k], y = points.y[k];
+                        items[k] = {lo == -infinity ? 0.0 : y - lo * x, x, y};
+                      }
+                    });
+  if (lo != -infinity) {
+    tbb::parallel_sort(items.begin(), items.end(),
+                       [open](const Item &lhs, const Item &rhs) {
+                         if (lhs.key != rhs.key) {
+                           return lhs.key < rhs.key;
+                         }
+                         const bool before =
+                             lhs.x < rhs.x || (lhs.x == rhs.x && lhs.y < rhs.y);
+                         const bool after =
+                             rhs.x < lhs.x || (rhs.x == lhs.x && rhs.y < lhs.y);
+                         return open ? after : before;
+                       });
+  }
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, n),
+                    [&](const tbb::blocked_range<size_t> &r) {
+                      for (size_t k = r.begin(); k != r.end(); k++) {
+                        Item &item = items[k];
+                        item.key = hi == infinity ? -item.x
+                                                  : item.y - hi * item.x;
+                      }
+                    });
+
+  Sampling sampling{philox, round, probability, {}};
+  std::vector<Item> buffer(n);
+  sort_sample(items.data(), buffer.data(), n, 1, sampling);
+
+  std::vector<double> res;
+  sampling.slopes.combine_each([&](const std::vector<double> &slopes) {
+    res.insert(res.end(), slopes.begin(), slopes.end());
+  });
+  return res;
+}
+
+/**
+ * @brief Selects the slopes of ranks first and last, counting from 0.
+ *
+ * The interval from lo to hi holds them as long as the number of slopes
+ * before it is at most first and the number before hi more than last. Each
+ * round draws about n of the slopes in it, then narrows it to the sample
+ * order statistics a few standard deviations around the wanted ranks,
+ * whichever of the two still holds them. A statistic drawn several times may
+ * be the slope of many pairs, which no interval starting at it could leave
+ * out: the slopes up to it are counted as well, to tell whether it is one of
+ * the wanted ones, and the interval then starts right after it.
+ *
+ * @param valid The number of pairs of different x.
+ * @param first The first rank.
+ * @param last The last rank, first or first + 1.
+ */
+std::pair<double, double> select_slopes(const Sorted_Points &points,
+                                        uint64_t valid, uint64_t first,
+                                        uint64_t last) {
+  const size_t n = points.x.size();
+  const Philox philox(0);
+
+  // Slopes below t, then slopes up to t: all the pairs but those whose
+  // y - t * x increases, the inversions of the reversed sequence, and those
+  // of equal measurements.
+  std::vector<double> work(n);
+  const auto count_below = [&](double t) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, n),
+                      [&](const tbb::blocked_range<size_t> &r) {
+                        for (size_t k = r.begin(); k != r.end(); k++) {
+                          work[k] = points.y[k] - t * points.x[k];
+                        }
+                      });
+    return sort_count_inversions(work.data(), n);
+  };
+  const auto count_up_to = [&](double t) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, n),
+                      [&](const tbb::blocked_range<size_t> &r) {
+                        for (size_t k = r.begin(); k != r.end(); k++) {
+                          work[n - 1 - k] = points.y[k] - t * points.x[k];
+                        }
+                      });
+    return static_cast<uint64_t>(n) * (n - 1) / 2 -
+           sort_count_inversions(work.data(), n) - points.duplicates;
+  };
+
+  double lo = -infinity, hi = infinity, low = NAN;
+  bool open = false;
+  uint64_t below = 0, up_to = valid;
+  for (uint64_t round = 0;; round++) {
+    const uint64_t inside = up_to - below;
+
+    if (inside <= listing_factor * n) {
+      std::vector<double> slopes =
+          sample_slopes(points, lo, open, hi, 1.0, round, philox);
+      if (slopes.empty()) {
+        // Only rounding can empty a non-empty interval.
+        return {std::isnan(low) ? lo : low, lo};
+      }
+      // Rounding may also add or drop a slope at the ends of the interval.
+      const size_t i = std::min<uint64_t>(first - below, slopes.size() - 1);
+      std::nth_element(slopes.begin(), slopes.begin() + i, slopes.end());
+      const double high =
+          last == first || i + 1 == slopes.size()
+              ? slopes[i]
+              : *std::min_element(slopes.begin() + i + 1, slopes.end());
+      return {std::isnan(low) ? slopes[i] : low, high};
+    }
+
+    const double probability =
+        std::min(1.0, static_cast<double>(n) / static_cast<double>(inside));
+    std::vector<double> sample =
+        sample_slopes(points, lo, open, hi, probability, round, philox);
+
+    const double size = static_cast<double>(sample.size());
+    const double deviation = spread * std::sqrt(size) + 1.0;
+    const double low_position =
+        static_cast<double>(first - below) / inside * size - deviation;
+    const double high_position =
+        static_cast<double>(last + 1 - below) / inside * size + deviation;
+
+    // A bound that misses the ranks still narrows the interval from the other
+    // side.
+    bool found = false;
+    const auto narrow = [&](double t) {
+      const uint64_t count = count_below(t);
+      if (count > last) {
+        if (t < hi) {
+          hi = t;
+          up_to = count;
+        }
+        return;
+      }
+      if (count > first || not(t > lo || (t == lo && not open))) {
+        return;
+      }
+      if (std::count(sample.begin(), sample.end(), t) == 1) {
+        lo = t;
+        below = count;
+        return;
+      }
+      const uint64_t through = count_up_to(t);
+      if (through > last) {
+        low = std::isnan(low) ? t : low;
+        lo = hi = t;
+        found = true;
+        return;
+      }
+      if (through > first) {
+        low = t;
+        first = last;
+      }
+      lo = t;
+      open = true;
+      below = through;
+    };
+    auto rest = sample.begin();
+    if (low_position >= 0.0) {
+      rest += static_cast<size_t>(low_position);
+      std::nth_element(sample.begin(), rest, sample.end());
+      narrow(*rest++);
+    }
+    if (not found && high_position < size) {
+      const auto bound = sample.begin() + static_cast<size_t>(high_position);
+      std::nth_element(rest, bound, sample.end());
+      narrow(*bound);
+    }
+    if (found) {
+      return {low, hi};
+    }
+  }
+}
+
+/**
+ * @brief Returns the median of values, reordered.
+ *
+ */
+double median(std::vector<double> &values) {
+  const size_t middle = values.size() / 2;
+  std::nth_element(values.begin(), values.begin() + middle, values.end());
+  if (values.size() % 2 == 1) {
+    return values[middle];
+  }
+  const double low = *std::max_element(values.begin(), values.begin() + middle);
+  return (low + values[middle]) / 2.0;
+}
+
+/**
+ * @brief Returns the median of the residuals y - a * x.
+ *
+ */
+double median_residual(const Data_Set &data_set, double a) {
+  std::vector<double> residuals(data_set.n);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, data_set.n),
+                    [&](const tbb::blocked_range<size_t> &r) {
+                      for (size_t i = r.begin(); i != r.end(); i++) {
+                        residuals[i] = data_set.y[i] - a * data_set.x[i];
+                      }
+                    });
+  return median(residuals);
+}
+
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/*                                  theil_sen                                 */
+/* -------------------------------------------------------------------------- */
+
+Robust_Line theil_sen(const Data_Set &data_set) {
+  const size_t n = data_set.n;
+
+  std::vector<std::pair<double, double>> pairs(n);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, n),
+                    [&](const tbb::blocked_range<size_t> &r) {
+                      for (size_t i = r.begin(); i != r.end(); i++) {
+                        pairs[i] = {data_set.x[i], data_set.y[i]};
+                      }
+                    });
+  tbb::parallel_sort(pairs.begin(), pairs.end());
+
+  Sorted_Points points;
+  points.x.resize(n);
+  points.y.resize(n);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, n),
+                    [&](const tbb::blocked_range<size_t> &r) {
+                      for (size_t i = r.begin(); i != r.end(); i++) {
+                        points.x[i] = pairs[i].first;
+                        points.y[i] = pairs[i].second;
+                      }
+                    });
+  pairs = {};
+
+  // Pairs of different x, the others having no slope, and pairs of equal
+  // measurements.
+  uint64_t valid = n < 2 ? 0 : static_cast<uint64_t>(n) * (n - 1) / 2;
+  points.duplicates = 0;
+  for (size_t i = 0, d = 0; i != n;) {
+    size_t j = i + 1;
+    while (j != n && points.x[j] == points.x[i]) {
+      if (points.y[j] != points.y[d]) {
+        points.duplicates += static_cast<uint64_t>(j - d) * (j - d - 1) / 2;
+        d = j;
+      }
+      j++;
+    }
+    points.duplicates += static_cast<uint64_t>(j - d) * (j - d - 1) / 2;
+    valid -= static_cast<uint64_t>(j - i) * (j - i - 1) / 2;
+    i = d = j;
+  }
+  if (valid == 0) {
+    throw std::invalid_argument("the fit needs two different x at least");
+  }
+
+  const std::pair<double, double> middle =
+      select_slopes(points, valid, (valid - 1) / 2, valid / 2);
+
+  Robust_Line res;
+  res.a = (middle.first + middle.second) / 2.0;
+  res.b = median_residual(data_set, res.a);
+  return res;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               repeated_median                              */
+/* -------------------------------------------------------------------------- */
+
+Robust_Line repeated_median(const Data_Set &data_set) {
+  const size_t n = data_set.n;
+  const double *const x = data_set.x;
+  const double *const y = data_set.y;
+
+  // Median slope of each measurement, NaN if every x is its own.
+  std::vector<double> medians(n);
+  tbb::enumerable_thread_specific<std::vector<double>> buffers;
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, n),
+                    [&](const tbb::blocked_range<size_t> &r) {
+                      std::vector<double> &slopes = buffers.local();
+                      for (size_t i = r.begin(); i != r.end(); i++) {
+                        slopes.clear();
+                        for (size_t j = 0; j != n; j++) {
+                          if (x[j] != x[i]) {
+                            slopes.push_back((y[j] - y[i]) / (x[j] - x[i]));
+                          }
+                        }
+                        medians[i] = slopes.empty() ? NAN : median(slopes);
+                      }
+                    });
+  medians.erase(std::remove_if(medians.begin(), medians.end(),
+                               [](double m) { return std::isnan(m); }),
+                medians.end());
+  if (medians.empty()) {
+    throw std::invalid_argument("the fit needs two different x at least");
+  }
+
+  Robust_Line res;
+  res.a = median(medians);
+  res.b = median_residual(data_set, res.a);
+  return res;
+}
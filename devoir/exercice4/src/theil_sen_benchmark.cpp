@@ -0,0 +1,152 @@
+#include "cpp_argv.hpp"
+#include "correlation.hpp"
+#include "data_set.hpp"
+#include "theil_sen.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
+#include <tbb/blocked_range.h>
+#include <tbb/global_control.h>
+#include <tbb/parallel_for.h>
+
+#define DEFAULT_NAME "exercice4_theil_sen"
+
+/** Largest size on which the quadratic repeated median is timed. */
+#define REPEATED_MEDIAN_MAX_SIZE 10000
+
+/**
+ * @brief Builds a synthetic data set along y = 2x + 1 with noise, a few wild
+ * measurements and many ties in x, which take 100000 distinct values.
+ *
+ * @param n The number of measurements.
+ * @return Data_Set The data set.
+ */
+static Data_Set make_outlier_data_set(size_t n) {
+  const std::shared_ptr<double[]> columns(new double[2 * n]);
+  double *const x = columns.get();
+  double *const y = x + n;
+
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, n),
+                    [x, y](const tbb::blocked_range<size_t> &r) {
+                      for (size_t i = r.begin(); i != r.end(); i++) {
+                        uint64_t z = i * 0x9e3779b97f4a7c15ULL;
+                        z = (z ^ (z >> 31)) * 0xbf58476d1ce4e5b9ULL;
+                        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+                        const double u = (z >> 11) * 0x1.0p-53;
+                        x[i] = static_cast<double>(z % 100000) / 100.0;
+                        y[i] = 2.0 * x[i] + 1.0 + 50.0 * (u - 0.5);
+                        if (z % 53 == 0) {
+                          y[i] = -1e5 * u;
+                        }
+                      }
+                    });
+
+  Data_Set res;
+  res.n = n;
+  res.x = x;
+  res.y = y;
+  res.storage = columns;
+  return res;
+}
+
+/**
+ * @brief Calculates the Theil-Sen slope by listing every pair, in O(n^2).
+ *
+ */
+static double theil_sen_brute_force(const Data_Set &data_set) {
+  std::vector<double> slopes;
+  for (size_t i = 0; i != data_set.n; i++) {
+    for (size_t j = i + 1; j != data_set.n; j++) {
+      if (data_set.x[i] != data_set.x[j]) {
+        slopes.push_back((data_set.y[j] - data_set.y[i]) /
+                         (data_set.x[j] - data_set.x[i]));
+      }
+    }
+  }
+  std::sort(slopes.begin(), slopes.end());
+  const size_t middle = slopes.size() / 2;
+  return slopes.size() % 2 == 1 ? slopes[middle]
+                                 : (slopes[middle - 1] + slopes[middle]) / 2.0;
+}
+
+/**
+ * @brief Returns the duration of a call, in seconds.
+ *
+ */
+template <typename Function> static double time_it(const Function &f) {
+  const auto start = std::chrono::steady_clock::now();
+  f();
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(stop - start).count();
+}
+
+/**
+ * @brief Times least squares, Theil-Sen and, on the small ones, the repeated
+ * median on data sets with outliers of growing sizes, ten times larger each
+ * time, and checks Theil-Sen against the quadratic definition on a small one.
+ *
+ * @param argc number of arguments in the command line.
+ * @param argv arguments of the command line.
+ * @return @c EXIT_SUCCESS if command succeeds else @c EXIT_FAILURE.
+ */
+int main(int argc, char *argv[]) {
+
+  // User expects help.
+  CPP_ARGV_TEST_HELP_REQUEST(argc, argv[0], DEFAULT_NAME, "max_size")
+
+  // Bad argument number.
+  CPP_ARGV_TEST_ARG_NUM(argc, 2)
+
+  // Retrieves the largest size.
+  size_t max_size;
+  {
+    std::istringstream size_arg(argv[1]);
+    size_arg >> max_size;
+    if (not size_arg or max_size < 2) {
+      std::cerr << "Bad argument" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Agreement with the definition, on enough pairs for the selection to
+  // sample them before listing the last ones.
+  {
+    const Data_Set small = make_outlier_data_set(3000);
+    std::cout << "|theil-sen - brute force|:\t"
+              << std::fabs(theil_sen(small).a - theil_sen_brute_force(small))
+              << std::endl;
+  }
+
+  std::cout << "Thread(s):\t"
+            << tbb::global_control::active_value(
+                   tbb::global_control::max_allowed_parallelism)
+            << std::endl;
+  std::cout << "size\tleast squares (s)\ttheil-sen (s)\trepeated median (s)"
+               "\ta least squares\ta theil-sen\ta repeated median"
+            << std::endl;
+
+  for (size_t n = 1000; n <= max_size; n *= 10) {
+    const Data_Set data_set = make_outlier_data_set(n);
+    Correlation least_squares{};
+    Robust_Line sen{}, siegel{NAN, NAN};
+    const double least_squares_time =
+        time_it([&] { least_squares = calculate(data_set); });
+    const double sen_time = time_it([&] { sen = theil_sen(data_set); });
+    const double siegel_time =
+        n <= REPEATED_MEDIAN_MAX_SIZE
+            ? time_it([&] { siegel = repeated_median(data_set); })
+            : NAN;
+    std::cout << n << '\t' << least_squares_time << '\t' << sen_time << '\t'
+              << siegel_time << '\t' << least_squares.a << '\t' << sen.a << '\t'
+              << siegel.a << std::endl;
+  }
+
+  // It's over.
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,204 @@
+#ifndef BufferPool_hpp
+#define BufferPool_hpp
+
+#include <cstdlib>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <sys/mman.h>
+#include <omp.h>
+
+namespace merging {
+
+  /**
+   * @class BufferPool BufferPool.hpp
+   *
+   * Pool de grands tampons non initialisés destinés à recevoir le résultat
+   * d'une fusion (voir ParallelStableMerge::applyUninitialized).
+   *
+   * @note Les tampons sont alignés sur une page géante et leur taille en est
+   *   un multiple ; les pages géantes transparentes sont demandées pour eux.
+   *   Un nouveau tampon est touché une première fois en parallèle, afin que
+   *   ses pages soient réparties sur les nœuds mémoire des threads qui
+   *   l'écriront. Un tampon rendu est conservé puis réattribué à toute
+   *   demande qu'il peut satisfaire sans en gaspiller plus de la moitié.
+   */
+  class BufferPool {
+  public:
+
+    /**
+     * Taille d'une page géante, servant d'alignement et de granularité.
+     */
+    static constexpr size_t hugePageSize = 2 * 1024 * 1024;
+
+    /**
+     * @class Lease BufferPool.hpp
+     *
+     * Zone de stockage de @c count éléments de type @c T, rendue à son pool
+     * lors de sa destruction.
+     *
+     * @note Comme avec std::allocator, la zone n'est pas initialisée : les
+     *   éléments qui y sont construits doivent être détruits par l'appelant
+     *   avant que la zone ne soit rendue.
+     */
+    template< typename T >
+    class Lease {
+    public:
+
+      /**
+       * Constructeur.
+       *
+       * @param[in] pool - le pool propriétaire du tampon ;
+       * @param[in] data - le tampon ;
+       * @param[in] count - le nombre d'éléments demandés ;
+       * @param[in] capacity - la taille du tampon, en octets.
+       */
+      Lease(BufferPool& pool, T* data, const size_t& count, const size_t& capacity)
+        : pool(&pool), pointer(data), count(count), capacity(capacity) {}
+
+      Lease(const Lease&) = delete;
+      Lease& operator=(const Lease&) = delete;
+
+      Lease(Lease&& other) noexcept
+        : pool(other.pool), pointer(other.pointer), count(other.count), capacity(other.capacity) {
+        other.pointer = nullptr;
+      }
+
+      Lease& operator=(Lease&& other) noexcept {
+        std::swap(pool, other.pool);
+        std::swap(pointer, other.pointer);
+        std::swap(count, other.count);
+        std::swap(capacity, other.capacity);
+        return *this;
+      }
+
+      /**
+       * Destructeur : rend le tampon au pool.
+       */
+      ~Lease() {
+        if (pointer != nullptr) {
+          pool->release(pointer, capacity);
+        }
+      }
+
+      T* data() const { return pointer; }
+      size_t size() const { return count; }
+      T* begin() const { return pointer; }
+      T* end() const { return pointer + count; }
+      std::reverse_iterator< T* > rbegin() const { return std::reverse_iterator< T* >(end()); }
+      std::reverse_iterator< T* > rend() const { return std::reverse_iterator< T* >(begin()); }
+
+    private:
+      BufferPool* pool; /** Pool propriétaire.       */
+      T* pointer;       /** Le tampon.               */
+      size_t count;     /** Nombre d'éléments.       */
+      size_t capacity;  /** Taille en octets.        */
+    };
+
+    BufferPool() = default;
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    /**
+     * Destructeur : libère les tampons conservés. Toutes les zones doivent
+     * avoir été rendues auparavant.
+     */
+    ~BufferPool() {
+      clear();
+    }
+
+    /**
+     * Fournit une zone de stockage pour un nombre donné d'éléments.
+     *
+     * @param[in] count - le nombre d'éléments de type @c T à stocker.
+     * @return une zone pouvant accueillir @c count éléments.
+     * @throw std::bad_alloc si la mémoire vient à manquer.
+     */
+    template< typename T >
+    Lease< T > acquire(const size_t& count) {
+      static_assert(alignof(T) <= hugePageSize, "over-aligned type");
+      size_t capacity;
+      void* const buffer = allocate(count * sizeof(T), capacity);
+      return Lease< T >(*this, static_cast< T* >(buffer), count, capacity);
+    }
+
+    /**
+     * Libère les tampons actuellement conservés par le pool.
+     */
+    void clear() {
+      std::lock_guard< std::mutex > lock(mutex);
+      for (const auto& entry : cache) {
+        std::free(entry.second);
+      }
+      cache.clear();
+    }
+
+  private:
+
+    /**
+     * Réutilise un tampon conservé ou en alloue, puis touche, un nouveau.
+     *
+     * @param[in] bytes - le nombre d'octets demandés ;
+     * @param[out] capacity - la taille du tampon fourni, en octets.
+     * @return le tampon.
+     */
+    void* allocate(const size_t& bytes, size_t& capacity) {
+      capacity = (bytes + hugePageSize - 1) / hugePageSize * hugePageSize;
+      if (capacity == 0) {
+        capacity = hugePageSize;
+      }
+
+      // Plus petit tampon conservé assez grand, sauf s'il fait plus du double
+      // de la taille demandée.
+      {
+        std::lock_guard< std::mutex > lock(mutex);
+        const auto found = cache.lower_bound(capacity);
+        if (found != cache.end() && found->first <= 2 * capacity) {
+          void* const buffer = found->second;
+          capacity = found->first;
+          cache.erase(found);
+          return buffer;
+        }
+      }
+
+      void* const buffer = std::aligned_alloc(hugePageSize, capacity);
+      if (buffer == nullptr) {
+        throw std::bad_alloc();
+      }
+#ifdef MADV_HUGEPAGE
+      madvise(buffer, capacity, MADV_HUGEPAGE);
+#endif
+
+      // Premier contact parallèle, une écriture par petite page.
+      char* const base = static_cast< char* >(buffer);
+      const long pages = static_cast< long >(capacity / 4096);
+      #pragma omp parallel for schedule(static)
+      for (long page = 0; page < pages; page ++) {
+        base[page * 4096] = 0;
+      }
+
+      return buffer;
+    }
+
+    /**
+     * Remet un tampon dans le pool.
+     *
+     * @param[in] buffer - le tampon ;
+     * @param[in] capacity - sa taille, en octets.
+     */
+    void release(void* buffer, const size_t& capacity) {
+      std::lock_guard< std::mutex > lock(mutex);
+      cache.emplace(capacity, buffer);
+    }
+
+    std::mutex mutex;                     /** Protège les tampons libres.   */
+    std::multimap< size_t, void* > cache; /** Tampons libres, par taille.   */
+
+  }; // BufferPool
+
+} // merging
+
+#endif
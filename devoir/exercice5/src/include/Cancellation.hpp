@@ -0,0 +1,80 @@
+#ifndef Cancellation_hpp
+#define Cancellation_hpp
+
+#include <atomic>
+#include <chrono>
+
+namespace merging {
+
+  /**
+   * @class CancellationToken Cancellation.hpp
+   *
+   * Demande d'arrêt coopérative partagée entre l'appelant d'une longue
+   * fusion et les threads qui l'exécutent (voir
+   * ParallelStableMerge::applyCancellable). La demande est soit explicite,
+   * par un appel à @c cancel depuis n'importe quel thread, soit implicite,
+   * une fois passée une échéance facultative.
+   */
+  class CancellationToken {
+  public:
+
+    /**
+     * Types synonymes pour l'horloge et ses instants.
+     */
+    typedef std::chrono::steady_clock Clock;
+    typedef Clock::time_point TimePoint;
+
+    /**
+     * Constructeur d'un jeton sans échéance.
+     */
+    CancellationToken()
+      : requested(false), deadline(TimePoint::max()) {}
+
+    /**
+     * Constructeur d'un jeton expirant à un instant donné.
+     *
+     * @param[in] deadline - l'instant après lequel la fusion doit s'arrêter.
+     */
+    explicit CancellationToken(const TimePoint& deadline)
+      : requested(false), deadline(deadline) {}
+
+    /**
+     * Constructeur d'un jeton expirant après une durée donnée.
+     *
+     * @param[in] timeout - la durée, à partir de maintenant, après laquelle
+     *   la fusion doit s'arrêter.
+     */
+    template< typename Rep, typename Period >
+    explicit CancellationToken(const std::chrono::duration< Rep, Period >& timeout)
+      : requested(false),
+        deadline(Clock::now() + std::chrono::duration_cast< Clock::duration >(timeout)) {}
+
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+
+    /**
+     * Demande l'arrêt de la fusion, depuis n'importe quel thread.
+     */
+    void cancel() {
+      requested.store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * Indique si la fusion doit s'arrêter.
+     *
+     * @return @c true si @c cancel a été appelée ou si l'échéance est passée.
+     */
+    bool cancelled() const {
+      return requested.load(std::memory_order_relaxed) ||
+        (deadline != TimePoint::max() && Clock::now() >= deadline);
+    }
+
+  private:
+    std::atomic< bool > requested; /** Demande explicite. */
+    const TimePoint deadline;      /** Échéance.          */
+
+  }; // CancellationToken
+
+} // merging
+
+#endif
@@ -1,10 +1,17 @@
 #ifndef ParallelStableMerge_hpp
 #define ParallelStableMerge_hpp
 
+#include "Cancellation.hpp"
 #include <omp.h>
+#include <atomic>
 #include <functional>
 #include <algorithm>
 #include <cmath>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
 
 namespace merging {
 
@@ -21,6 +28,10 @@ namespace merging {
    *   d'ordre de type <= ou >= mais pas < ou >.
    */
   class ParallelStableMerge {
+
+    // Le tri stable parallèle réutilise directement la recherche des co-rangs.
+    friend class ParallelStableSort;
+
   public:
 
     /**
@@ -65,40 +76,95 @@ namespace merging {
       typedef typename TraitsOutput::difference_type OutputSize;
 
       // Tailles respectives des deux conteneurs à fusionner.
-      const InputSize1  m = last1 - first1;
-      const InputSize2 n = last2 - first2;
+      const InputSize1 size1 = last1 - first1;
+      const InputSize2 size2 = last2 - first2;
 
       // Calcul de la taille du conteneur accueillant la fusion.
-      const OutputSize mpn = m + n;
+      const OutputSize mpn = size1 + size2;
 
-      // Calcul de la taille des fragments dans le conteneur cible de la fusion.
-      const OutputSize taille = std::ceil(mpn * 1.0 / threads);
+      // Pré-test : deux recherches dichotomiques délimitent la fenêtre de
+      // recouvrement des deux conteneurs. Les éléments de l'un placés avant
+      // (resp. après) tous ceux de l'autre sont simplement recopiés et seule
+      // la fenêtre est fusionnée. Comme dans coRank, le premier conteneur
+      // passe en premier en cas d'égalité.
+      InputSize1 low1 = 0, high1 = size1;
+      InputSize2 low2 = 0, high2 = size2;
+      if (size1 > 0 && size2 > 0) {
+	const auto& head1 = *first1;
+	const auto& head2 = *first2;
+	const auto& tail1 = *(last1 - 1);
+	const auto& tail2 = *(last2 - 1);
+	if (comp(head1, head2)) {
+	  low1 = std::partition_point(first1, last1, [&](const auto& x) {
+	      return comp(x, head2);
+	    }) - first1;
+	}
+	else {
+	  low2 = std::partition_point(first2, last2, [&](const auto& x) {
+	      return ! comp(head1, x);
+	    }) - first2;
+	}
+	if (comp(tail1, tail2)) {
+	  high2 = std::partition_point(first2 + low2, last2, [&](const auto& x) {
+	      return ! comp(tail1, x);
+	    }) - first2;
+	}
+	else {
+	  high1 = std::partition_point(first1 + low1, last1, [&](const auto& x) {
+	      return comp(x, tail2);
+	    }) - first1;
+	}
+      }
+
+      // Fenêtre de recouvrement à fusionner.
+      const InputRandomAccessIterator1 a = first1 + low1;
+      const InputRandomAccessIterator2 b = first2 + low2;
+      const InputSize1 m = high1 - low1;
+      const InputSize2 n = high2 - low2;
+      const OutputRandomAccessIterator middle = result + low1 + low2;
+
+      // Calcul de la taille des fragments dans la fenêtre de recouvrement.
+      const OutputSize taille = std::max< OutputSize >(std::ceil((m + n) * 1.0 / threads), 1);
+
+      // Relation stricte associée à comp : std::merge départage alors les
+      // égalités comme coRank, le premier conteneur passant en premier, et
+      // les fragments voisins s'accordent sur les éléments égaux.
+      const auto strict = [&comp](const auto& lhs, const auto& rhs) {
+	return ! comp(rhs, lhs);
+      };
 
       // Boucle parallèle sur les fragments.
       #pragma omp parallel num_threads(threads)
       {
         #pragma omp single nowait
         {
-          for (OutputSize i = 0; i < mpn; i += taille) {
+	  // Recopie des parties disjointes : au plus une des deux parties de
+	  // tête, et une des deux parties de queue, est non vide.
+	  copyTasks(first1, first1 + low1, result, threads);
+	  copyTasks(first2, first2 + low2, result + low1, threads);
+	  copyTasks(first1 + high1, last1, middle + m + n, threads);
+	  copyTasks(first2 + high2, last2, middle + m + n + (size1 - high1), threads);
+
+          for (OutputSize i = 0; i < m + n; i += taille) {
             #pragma omp task firstprivate(i)
             {
               InputSize1 j;
               InputSize2 k;
-              coRank(i, first1, m, first2, n, comp, j, k);
+              coRank(i, a, m, b, n, comp, j, k);
 
               OutputSize i1 = i + taille;
-              if (i1 > mpn) {
-                i1 = mpn;
+              if (i1 > m + n) {
+                i1 = m + n;
               }
 
               InputSize1 j1;
               InputSize2 k1;
-              coRank(i1, first1, m, first2, n, comp, j1, k1);
+              coRank(i1, a, m, b, n, comp, j1, k1);
 
-              std::merge(first1 + j, first1 + j1,
-                          first2 + k, first2 + k1,
-                          result + i,
-                          comp);
+              std::merge(a + j, a + j1,
+                          b + k, b + k1,
+                          middle + i,
+                          strict);
 
             }
           }
@@ -161,8 +227,410 @@ namespace merging {
       
     } // apply
 
+    /**
+     * Traitement des clés par les versions à projection.
+     */
+    enum class KeyMode {
+      direct,    /** Projeter les éléments à chaque comparaison.              */
+      extracted, /** Recopier les clés dans des tableaux contigus au départ.  */
+      automatic  /** N'extraire que si les éléments sont bien plus gros.      */
+    };
+
+    /**
+     * Implémentation parallèle comparant les éléments sur une clé projetée,
+     * à la manière des algorithmes sur les intervalles de C++20.
+     *
+     * @param[in] first1 - un itérateur repérant le premier élément du premier
+     *   sous-conteneur concerné par la fusion ;
+     * @param[in] last1 - un itérateur repérant l'élément situé juste derrière 
+     *   le dernier élément du premier sous-conteneur concerné par la fusion ;
+     * @param[in] first2 - un itérateur repérant le premier élément du second
+     *   sous-conteneur concerné par la fusion ;
+     * @param[in] last2 - un itérateur repérant l'élément situé juste derrière 
+     *   le dernier élément du second sous-conteneur concerné par la fusion ;
+     * @param[in] result - un itérateur repérant la position ou récopier le 
+     *   premier élément résultant de la fusion ;
+     * @param[in] comp - un comparateur binaire représentant la relation d'ordre
+     *   total (<= ou >=) régissant les clés ;
+     * @param[in] proj - un appelable (fonction, pointeur sur membre, ...)
+     *   retournant la clé d'un élément ;
+     * @param[in] threads - le nombre de threads disponibles ;
+     * @param[in] mode - les clés sont-elles projetées à chaque comparaison ou
+     *   bien extraites une fois pour toutes dans des tableaux contigus, de
+     *   sorte que les co-rangs et les fusions ne lisent plus les éléments
+     *   eux-mêmes ?
+     * @return un itérateur repérant la fin de la zone de fusion dans le
+     *   conteneur cible.
+     */
+    template< typename InputRandomAccessIterator1,
+	      typename InputRandomAccessIterator2,
+	      typename OutputRandomAccessIterator,
+	      typename Compare,
+	      typename Projection >
+    static OutputRandomAccessIterator 
+    apply(const InputRandomAccessIterator1& first1,
+	  const InputRandomAccessIterator1& last1,
+	  const InputRandomAccessIterator2& first2,
+	  const InputRandomAccessIterator2& last2,
+	  const OutputRandomAccessIterator& result,
+	  const Compare& comp,
+	  const Projection& proj,
+	  const int& threads,
+	  const KeyMode& mode = KeyMode::automatic) {
+
+      // Types synonymes pour les éléments et leurs clés.
+      typedef std::iterator_traits< InputRandomAccessIterator1 > TraitsInput1;
+      typedef std::iterator_traits< InputRandomAccessIterator2 > TraitsInput2;
+      typedef std::iterator_traits< OutputRandomAccessIterator > TraitsOutput;
+      typedef typename TraitsInput1::difference_type InputSize1;
+      typedef typename TraitsInput2::difference_type InputSize2;
+      typedef typename TraitsOutput::difference_type OutputSize;
+      typedef typename TraitsInput1::value_type value_type;
+      typedef std::decay_t< std::invoke_result_t< const Projection&,
+						  const value_type& > > Key;
+
+      // L'extraction n'est rentable que si la clé est une petite partie,
+      // facilement copiable, d'un élément bien plus gros.
+      const bool extract = mode == KeyMode::extracted ||
+	(mode == KeyMode::automatic &&
+	 std::is_trivially_copyable< Key >::value &&
+	 sizeof(value_type) >= 4 * sizeof(Key));
+
+      if (! extract) {
+	// Comparer les projections des éléments.
+	const auto projected = [&comp, &proj](const auto& lhs, const auto& rhs) {
+	  return comp(std::invoke(proj, lhs), std::invoke(proj, rhs));
+	};
+	return apply(first1, last1, first2, last2, result, projected, threads);
+      }
+
+      // Tailles respectives des deux conteneurs à fusionner.
+      const InputSize1 m = last1 - first1;
+      const InputSize2 n = last2 - first2;
+
+      // Calcul de la taille du conteneur accueillant la fusion.
+      const OutputSize mpn = m + n;
+
+      // Calcul de la taille des fragments dans le conteneur cible de la fusion.
+      const OutputSize taille = std::ceil(mpn * 1.0 / threads);
+
+      // Tableaux contigus des clés.
+      std::vector< Key > keys1(m), keys2(n);
+      const Key* const a = keys1.data();
+      const Key* const b = keys2.data();
+
+      #pragma omp parallel num_threads(threads)
+      {
+	// Extraction parallèle des clés.
+	#pragma omp for schedule(static) nowait
+	for (InputSize1 i = 0; i < m; i ++) {
+	  keys1[i] = std::invoke(proj, *(first1 + i));
+	}
+	#pragma omp for schedule(static)
+	for (InputSize2 i = 0; i < n; i ++) {
+	  keys2[i] = std::invoke(proj, *(first2 + i));
+	}
+
+	// Boucle parallèle sur les fragments, comme dans la version générale
+	// mais en ne consultant que les clés.
+        #pragma omp single nowait
+        {
+          for (OutputSize i = 0; i < mpn; i += taille) {
+            #pragma omp task firstprivate(i)
+            {
+              InputSize1 j;
+              InputSize2 k;
+              coRank(i, a, m, b, n, comp, j, k);
+
+              OutputSize i1 = i + taille;
+              if (i1 > mpn) {
+                i1 = mpn;
+              }
+
+              InputSize1 j1;
+              InputSize2 k1;
+              coRank(i1, a, m, b, n, comp, j1, k1);
+
+              mergeKeys(a + j, a + j1, first1 + j,
+			b + k, b + k1, first2 + k,
+			result + i,
+			comp);
+            }
+          }
+        }
+      }
+
+      // Respect de la sémantique de l'algorithme merge.
+      return result + mpn;
+
+    } // apply
+
+    /**
+     * Implémentation parallèle écrivant dans une zone non initialisée, telle
+     * qu'une zone fournie par BufferPool : les éléments fusionnés y sont
+     * construits par copie au lieu d'être affectés, si bien que la cible n'a
+     * pas besoin d'être initialisée au préalable.
+     *
+     * @param[in] first1 - un itérateur repérant le premier élément du premier
+     *   sous-conteneur concerné par la fusion ;
+     * @param[in] last1 - un itérateur repérant l'élément situé juste derrière 
+     *   le dernier élément du premier sous-conteneur concerné par la fusion ;
+     * @param[in] first2 - un itérateur repérant le premier élément du second
+     *   sous-conteneur concerné par la fusion ;
+     * @param[in] last2 - un itérateur repérant l'élément situé juste derrière 
+     *   le dernier élément du second sous-conteneur concerné par la fusion ;
+     * @param[in] result - un itérateur repérant la position, non initialisée,
+     *   où construire le premier élément résultant de la fusion ;
+     * @param[in] comp - un comparateur binaire représentant la relation d'ordre
+     *   total régissant les sous-conteneurs ;
+     * @param[in] threads - le nombre de threads disponibles.
+     * @return un itérateur repérant la fin de la zone de fusion dans le
+     *   conteneur cible.
+     */
+    template< typename InputRandomAccessIterator1,
+	      typename InputRandomAccessIterator2,
+	      typename OutputRandomAccessIterator,
+	      typename Compare >
+    static OutputRandomAccessIterator 
+    applyUninitialized(const InputRandomAccessIterator1& first1,
+		       const InputRandomAccessIterator1& last1,
+		       const InputRandomAccessIterator2& first2,
+		       const InputRandomAccessIterator2& last2,
+		       const OutputRandomAccessIterator& result,
+		       const Compare& comp,
+		       const int& threads) {
+
+      // Type synonyme pour le type des éléments du conteneur cible.
+      typedef std::iterator_traits< OutputRandomAccessIterator > Traits;
+      typedef typename Traits::value_type value_type;
+
+      // Des éléments trivialement copiables peuvent être recopiés octet par
+      // octet dans une zone brute.
+      if constexpr (std::is_trivially_copyable< value_type >::value) {
+	return apply(first1, last1, first2, last2, result, comp, threads);
+      }
+      else {
+	apply(first1,
+	      last1,
+	      first2,
+	      last2,
+	      ConstructingIterator< OutputRandomAccessIterator >(result),
+	      comp,
+	      threads);
+	return result + (last1 - first1) + (last2 - first2);
+      }
+
+    } // applyUninitialized
+
+    /**
+     * Implémentation parallèle écrivant dans une zone non initialisée, pour
+     * la relation d'ordre total inférieur ou égal.
+     *
+     * @param[in] first1 - un itérateur repérant le premier élément du premier
+     *   sous-conteneur concerné par la fusion ;
+     * @param[in] last1 - un itérateur repérant l'élément situé juste derrière 
+     *   le dernier élément du premier sous-conteneur concerné par la fusion ;
+     * @param[in] first2 - un itérateur repérant le premier élément du second
+     *   sous-conteneur concerné par la fusion ;
+     * @param[in] last2 - un itérateur repérant l'élément situé juste derrière 
+     *   le dernier élément du second sous-conteneur concerné par la fusion ;
+     * @param[in] result - un itérateur repérant la position, non initialisée,
+     *   où construire le premier élément résultant de la fusion ;
+     * @param[in] threads - le nombre de threads disponibles.
+     * @return un itérateur repérant la fin de la zone de fusion dans le
+     *   conteneur cible.
+     */
+    template< typename InputRandomAccessIterator1,
+	      typename InputRandomAccessIterator2,
+	      typename OutputRandomAccessIterator >
+    static OutputRandomAccessIterator 
+    applyUninitialized(const InputRandomAccessIterator1& first1,
+		       const InputRandomAccessIterator1& last1,
+		       const InputRandomAccessIterator2& first2,
+		       const InputRandomAccessIterator2& last2,
+		       const OutputRandomAccessIterator& result,
+		       const int& threads) {
+
+      typedef std::iterator_traits< InputRandomAccessIterator1 > Traits;
+      typedef typename Traits::value_type value_type;
+
+      return applyUninitialized(first1,
+				last1,
+				first2,
+				last2,
+				result,
+				std::less_equal< const value_type& >(),
+				threads);
+
+    } // applyUninitialized
+
+    /**
+     * Implémentation parallèle pouvant être interrompue avant son terme, par
+     * exemple lorsque la requête qu'elle sert a expiré en amont.
+     *
+     * @param[in] first1 - un itérateur repérant le premier élément du premier
+     *   sous-conteneur concerné par la fusion ;
+     * @param[in] last1 - un itérateur repérant l'élément situé juste derrière 
+     *   le dernier élément du premier sous-conteneur concerné par la fusion ;
+     * @param[in] first2 - un itérateur repérant le premier élément du second
+     *   sous-conteneur concerné par la fusion ;
+     * @param[in] last2 - un itérateur repérant l'élément situé juste derrière 
+     *   le dernier élément du second sous-conteneur concerné par la fusion ;
+     * @param[in] result - un itérateur repérant la position ou récopier le 
+     *   premier élément résultant de la fusion ;
+     * @param[in] comp - un comparateur binaire représentant la relation d'ordre
+     *   total régissant les sous-conteneurs ;
+     * @param[in] threads - le nombre de threads disponibles ;
+     * @param[in] token - le jeton d'annulation consulté par les tâches ;
+     * @param[in] grain - la taille maximale d'un fragment, c'est-à-dire le
+     *   travail restant à chaque thread une fois l'annulation constatée.
+     * @return @c true si la fusion est allée à son terme, @c false si elle a
+     *   été interrompue, le contenu du conteneur cible étant alors indéfini.
+     *
+     * @note Le jeton est consulté au début de chaque fragment. Lorsqu'il est
+     *   déclenché, le groupe de tâches est annulé par la directive omp cancel :
+     *   si l'annulation est activée (OMP_CANCELLATION=true), les tâches non
+     *   démarrées sont abandonnées par l'environnement d'exécution ; sinon,
+     *   elles se terminent dès leur démarrage.
+     */
+    template< typename InputRandomAccessIterator1,
+	      typename InputRandomAccessIterator2,
+	      typename OutputRandomAccessIterator,
+	      typename Compare >
+    static bool
+    applyCancellable(const InputRandomAccessIterator1& first1,
+		     const InputRandomAccessIterator1& last1,
+		     const InputRandomAccessIterator2& first2,
+		     const InputRandomAccessIterator2& last2,
+		     const OutputRandomAccessIterator& result,
+		     const Compare& comp,
+		     const int& threads,
+		     const CancellationToken& token,
+		     const size_t& grain = 64 * 1024) {
+
+      // Types synonymes permettant de ne rien préjuger des types entiers
+      // manipulés.
+      typedef std::iterator_traits< InputRandomAccessIterator1 > TraitsInput1;
+      typedef std::iterator_traits< InputRandomAccessIterator2 > TraitsInput2;
+      typedef std::iterator_traits< OutputRandomAccessIterator > TraitsOutput;
+      typedef typename TraitsInput1::difference_type InputSize1;
+      typedef typename TraitsInput2::difference_type InputSize2;
+      typedef typename TraitsOutput::difference_type OutputSize;
+
+      // Tailles respectives des deux conteneurs à fusionner.
+      const InputSize1 m = last1 - first1;
+      const InputSize2 n = last2 - first2;
+
+      // Calcul de la taille du conteneur accueillant la fusion.
+      const OutputSize mpn = m + n;
+
+      // Taille des fragments : au plus grain éléments, afin de borner le
+      // travail effectué après l'annulation.
+      const OutputSize taille =
+	std::max< OutputSize >(std::min< OutputSize >(std::ceil(mpn * 1.0 / threads),
+						      static_cast< OutputSize >(grain)),
+			       1);
+
+      // Vrai dès qu'une tâche a constaté le déclenchement du jeton.
+      std::atomic< bool > stopped(false);
+
+      // Relation stricte associée à comp : std::merge départage alors les
+      // égalités comme coRank, le premier conteneur passant en premier, et
+      // les fragments voisins s'accordent sur les éléments égaux.
+      const auto strict = [&comp](const auto& lhs, const auto& rhs) {
+	return ! comp(rhs, lhs);
+      };
+
+      // Boucle parallèle sur les fragments, au sein d'un groupe de tâches
+      // annulable.
+      #pragma omp parallel num_threads(threads)
+      {
+        #pragma omp single nowait
+        {
+	  #pragma omp taskgroup
+	  {
+	    for (OutputSize i = 0; i < mpn && ! stopped.load(); i += taille) {
+	      #pragma omp task firstprivate(i)
+	      {
+		if (token.cancelled()) {
+		  stopped.store(true);
+		  #pragma omp cancel taskgroup
+		}
+
+		if (! stopped.load()) {
+		  InputSize1 j;
+		  InputSize2 k;
+		  coRank(i, first1, m, first2, n, comp, j, k);
+
+		  OutputSize i1 = i + taille;
+		  if (i1 > mpn) {
+		    i1 = mpn;
+		  }
+
+		  InputSize1 j1;
+		  InputSize2 k1;
+		  coRank(i1, first1, m, first2, n, comp, j1, k1);
+
+		  std::merge(first1 + j, first1 + j1,
+			     first2 + k, first2 + k1,
+			     result + i,
+			     strict);
+		}
+	      }
+	    }
+	  }
+        }
+      }
+
+      return ! stopped.load();
+
+    } // applyCancellable
+
   protected:
 
+    /**
+     * @class ConstructingIterator ParallelStableMerge.hpp
+     *
+     * Adaptateur d'itérateur de sortie construisant, au lieu de les affecter,
+     * les valeurs écrites au travers de lui. Il fournit exactement ce dont
+     * apply et std::merge ont besoin : décalage, incrémentation et écriture.
+     */
+    template< typename OutputRandomAccessIterator >
+    class ConstructingIterator {
+    public:
+      typedef std::iterator_traits< OutputRandomAccessIterator > Traits;
+      typedef std::output_iterator_tag iterator_category;
+      typedef typename Traits::value_type value_type;
+      typedef typename Traits::difference_type difference_type;
+      typedef void pointer;
+      typedef void reference;
+
+      explicit ConstructingIterator(const OutputRandomAccessIterator& position)
+	: position(position) {}
+
+      ConstructingIterator operator*() const { return *this; }
+
+      ConstructingIterator& operator=(const value_type& value) {
+	::new (static_cast< void* >(std::addressof(*position))) value_type(value);
+	return *this;
+      }
+
+      ConstructingIterator& operator++() { ++ position; return *this; }
+
+      ConstructingIterator operator++(int) {
+	ConstructingIterator previous(*this);
+	++ position;
+	return previous;
+      }
+
+      ConstructingIterator operator+(const difference_type& offset) const {
+	return ConstructingIterator(position + offset);
+      }
+
+    private:
+      OutputRandomAccessIterator position; /** Itérateur adapté. */
+    };
+
     /**
      * Recherche dichotomique de la paire (j, k) représentant les rangs,
      * respectivement dans le premier et le second conteneur, des éléments
@@ -230,6 +698,96 @@ namespace merging {
 
     } // coRank
 
+    /**
+     * Fusion séquentielle guidée par les clés extraites : les comparaisons ne
+     * lisent que les tableaux de clés et chaque élément n'est lu qu'une fois,
+     * lors de sa recopie.
+     *
+     * @param[in] keys1 - un pointeur sur la clé du premier élément du premier
+     *   sous-conteneur ;
+     * @param[in] keysEnd1 - un pointeur situé juste derrière la dernière clé
+     *   du premier sous-conteneur ;
+     * @param[in] first1 - un itérateur repérant l'élément de clé @c *keys1 ;
+     * @param[in] keys2 - un pointeur sur la clé du premier élément du second
+     *   sous-conteneur ;
+     * @param[in] keysEnd2 - un pointeur situé juste derrière la dernière clé
+     *   du second sous-conteneur ;
+     * @param[in] first2 - un itérateur repérant l'élément de clé @c *keys2 ;
+     * @param[in] result - un itérateur repérant la position ou récopier le 
+     *   premier élément résultant de la fusion ;
+     * @param[in] comp - un comparateur binaire représentant la relation d'ordre
+     *   total régissant les clés.
+     */
+    template< typename Key,
+	      typename InputRandomAccessIterator1,
+	      typename InputRandomAccessIterator2,
+	      typename OutputRandomAccessIterator,
+	      typename Compare >
+    static void mergeKeys(const Key* keys1,
+			  const Key* keysEnd1,
+			  InputRandomAccessIterator1 first1,
+			  const Key* keys2,
+			  const Key* keysEnd2,
+			  InputRandomAccessIterator2 first2,
+			  OutputRandomAccessIterator result,
+			  const Compare& comp) {
+
+      // Même règle que coRank : en cas d'égalité au sens de comp, le premier
+      // conteneur passe en premier.
+      while (keys1 != keysEnd1 && keys2 != keysEnd2) {
+	if (! comp(*keys1, *keys2)) {
+	  *result = *first2;
+	  ++ keys2;
+	  ++ first2;
+	}
+	else {
+	  *result = *first1;
+	  ++ keys1;
+	  ++ first1;
+	}
+	++ result;
+      }
+
+      // Recopie de la fin de l'un ou l'autre des sous-conteneurs.
+      result = std::copy(first1, first1 + (keysEnd1 - keys1), result);
+      std::copy(first2, first2 + (keysEnd2 - keys2), result);
+
+    } // mergeKeys
+
+    /**
+     * Crée les tâches recopiant un sous-conteneur par fragments, chacun étant
+     * recopié par std::copy, donc par memmove pour des éléments trivialement
+     * copiables et contigus. Cette méthode doit être appelée depuis un bloc
+     * single d'une région parallèle.
+     *
+     * @param[in] first - un itérateur repérant le premier élément à recopier ;
+     * @param[in] last - un itérateur repérant l'élément situé juste derrière
+     *   le dernier élément à recopier ;
+     * @param[in] result - un itérateur repérant la position où recopier le
+     *   premier élément ;
+     * @param[in] threads - le nombre de threads disponibles.
+     */
+    template< typename InputRandomAccessIterator,
+	      typename OutputRandomAccessIterator >
+    static void copyTasks(const InputRandomAccessIterator& first,
+			  const InputRandomAccessIterator& last,
+			  const OutputRandomAccessIterator& result,
+			  const int& threads) {
+
+      typedef std::iterator_traits< InputRandomAccessIterator > Traits;
+      typedef typename Traits::difference_type Size;
+
+      const Size size = last - first;
+      const Size taille = std::max< Size >(std::ceil(size * 1.0 / threads), 1);
+      for (Size i = 0; i < size; i += taille) {
+	#pragma omp task firstprivate(i)
+	{
+	  std::copy(first + i, first + std::min(i + taille, size), result + i);
+	}
+      }
+
+    } // copyTasks
+
   }; // ParallelStableMerge
 
 } // merging
@@ -0,0 +1,221 @@
+#ifndef ParallelStableSort_hpp
+#define ParallelStableSort_hpp
+
+#include "ParallelStableMerge.hpp"
+#include <omp.h>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace merging {
+
+  /**
+   * @class ParallelStableSort ParallelStableSort.hpp
+   *
+   * Version OpenMP de l'algorithme stable_sort de la bibliothèque standard.
+   *
+   * @note Le conteneur est découpé en autant de blocs que de threads, chaque
+   *   bloc étant trié par std::stable_sort. Les blocs sont ensuite fusionnés
+   *   deux à deux en log2(p) tours, en alternant entre le conteneur et un
+   *   tampon auxiliaire. À chaque tour, la zone cible est découpée en p
+   *   fragments alignés sur les blocs initiaux : tous les threads travaillent
+   *   donc à chaque tour, même lorsqu'il ne reste que deux séquences à
+   *   fusionner. Les co-rangs des fragments (voir ParallelStableMerge) sont
+   *   calculés une seule fois par frontière et rangés dans un plan alloué une
+   *   fois pour toutes, puis réutilisé d'un tour à l'autre.
+   */
+  class ParallelStableSort {
+  public:
+
+    /**
+     * Implémentation parallèle.
+     *
+     * @param[in] first - un itérateur repérant le premier élément du conteneur
+     *   à trier ;
+     * @param[in] last - un itérateur repérant l'élément situé juste derrière
+     *   le dernier élément du conteneur à trier ;
+     * @param[in] comp - un comparateur binaire représentant la relation d'ordre
+     *   strict (< ou >) régissant le conteneur, comme pour std::stable_sort ;
+     * @param[in] threads - le nombre de threads disponibles.
+     */
+    template< typename RandomAccessIterator,
+              typename Compare >
+    static void
+    apply(const RandomAccessIterator& first,
+          const RandomAccessIterator& last,
+          const Compare& comp,
+          const int& threads) {
+
+      // Types synonymes permettant de ne rien préjuger des types manipulés.
+      typedef std::iterator_traits< RandomAccessIterator > Traits;
+      typedef typename Traits::value_type value_type;
+      typedef typename Traits::difference_type Size;
+
+      // Taille du conteneur à trier.
+      const Size n = last - first;
+
+      // Un seul thread ou trop peu d'éléments : la version séquentielle
+      // suffit.
+      if (threads < 2 || n < 2 * static_cast< Size >(threads)) {
+        std::stable_sort(first, last, comp);
+        return;
+      }
+
+      // Bornes des blocs : le bloc b couvre l'intervalle [bounds[b],
+      // bounds[b + 1]).
+      std::vector< Size > bounds(threads + 1);
+      for (int b = 0; b <= threads; b ++) {
+        bounds[b] = n * b / threads;
+      }
+
+      // Tampon auxiliaire et plan des co-rangs, partagés par tous les tours.
+      std::vector< value_type > buffer(n);
+      std::vector< std::pair< Size, Size > > plan(threads);
+
+      // Vrai lorsque la dernière fusion a été écrite dans le tampon.
+      bool inBuffer = false;
+
+      #pragma omp parallel num_threads(threads)
+      {
+        // Tri séquentiel de chacun des blocs.
+        #pragma omp for schedule(static)
+        for (int b = 0; b < threads; b ++) {
+          std::stable_sort(first + bounds[b], first + bounds[b + 1], comp);
+        }
+
+        // Fusion des séquences deux à deux, leur largeur (en blocs) doublant
+        // à chaque tour.
+        for (int width = 1; width < threads; width *= 2) {
+          if (inBuffer) {
+            mergeRound(buffer.begin(), first, bounds, width, comp, plan);
+          }
+          else {
+            mergeRound(first, buffer.begin(), bounds, width, comp, plan);
+          }
+
+          #pragma omp single
+          inBuffer = ! inBuffer;
+        }
+
+        // Le résultat doit finalement se trouver dans le conteneur d'origine.
+        if (inBuffer) {
+          #pragma omp for schedule(static)
+          for (int b = 0; b < threads; b ++) {
+            std::copy(buffer.begin() + bounds[b],
+                      buffer.begin() + bounds[b + 1],
+                      first + bounds[b]);
+          }
+        }
+      }
+
+    } // apply
+
+    /**
+     * Implémentation parallèle pour la relation d'ordre total strictement
+     * inférieur à.
+     *
+     * @param[in] first - un itérateur repérant le premier élément du conteneur
+     *   à trier ;
+     * @param[in] last - un itérateur repérant l'élément situé juste derrière
+     *   le dernier élément du conteneur à trier ;
+     * @param[in] threads - le nombre de threads disponibles.
+     */
+    template< typename RandomAccessIterator >
+    static void
+    apply(const RandomAccessIterator& first,
+          const RandomAccessIterator& last,
+          const int& threads) {
+
+      // Type synonyme pour le type des éléments du conteneur.
+      typedef std::iterator_traits< RandomAccessIterator > Traits;
+      typedef typename Traits::value_type value_type;
+
+      // Fabriquer le comparateur less puis invoquer la méthode définie
+      // ci-dessus.
+      apply(first, last, std::less< const value_type& >(), threads);
+
+    } // apply
+
+  protected:
+
+    /**
+     * Un tour de fusion : chaque paire de séquences adjacentes de @c width
+     * blocs de la source est fusionnée dans la cible. Cette méthode doit être
+     * appelée par tous les threads d'une région parallèle.
+     *
+     * @param[in] source - un itérateur repérant le premier élément de la zone
+     *   source ;
+     * @param[in] target - un itérateur repérant le premier élément de la zone
+     *   cible ;
+     * @param[in] bounds - les bornes des blocs initiaux ;
+     * @param[in] width - la largeur, en blocs, des séquences déjà triées ;
+     * @param[in] comp - un comparateur binaire représentant la relation d'ordre
+     *   strict régissant les éléments ;
+     * @param[in,out] plan - le co-rang (j, k) du premier élément de chaque
+     *   fragment, relativement à la fusion à laquelle il appartient.
+     */
+    template< typename InputRandomAccessIterator,
+              typename OutputRandomAccessIterator,
+              typename Size,
+              typename Compare >
+    static void mergeRound(const InputRandomAccessIterator& source,
+                           const OutputRandomAccessIterator& target,
+                           const std::vector< Size >& bounds,
+                           const int& width,
+                           const Compare& comp,
+                           std::vector< std::pair< Size, Size > >& plan) {
+
+      // Nombre de fragments (et de blocs).
+      const int p = static_cast< int >(plan.size());
+
+      // La recherche des co-rangs attend une relation d'ordre large. Elle
+      // place les éléments égaux de la séquence de gauche en premier, comme
+      // std::merge avec la relation stricte : la fusion reste stable.
+      const auto lessEqual = [&comp](const auto& lhs, const auto& rhs) {
+        return ! comp(rhs, lhs);
+      };
+
+      // Calcul du plan.
+      #pragma omp for schedule(static)
+      for (int f = 0; f < p; f ++) {
+        const int group = f - f % (2 * width);
+        const int middle = std::min(group + width, p);
+        const int end = std::min(group + 2 * width, p);
+        ParallelStableMerge::coRank(bounds[f] - bounds[group],
+                                    source + bounds[group],
+                                    bounds[middle] - bounds[group],
+                                    source + bounds[middle],
+                                    bounds[end] - bounds[middle],
+                                    lessEqual,
+                                    plan[f].first,
+                                    plan[f].second);
+      }
+
+      // Fusion des fragments, chacun se terminant là où commence le suivant
+      // au sein de la même fusion.
+      #pragma omp for schedule(static)
+      for (int f = 0; f < p; f ++) {
+        const int group = f - f % (2 * width);
+        const int middle = std::min(group + width, p);
+        const int end = std::min(group + 2 * width, p);
+        const Size j1 = f + 1 == end ?
+          bounds[middle] - bounds[group] : plan[f + 1].first;
+        const Size k1 = f + 1 == end ?
+          bounds[end] - bounds[middle] : plan[f + 1].second;
+        std::merge(source + bounds[group] + plan[f].first,
+                   source + bounds[group] + j1,
+                   source + bounds[middle] + plan[f].second,
+                   source + bounds[middle] + k1,
+                   target + bounds[f],
+                   comp);
+      }
+
+    } // mergeRound
+
+  }; // ParallelStableSort
+
+} // merging
+
+#endif
@@ -0,0 +1,135 @@
+#include "ParallelStableMerge.hpp"
+#include "BufferPool.hpp"
+#include "Metrics.hpp"
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <cstdlib>
+
+/**
+ * Programme principal : compare std::merge et ParallelStableMerge sur des
+ * fusions de type « ajout en fin », pour lesquelles le pré-test de
+ * recouvrement réduit la fusion à des copies parallèles.
+ *
+ * @param[in] argc le nombre d'arguments de la ligne de commandes.
+ * @param[in] argv les arguments de la ligne de commandes.
+ * @return @c EXIT_SUCCESS en cas d'exécution réussie ou @c EXIT_FAILURE en cas
+ *   de problèmes.
+ */
+int
+main(int argc, char* argv[]) {
+
+  // La ligne de commandes est vide : l'utilisateur demande de l'aide.
+  if (argc == 1) {
+    std::cout << "Usage: " << argv[0] << " nb_iterations" << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  // Le nombre d'arguments est différent de 1 : l'utilisateur fait n'importe
+  // quoi.
+  if (argc != 2) {
+    std::cerr << "Nombre d'argument(s) incorrect." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Tentative d'extraction du nombre d'itérations.
+  size_t iters;
+  {
+    std::istringstream entree(argv[1]);
+    entree >> iters;
+    if (! entree || ! entree.eof()) {
+      std::cerr << "Argument incorrect." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Synonyme du type des éléments à fusionner.
+  typedef int Type;
+
+  // Relations d'ordre utilisées : strictement inférieur à pour std::merge et
+  // les vérifications, inférieur ou égal à pour ParallelStableMerge.
+  const auto comp = std::less< const Type& >();
+  const auto lessEqual = std::less_equal< const Type& >();
+
+  // Taille de chacun des deux tableaux.
+  const size_t size = 4 * 1024 * 1024;
+
+  // Nombre de threads disponibles via OpenMP.
+  const int threads = omp_get_max_threads();
+
+  // Zone non initialisée accueillant le résultat des fusions.
+  merging::BufferPool pool;
+  auto result = pool.acquire< Type >(2 * size);
+
+  // Distributions testées : le second tableau commence après la fin du
+  // premier, le recouvre sur une bande de 1 %, ou s'entrelace avec lui.
+  struct Distribution {
+    const char* name; /** Nom de la distribution.           */
+    Type shift;       /** Premier élément du second tableau. */
+    Type step;        /** Pas entre deux éléments.           */
+  };
+  const Distribution distributions[] = {
+    { "ajout", static_cast< Type >(size), 1 },
+    { "bande 1%", static_cast< Type >(size - size / 100), 1 },
+    { "entrelacement", 1, 2 }
+  };
+
+  // Temps auquel sont démarrées et arrêtées chaque séquence de calcul.
+  std::chrono::time_point< std::chrono::steady_clock > start, stop;
+
+  for (const Distribution& distribution : distributions) {
+    // Deux tableaux triés à fusionner.
+    std::vector< Type > lhs(size), rhs(size);
+    for (size_t i = 0; i != size; i ++) {
+      lhs[i] = static_cast< Type >(i) * distribution.step;
+      rhs[i] = distribution.shift + static_cast< Type >(i) * distribution.step;
+    }
+
+    // Durée d'exécution de l'algorithme merge de la bibliothèque standard.
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i != iters; i ++) {
+      std::merge(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), result.begin(), comp);
+    }
+    stop = std::chrono::steady_clock::now();
+    const double seq =
+      std::chrono::duration< double, std::milli >(stop - start).count();
+
+    // Durée d'exécution de notre version parallèle.
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i != iters; i ++) {
+      merging::ParallelStableMerge::applyUninitialized(lhs.begin(),
+						       lhs.end(),
+						       rhs.begin(),
+						       rhs.end(),
+						       result.begin(),
+						       lessEqual,
+						       threads);
+    }
+    stop = std::chrono::steady_clock::now();
+    const double par =
+      std::chrono::duration< double, std::milli >(stop - start).count();
+
+    // Affichage des performances.
+    std::cout << "--[ " << distribution.name << ": begin ]--" << std::endl;
+    std::cout << "\tThread(s):\t" << threads << std::endl;
+    std::cout << "\tmerge:\t\t" << seq << " msec." << std::endl;
+    std::cout << "\tParallelStableMerge:\t" << par << " msec." << std::endl;
+    std::cout << "\tVerdict:\t\t"
+	      << std::boolalpha
+	      << std::is_sorted(result.begin(), result.end(), comp)
+	      << std::endl;
+    std::cout << "\tSpeedup:\t"
+	      << Metrics::speedup(seq, par)
+	      << std::endl;
+    std::cout << "\tEfficiency:\t"
+	      << Metrics::efficiency(seq, par, threads)
+	      << std::endl;
+    std::cout << "--[ " << distribution.name << ": end ]--" << std::endl;
+    std::cout << std::endl;
+  }
+
+  // Tout s'est bien passé.
+  return EXIT_SUCCESS;
+
+}
@@ -1,11 +1,371 @@
 #include "ParallelStableMerge.hpp"
+#include "BufferPool.hpp"
 #include "Metrics.hpp"
 #include <vector>
+#include <string>
+#include <memory>
+#include <iterator>
+#include <algorithm>
+#include <functional>
 #include <numeric>
+#include <atomic>
+#include <thread>
 #include <iostream>
 #include <sstream>
 #include <chrono>
 #include <cstdlib>
+#include <cstdio>
+
+/**
+ * Affiche le verdict d'une vérification.
+ *
+ * @param[in] name le nom de la vérification.
+ * @param[in] verdict le verdict.
+ * @return le verdict.
+ */
+static bool
+report(const char* name, const bool& verdict) {
+
+  std::cout << "--[ " << name << ": begin ]--" << std::endl;
+  std::cout << "\tVerdict:\t\t" << std::boolalpha << verdict << std::endl;
+  std::cout << "--[ " << name << ": end ]--" << std::endl;
+  std::cout << std::endl;
+  return verdict;
+
+}
+
+/**
+ * Enregistrement fusionné sur sa clé : l'étiquette, propre à chaque
+ * enregistrement, permet de vérifier l'ordre des égalités.
+ */
+struct Rec {
+  int key; /** Clé de la fusion.              */
+  int tag; /** Étiquette de l'enregistrement. */
+};
+
+/**
+ * Fusionne deux tableaux d'enregistrements sur leur clé, avec un mode de
+ * traitement des clés donné, et compare le résultat, étiquettes comprises, à
+ * celui de std::merge avec la même projection.
+ *
+ * @param[in] name le nom de la vérification.
+ * @param[in] lhs le premier tableau trié.
+ * @param[in] rhs le second tableau trié.
+ * @param[in] threads le nombre de threads disponibles.
+ * @param[in] mode le mode de traitement des clés.
+ * @return @c true si les deux fusions sont identiques.
+ */
+static bool
+checkProjection(const char* name,
+		const std::vector< Rec >& lhs,
+		const std::vector< Rec >& rhs,
+		const int& threads,
+		const merging::ParallelStableMerge::KeyMode& mode) {
+
+  // Fusion de référence, stable, sur les clés projetées.
+  std::vector< Rec > expected(lhs.size() + rhs.size());
+  std::merge(lhs.begin(),
+	     lhs.end(),
+	     rhs.begin(),
+	     rhs.end(),
+	     expected.begin(),
+	     [](const Rec& a, const Rec& b) { return a.key < b.key; });
+
+  // Avec la relation <=, le premier tableau passe en premier en cas
+  // d'égalité, comme avec std::merge et la relation <.
+  std::vector< Rec > result(expected.size());
+  merging::ParallelStableMerge::apply(lhs.begin(),
+				      lhs.end(),
+				      rhs.begin(),
+				      rhs.end(),
+				      result.begin(),
+				      std::less_equal< int >(),
+				      &Rec::key,
+				      threads,
+				      mode);
+
+  return report(name,
+		std::equal(result.begin(), result.end(), expected.begin(),
+			   [](const Rec& a, const Rec& b) {
+			     return a.key == b.key && a.tag == b.tag;
+			   }));
+
+}
+
+/**
+ * Relation d'ordre inférieur ou égal comptant ses appels. Les appels à
+ * partir du rang @c pause attendent que le jeton soit déclenché par un autre
+ * thread, ce qui place l'annulation au milieu de la fusion quel que soit
+ * l'ordonnancement.
+ */
+struct CountingLessEqual {
+  std::atomic< size_t >* count;            /** Nombre d'appels.                    */
+  size_t pause;                            /** Rang du premier appel qui attend,
+                                               ou 0 si aucun n'attend.          */
+  const merging::CancellationToken* token; /** Jeton attendu.                      */
+
+  bool operator()(const int& lhs, const int& rhs) const {
+    if (count->fetch_add(1, std::memory_order_relaxed) + 1 >= pause && pause != 0) {
+      while (! token->cancelled()) {
+	std::this_thread::yield();
+      }
+    }
+    return lhs <= rhs;
+  }
+};
+
+/**
+ * Vérifie applyCancellable : fusion menée à son terme, jeton déclenché avant
+ * l'appel, jeton déclenché par un autre thread en cours de fusion, et
+ * échéance déjà passée.
+ *
+ * @param[in] threads le nombre de threads disponibles.
+ * @return @c true si toutes les vérifications réussissent.
+ */
+static bool
+checkCancellation(const int& threads) {
+
+  typedef merging::CancellationToken CancellationToken;
+
+  // Deux tableaux entrelacés, découpés en fragments d'au plus grain
+  // éléments.
+  const size_t size = 1024 * 1024;
+  const size_t grain = 4 * 1024;
+  std::vector< int > lhs(size), rhs(size);
+  for (size_t i = 0; i != size; i ++) {
+    lhs[i] = static_cast< int >(2 * i);
+    rhs[i] = static_cast< int >(2 * i + 1);
+  }
+  std::vector< int > expected(2 * size), result(2 * size);
+  std::merge(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), expected.begin());
+
+  bool verdict = true;
+
+  // Sans déclenchement, la fusion va à son terme.
+  {
+    std::atomic< size_t > count(0);
+    CancellationToken token;
+    const bool completed =
+      merging::ParallelStableMerge::applyCancellable(lhs.begin(), lhs.end(),
+						     rhs.begin(), rhs.end(),
+						     result.begin(),
+						     CountingLessEqual{ &count, 0, &token },
+						     threads,
+						     token,
+						     grain);
+    verdict &= report("annulation : sans déclenchement",
+		      completed && result == expected);
+  }
+
+  // Jeton déclenché avant l'appel : aucune comparaison.
+  {
+    std::atomic< size_t > count(0);
+    CancellationToken token;
+    token.cancel();
+    const bool completed =
+      merging::ParallelStableMerge::applyCancellable(lhs.begin(), lhs.end(),
+						     rhs.begin(), rhs.end(),
+						     result.begin(),
+						     CountingLessEqual{ &count, 0, &token },
+						     threads,
+						     token,
+						     grain);
+    verdict &= report("annulation : avant l'appel", ! completed && count.load() == 0);
+  }
+
+  // Jeton déclenché par un autre thread au quart de la fusion. Chaque
+  // thread termine au plus un fragment de grain éléments, précédé de deux
+  // recherches de co-rangs.
+  {
+    std::atomic< size_t > count(0);
+    CancellationToken token;
+    const size_t pause = size / 2;
+    size_t atCancel = 0;
+    std::thread canceller([&] {
+	while (count.load() < pause) {
+	  std::this_thread::yield();
+	}
+	token.cancel();
+	atCancel = count.load();
+      });
+    const bool completed =
+      merging::ParallelStableMerge::applyCancellable(lhs.begin(), lhs.end(),
+						     rhs.begin(), rhs.end(),
+						     result.begin(),
+						     CountingLessEqual{ &count, pause, &token },
+						     threads,
+						     token,
+						     grain);
+    canceller.join();
+    const size_t after = count.load() - atCancel;
+    const size_t bound = threads * (grain + 4 * 64);
+    std::cout << "--[ annulation : en cours de fusion: begin ]--" << std::endl;
+    std::cout << "\tComparaisons après l'annulation:\t" << after
+	      << " / " << bound << std::endl;
+    std::cout << "\tVerdict:\t\t" << std::boolalpha
+	      << (! completed && after <= bound) << std::endl;
+    std::cout << "--[ annulation : en cours de fusion: end ]--" << std::endl;
+    std::cout << std::endl;
+    verdict &= ! completed && after <= bound;
+  }
+
+  // Échéance déjà passée : aucune comparaison.
+  {
+    std::atomic< size_t > count(0);
+    CancellationToken token(CancellationToken::Clock::now());
+    const bool completed =
+      merging::ParallelStableMerge::applyCancellable(lhs.begin(), lhs.end(),
+						     rhs.begin(), rhs.end(),
+						     result.begin(),
+						     CountingLessEqual{ &count, 0, &token },
+						     threads,
+						     token,
+						     grain);
+    verdict &= report("annulation : échéance passée", ! completed && count.load() == 0);
+  }
+
+  return verdict;
+
+}
+
+/**
+ * Enregistrement non trivialement copiable, fusionné sur son libellé, qui
+ * tient le compte des instances vivantes : une fusion dans une zone non
+ * initialisée doit en construire exactement une par élément, et la
+ * destruction de la zone doit toutes les détruire.
+ */
+struct Tracked {
+  static std::atomic< long > live; /** Nombre d'instances vivantes. */
+
+  std::string label; /** Libellé, assez long pour être alloué sur le tas. */
+  int tag;           /** Étiquette de l'enregistrement.                    */
+
+  Tracked(const std::string& label, const int& tag) : label(label), tag(tag) { live ++; }
+  Tracked(const Tracked& other) : label(other.label), tag(other.tag) { live ++; }
+  Tracked& operator=(const Tracked& other) = default;
+  ~Tracked() { live --; }
+
+  bool operator<(const Tracked& other) const { return label < other.label; }
+  bool operator<=(const Tracked& other) const { return label <= other.label; }
+};
+
+std::atomic< long > Tracked::live(0);
+
+/**
+ * Construit un tableau trié d'enregistrements dont les libellés se répètent.
+ *
+ * @param[in] size le nombre d'enregistrements.
+ * @param[in] repeat le nombre d'enregistrements par libellé.
+ * @param[in] tag l'étiquette du premier enregistrement.
+ * @return le tableau.
+ */
+static std::vector< Tracked >
+makeTracked(const size_t& size, const size_t& repeat, const int& tag) {
+
+  std::vector< Tracked > records;
+  records.reserve(size);
+  for (size_t i = 0; i != size; i ++) {
+    char label[64];
+    std::snprintf(label, sizeof(label), "enregistrement numéro %010zu", i / repeat);
+    records.emplace_back(label, tag + static_cast< int >(i));
+  }
+  return records;
+
+}
+
+/**
+ * Fusionne deux tableaux d'enregistrements non trivialement copiables dans un
+ * tampon du BufferPool avec applyUninitialized et compare le résultat,
+ * étiquettes comprises, à celui de std::merge.
+ *
+ * @param[in] lhs le premier tableau trié.
+ * @param[in] rhs le second tableau trié.
+ * @param[in] lease le tampon, non initialisé, de lhs.size() + rhs.size()
+ *   éléments.
+ * @param[in] threads le nombre de threads disponibles.
+ * @return @c true si le tampon contient exactement un enregistrement vivant
+ *   par élément et si les deux fusions sont identiques.
+ */
+static bool
+mergeTracked(const std::vector< Tracked >& lhs,
+	     const std::vector< Tracked >& rhs,
+	     const merging::BufferPool::Lease< Tracked >& lease,
+	     const int& threads) {
+
+  std::vector< Tracked > expected;
+  expected.reserve(lease.size());
+  std::merge(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(expected));
+
+  // Avec la relation <=, le premier tableau passe en premier en cas
+  // d'égalité, comme avec std::merge et la relation <.
+  const long before = Tracked::live.load();
+  Tracked* const end =
+    merging::ParallelStableMerge::applyUninitialized(lhs.begin(),
+						     lhs.end(),
+						     rhs.begin(),
+						     rhs.end(),
+						     lease.begin(),
+						     std::less_equal< Tracked >(),
+						     threads);
+  const bool constructed = Tracked::live.load() - before == static_cast< long >(lease.size());
+
+  return constructed && end == lease.end() &&
+    std::equal(lease.begin(),
+	       lease.end(),
+	       expected.begin(),
+	       [](const Tracked& a, const Tracked& b) {
+		 return a.label == b.label && a.tag == b.tag;
+	       });
+
+}
+
+/**
+ * Vérifie applyUninitialized avec des éléments non trivialement copiables,
+ * qui passent par la construction en place, dans un tampon du BufferPool ;
+ * puis rend ce tampon et en redemande un plus petit, qui doit le réutiliser.
+ *
+ * @param[in] threads le nombre de threads disponibles.
+ * @return @c true si toutes les vérifications réussissent.
+ */
+static bool
+checkUninitialized(const int& threads) {
+
+  merging::BufferPool pool;
+
+  // Deux tableaux aux libellés souvent égaux, dont la fusion occupe
+  // plusieurs pages géantes.
+  const std::vector< Tracked > lhs = makeTracked(100000, 3, 0);
+  const std::vector< Tracked > rhs = makeTracked(150000, 5, 1000000);
+  const long live = Tracked::live.load();
+
+  bool verdict = true;
+
+  // Premier tampon, rendu au pool une fois les enregistrements détruits.
+  const Tracked* first = nullptr;
+  {
+    auto lease = pool.acquire< Tracked >(lhs.size() + rhs.size());
+    first = lease.data();
+    bool merged = mergeTracked(lhs, rhs, lease, threads);
+    std::destroy(lease.begin(), lease.end());
+    merged &= Tracked::live.load() == live;
+    verdict &= report("zone non initialisée : construction en place", merged);
+  }
+
+  // Un tampon plus petit, de plus de la moitié du premier, le réutilise.
+  {
+    const std::vector< Tracked > lhs2(lhs.begin(), lhs.begin() + 60000);
+    const std::vector< Tracked > rhs2(rhs.begin(), rhs.begin() + 90000);
+    auto lease = pool.acquire< Tracked >(lhs2.size() + rhs2.size());
+    const bool reused = lease.data() == first;
+    bool merged = mergeTracked(lhs2, rhs2, lease, threads);
+    std::destroy(lease.begin(), lease.end());
+    merged &= Tracked::live.load() == live + static_cast< long >(lhs2.size() + rhs2.size());
+    verdict &= report("zone non initialisée : réutilisation du tampon", reused && merged);
+  }
+
+  return verdict && Tracked::live.load() == live;
+
+}
 
 /**
  * Programme principal.
@@ -53,8 +413,11 @@ main(int argc, char* argv[]) {
   std::iota(lhs.begin(), lhs.end(), 19);
   std::iota(rhs.begin(), rhs.end(), 5);
 
-  // Conteneur accueillant le résultat de la fusion.
-  std::vector< Type > result(lhs.size() + rhs.size());
+  // Zone non initialisée accueillant le résultat de la fusion : elle est
+  // fournie par un pool de tampons alignés sur des pages géantes, que l'on
+  // peut recycler d'une fusion à l'autre.
+  merging::BufferPool pool;
+  auto result = pool.acquire< Type >(lhs.size() + rhs.size());
 
   // Temps auquel sont démarrées et arrêtées chaque séquence de calcul.
   std::chrono::time_point< std::chrono::steady_clock > start, stop;
@@ -100,13 +463,13 @@ main(int argc, char* argv[]) {
   for (int nb = 1; nb <= threads; nb ++) {
     start = std::chrono::steady_clock::now();
     for (size_t i = 0; i != iters; i ++) {
-      merging::ParallelStableMerge::apply(lhs.rbegin(), 
-					  lhs.rend(),
-					  rhs.rbegin(), 
-					  rhs.rend(),
-					  result.rbegin(),
-					  invComp,
-					  nb);
+      merging::ParallelStableMerge::applyUninitialized(lhs.rbegin(), 
+						       lhs.rend(),
+						       rhs.rbegin(), 
+						       rhs.rend(),
+						       result.rbegin(),
+						       invComp,
+						       nb);
     }
     stop = std::chrono::steady_clock::now();
   const int par = 
@@ -132,6 +495,32 @@ main(int argc, char* argv[]) {
     std::cout << std::endl;
   } 
 
+  // Fusions sur une clé projetée de deux tableaux de tailles différentes,
+  // aux clés très souvent égales, le plus long étant tour à tour le premier et
+  // le second.
+  typedef merging::ParallelStableMerge::KeyMode KeyMode;
+  std::vector< Rec > recs1(20000), recs2(50000);
+  for (size_t i = 0; i != recs1.size(); i ++) {
+    recs1[i] = { static_cast< int >(i / 7), static_cast< int >(i) };
+  }
+  for (size_t i = 0; i != recs2.size(); i ++) {
+    recs2[i] = { static_cast< int >(i / 13), static_cast< int >(1000000 + i) };
+  }
+  bool verdict = true;
+  verdict &= checkProjection("projection directe", recs1, recs2, threads, KeyMode::direct);
+  verdict &= checkProjection("projection directe inversée", recs2, recs1, threads, KeyMode::direct);
+  verdict &= checkProjection("clés extraites", recs1, recs2, threads, KeyMode::extracted);
+  verdict &= checkProjection("clés extraites inversées", recs2, recs1, threads, KeyMode::extracted);
+
+  // Fusions interrompues.
+  verdict &= checkCancellation(threads);
+
+  // Fusions dans une zone non initialisée du BufferPool.
+  verdict &= checkUninitialized(threads);
+  if (! verdict) {
+    return EXIT_FAILURE;
+  }
+
   // Tout s'est bien passé.
   return EXIT_SUCCESS;
 
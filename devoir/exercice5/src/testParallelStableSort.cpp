@@ -0,0 +1,168 @@
+#include "ParallelStableSort.hpp"
+#include "Metrics.hpp"
+#include <vector>
+#include <random>
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <cstdlib>
+#ifdef HAVE_PARALLEL_STL
+#include <execution>
+#endif
+
+/**
+ * Enregistrement à trier : de nombreux enregistrements partagent la même clé
+ * et leur rang initial permet de vérifier la stabilité du tri.
+ */
+struct Record {
+  int key;  /** Clé de tri.                      */
+  int rank; /** Position avant le tri.           */
+};
+
+/**
+ * Programme principal.
+ *
+ * @param[in] argc le nombre d'arguments de la ligne de commandes.
+ * @param[in] argv les arguments de la ligne de commandes.
+ * @return @c EXIT_SUCCESS en cas d'exécution réussie ou @c EXIT_FAILURE en cas
+ *   de problèmes.
+ */
+int
+main(int argc, char* argv[]) {
+
+  // La ligne de commandes est vide : l'utilisateur demande de l'aide.
+  if (argc == 1) {
+    std::cout << "Usage: " << argv[0] << " nb_iterations" << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  // Le nombre d'arguments est différent de 1 : l'utilisateur fait n'importe
+  // quoi.
+  if (argc != 2) {
+    std::cerr << "Nombre d'argument(s) incorrect." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Tentative d'extraction du nombre d'itérations.
+  size_t iters;
+  {
+    std::istringstream entree(argv[1]);
+    entree >> iters;
+    if (! entree || ! entree.eof()) {
+      std::cerr << "Argument incorrect." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Relation d'ordre utilisée : strictement inférieur à, sur la clé seule.
+  const auto comp = [](const Record& lhs, const Record& rhs) {
+    return lhs.key < rhs.key;
+  };
+
+  // Relation d'ordre vérifiant à la fois le tri et sa stabilité.
+  const auto stable = [](const Record& lhs, const Record& rhs) {
+    return lhs.key < rhs.key || (lhs.key == rhs.key && lhs.rank < rhs.rank);
+  };
+
+  // Enregistrements à trier : 4 Mi clés tirées parmi 1024 valeurs, donc
+  // beaucoup d'égalités.
+  std::vector< Record > input(4 * 1024 * 1024);
+  {
+    std::mt19937 generator(19);
+    std::uniform_int_distribution< int > keys(0, 1023);
+    for (size_t i = 0; i != input.size(); i ++) {
+      input[i].key = keys(generator);
+      input[i].rank = static_cast< int >(i);
+    }
+  }
+
+  // Conteneur trié à chaque itération.
+  std::vector< Record > result(input.size());
+
+  // Durée cumulée, en millisecondes, de iters tris effectués par sorter. La
+  // recopie des données d'entrée n'est pas chronométrée.
+  const auto measure = [&](const auto& sorter) {
+    double total = 0.0;
+    for (size_t i = 0; i != iters; i ++) {
+      std::copy(input.begin(), input.end(), result.begin());
+      const auto start = std::chrono::steady_clock::now();
+      sorter();
+      const auto stop = std::chrono::steady_clock::now();
+      total += std::chrono::duration< double, std::milli >(stop - start).count();
+    }
+    return total;
+  };
+
+  // Durée d'exécution de l'algorithme stable_sort de la bibliothèque standard.
+  const double seq = measure([&] {
+    std::stable_sort(result.begin(), result.end(), comp);
+  });
+
+  // Affichage des performances de la version séquentielle.
+  std::cout << "--[ stable_sort: begin ]--" << std::endl;
+  std::cout << "\tDurée:\t\t" << seq << " msec." << std::endl;
+  std::cout << "\tVerdict:\t\t"
+            << std::boolalpha
+            << std::is_sorted(result.begin(), result.end(), stable)
+            << std::endl;
+  std::cout << "--[ stable_sort: end ]--" << std::endl;
+  std::cout << std::endl;
+
+  // Nombre de threads disponibles via OpenMP.
+  const int threads = omp_get_max_threads();
+
+#ifdef HAVE_PARALLEL_STL
+  // Durée d'exécution de la version parallèle de la bibliothèque standard.
+  const double pstl = measure([&] {
+    std::stable_sort(std::execution::par, result.begin(), result.end(), comp);
+  });
+
+  std::cout << "--[ stable_sort(par): begin ]--" << std::endl;
+  std::cout << "\tDurée:\t\t" << pstl << " msec." << std::endl;
+  std::cout << "\tVerdict:\t\t"
+            << std::boolalpha
+            << std::is_sorted(result.begin(), result.end(), stable)
+            << std::endl;
+  std::cout << "\tSpeedup:\t"
+            << Metrics::speedup(seq, pstl)
+            << std::endl;
+  std::cout << "\tEfficiency:\t"
+            << Metrics::efficiency(seq, pstl, threads)
+            << std::endl;
+  std::cout << "--[ stable_sort(par): end ]--" << std::endl;
+  std::cout << std::endl;
+#endif
+
+  // Durées d'exécution de l'algorithme ParallelStableSort. Nous allons
+  // utiliser plusieurs valeurs du nombre de threads disponibles.
+  for (int nb = 1; nb <= threads; nb ++) {
+    const double par = measure([&] {
+      merging::ParallelStableSort::apply(result.begin(),
+                                         result.end(),
+                                         comp,
+                                         nb);
+    });
+
+    // Affichage des résultats de la version parallèle avec, en plus, le calcul
+    // des facteurs d'accélération et d'efficacité.
+    std::cout << "--[ ParallelStableSort: begin ]--" << std::endl;
+    std::cout << "\tThread(s):\t" << nb << std::endl;
+    std::cout << "\tDurée:\t\t" << par << " msec." << std::endl;
+    std::cout << "\tVerdict:\t\t"
+              << std::boolalpha
+              << std::is_sorted(result.begin(), result.end(), stable)
+              << std::endl;
+    std::cout << "\tSpeedup:\t"
+              << Metrics::speedup(seq, par)
+              << std::endl;
+    std::cout << "\tEfficiency:\t"
+              << Metrics::efficiency(seq, par, nb)
+              << std::endl;
+    std::cout << "--[ ParallelStableSort: end ]--" << std::endl;
+    std::cout << std::endl;
+  }
+
+  // Tout s'est bien passé.
+  return EXIT_SUCCESS;
+
+}